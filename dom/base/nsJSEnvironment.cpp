@@ -1007,7 +1007,9 @@ static void MaybeLogStats(const CycleCollectorResults& aResults,
       u"suspected: %lu, visited: %lu RCed and %lu%s GCed, collected: %lu "
       u"RCed and %lu GCed (%lu|%lu|%lu waiting for GC)%s\n"
       u"ForgetSkippable %lu times before CC, min: %.f ms, max: %.f ms, avg: "
-      u"%.f ms, total: %.f ms, max sync: %.f ms, removed: %lu";
+      u"%.f ms, total: %.f ms, max sync: %.f ms, removed: %lu\n"
+      u"Phases: graph building: %.f ms, scanning: %.f ms (%lu helper "
+      u"threads), collecting white: %.f ms";
   nsString msg;
   nsTextFormatter::ssprintf(
       msg, kFmt, delta.ToMicroseconds() / PR_USEC_PER_SEC,
@@ -1025,7 +1027,9 @@ static void MaybeLogStats(const CycleCollectorResults& aResults,
       sCCStats->mTotalForgetSkippableTime.ToMilliseconds() / aCleanups,
       sCCStats->mTotalForgetSkippableTime.ToMilliseconds(),
       sCCStats->mMaxSkippableDuration.ToMilliseconds(),
-      sCCStats->mRemovedPurples);
+      sCCStats->mRemovedPurples, sCCStats->mGraphBuildTime.ToMilliseconds(),
+      sCCStats->mScanRootsTime.ToMilliseconds(), sCCStats->mScanHelperThreads,
+      sCCStats->mCollectWhiteTime.ToMilliseconds());
   if (StaticPrefs::javascript_options_mem_log()) {
     nsCOMPtr<nsIConsoleService> cs =
         do_GetService(NS_CONSOLESERVICE_CONTRACTID);
@@ -117,4 +117,16 @@ bool MessageBufferReader::ReadBytesInto(void* data, uint32_t len) {
   return reader_->ReadBytesInto(data, len);
 }
 
+bool MessageBufferReader::HasBytesAvailable(uint32_t len) {
+  if (len > remaining_) {
+    return false;
+  }
+  // The constructor already checked that the shared memory region covers
+  // the whole buffer.
+  if (shmem_cursor_) {
+    return true;
+  }
+  return reader_->HasBytesAvailable(len);
+}
+
 }  // namespace IPC
@@ -560,6 +560,12 @@ class MOZ_STACK_CLASS MessageBufferReader {
   // integration between `MessageBufferReader` and `Pickle`.
   [[nodiscard]] bool ReadBytesInto(void* data, uint32_t len);
 
+  // Whether the next `len` bytes of the buffer have actually been received,
+  // either inline in the message or in its shared memory region. Callers can
+  // use this to size allocations without trusting a length read from the
+  // message.
+  bool HasBytesAvailable(uint32_t len);
+
  private:
   MessageReader* reader_;
   mozilla::UniquePtr<mozilla::ipc::shared_memory::Cursor> shmem_cursor_;
@@ -51,8 +51,21 @@ bool ParamTraits<JSStructuredCloneData>::Read(MessageReader* aReader,
   // can be revisited in the future if it turns out to be a noticable
   // performance regression. (bug 1783242)
 
-  mozilla::BufferList<js::SystemAllocPolicy> buffers(0, 0, 4096);
+  // Reserve the whole payload up front so that it lands in a single segment:
+  // large payloads arrive in shared memory, and one segment lets us copy them
+  // out with a single memcpy and lets the reader pull ArrayBuffer and string
+  // contents back out without walking thousands of 4k segments. `length`
+  // comes from the sender, so only do this when the bytes have really
+  // arrived; otherwise, or if this allocation fails, the loop below grows
+  // the list in standard-sized segments as the data is read.
   MessageBufferReader bufReader(aReader, length);
+  using BufferList = mozilla::BufferList<js::SystemAllocPolicy>;
+  BufferList buffers(0, 0, 4096);
+  if (length && bufReader.HasBytesAvailable(length)) {
+    size_t reserve = (size_t(length) + BufferList::kSegmentAlignment - 1) &
+                     ~(BufferList::kSegmentAlignment - 1);
+    (void)buffers.Init(0, reserve);
+  }
   uint32_t read = 0;
   while (read < length) {
     size_t bufLen;
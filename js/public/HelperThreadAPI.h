@@ -13,8 +13,10 @@
 #define js_HelperThreadAPI_h
 
 #include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
 
-#include "jstypes.h"  // JS_PUBLIC_API
+#include "jstypes.h"     // JS_PUBLIC_API
+#include "js/Utility.h"  // js::ThreadType
 
 namespace JS {
 
@@ -36,6 +38,34 @@ extern JS_PUBLIC_API void RunHelperThreadTask(HelperThreadTask* task);
 extern JS_PUBLIC_API const char* GetHelperThreadTaskName(
     HelperThreadTask* task);
 
+/**
+ * Hint that helper thread work of the given type is latency sensitive, for
+ * example because the user is waiting on a parse or a compile to finish. While
+ * the hint is set, queued tasks of this type are started before any other
+ * helper thread work.
+ *
+ * Hints nest: every call with |urgent| set to true must be balanced by a later
+ * call with |urgent| set to false.
+ */
+extern JS_PUBLIC_API void SetHelperThreadTaskTypeUrgent(js::ThreadType type,
+                                                        bool urgent);
+
+// Statistics about how long the helper thread lock has been held, which is
+// taken to queue, select and finish every helper thread task. These are only
+// gathered while enabled with SetHelperThreadLockStatsEnabled, since timing
+// every acquisition is not free.
+struct HelperThreadLockStats {
+  uint64_t acquisitions = 0;
+  uint64_t totalHoldMicroseconds = 0;
+  uint64_t maxHoldMicroseconds = 0;
+};
+
+extern JS_PUBLIC_API void SetHelperThreadLockStatsEnabled(bool enabled);
+
+// Get the lock statistics gathered since startup or the last reset.
+extern JS_PUBLIC_API void GetHelperThreadLockStats(HelperThreadLockStats* stats,
+                                                   bool reset = false);
+
 }  // namespace JS
 
 #endif  // js_HelperThreadAPI_h
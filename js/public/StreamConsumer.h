@@ -42,6 +42,11 @@ namespace JS {
  * storeOptimizedEncoding(). Until the optimized encoding is ready, SpiderMonkey
  * will hold an outstanding refcount to keep the listener alive.
  *
+ * An embedding which intends to pass a listener to streamEnd() should say so
+ * up front by calling noteOptimizedEncodingWanted(), so that SpiderMonkey
+ * compiles the stream in a mode whose fully optimized code can be stored.
+ * Otherwise the module may be compiled lazily and never become storable.
+ *
  * After storeOptimizedEncoding() is called, on cache hit, the embedding
  * may call consumeOptimizedEncoding() instead of consumeChunk()/streamEnd().
  * The embedding must ensure that the GetOptimizedEncodingBuildId() (see
@@ -96,6 +101,11 @@ class JS_PUBLIC_API StreamConsumer {
   // consumeOptimizedEncoding(). The caller retains ownership of the strings.
   virtual void noteResponseURLs(const char* maybeUrl,
                                 const char* maybeSourceMapUrl) = 0;
+
+  // Indicates that the embedding has a cache entry for this stream and will
+  // pass an OptimizedEncodingListener to streamEnd(). Necessarily called
+  // before consumeChunk(), streamEnd() or streamError().
+  virtual void noteOptimizedEncodingWanted() = 0;
 };
 
 enum class MimeType { Wasm };
@@ -224,13 +224,15 @@ enum TransferableOwnership {
 class CloneDataPolicy {
   bool allowIntraClusterClonableSharedObjects_;
   bool allowSharedMemoryObjects_;
+  bool allowShapeTemplates_;
 
  public:
   // The default is to deny all policy-controlled aspects.
 
   CloneDataPolicy()
       : allowIntraClusterClonableSharedObjects_(false),
-        allowSharedMemoryObjects_(false) {}
+        allowSharedMemoryObjects_(false),
+        allowShapeTemplates_(false) {}
 
   // SharedArrayBuffers and WASM modules can only be cloned intra-process
   // because the shared memory areas are allocated in process-private memory or
@@ -249,6 +251,14 @@ class CloneDataPolicy {
   bool areSharedMemoryObjectsAllowed() const {
     return allowSharedMemoryObjects_;
   }
+
+  // Plain objects that share a shape may be written as a list of property
+  // names emitted once, followed by just the values for each object. This
+  // makes arrays of like-shaped records smaller and faster to read, but the
+  // data can only be read by engines that understand the encoding, so it is
+  // off by default. Only affects writing.
+  void allowShapeTemplates() { allowShapeTemplates_ = true; }
+  bool areShapeTemplatesAllowed() const { return allowShapeTemplates_; }
 };
 
 } /* namespace JS */
@@ -471,6 +481,11 @@ class MOZ_NON_MEMMOVABLE JS_PUBLIC_API JSStructuredCloneData {
  private:
   static const size_t kStandardCapacity = 4096;
 
+  // Appends at least this large get a segment of their own, so that large
+  // ArrayBuffer and string payloads are stored contiguously and can be
+  // copied out (or into IPC shared memory) in one piece.
+  static const size_t kLargeAppendThreshold = 64 * 1024;
+
   BufferList bufList_;
 
   // The (address space, thread) scope within which this clone is valid. Note
@@ -560,6 +575,9 @@ class MOZ_NON_MEMMOVABLE JS_PUBLIC_API JSStructuredCloneData {
   // Append new data to the end of the buffer.
   [[nodiscard]] bool AppendBytes(const char* data, size_t size) {
     MOZ_ASSERT(scope() != JS::StructuredCloneScope::Unassigned);
+    if (size >= kLargeAppendThreshold) {
+      return bufList_.WriteLargeBytes(data, size);
+    }
     return bufList_.WriteBytes(data, size);
   }
 
@@ -16,6 +16,8 @@
 #include "mozilla/Atomics.h"
 #include "mozilla/DebugOnly.h"
 #include "mozilla/FloatingPoint.h"
+#include "mozilla/HashFunctions.h"
+#include "mozilla/MathAlgorithms.h"
 #include "mozilla/Maybe.h"
 #include "mozilla/ScopeExit.h"
 
@@ -529,11 +531,11 @@ namespace js {
 
 // Represents one waiting worker.
 //
-// The type is declared opaque in SharedArrayObject.h.  Instances of
-// js::FutexWaiter are stack-allocated and linked onto a list across a
-// call to FutexThread::wait().
+// Instances of js::FutexWaiter are stack-allocated and linked onto a list
+// across a call to FutexThread::wait().
 //
-// The 'waiters' field of the SharedArrayRawBuffer points to the highest
+// Waiters are kept in per-shard lists rather than on the SharedArrayRawBuffer,
+// see FutexShards.  The 'waiters' field of the shard points to the highest
 // priority waiter in the list, and lower priority nodes are linked through
 // the 'lower_pri' field.  The 'back' field goes the other direction.
 // The list is circular, so the 'lower_pri' field of the lowest priority
@@ -542,30 +544,62 @@ namespace js {
 
 class FutexWaiter {
  public:
-  FutexWaiter(size_t offset, JSContext* cx)
-      : offset(offset), cx(cx), lower_pri(nullptr), back(nullptr) {}
-
-  size_t offset;           // int32 element index within the SharedArrayBuffer
-  JSContext* cx;           // The waiting thread
-  FutexWaiter* lower_pri;  // Lower priority nodes in circular doubly-linked
-                           // list of waiters
-  FutexWaiter* back;       // Other direction
+  FutexWaiter(SharedArrayRawBuffer* sarb, size_t offset, JSContext* cx)
+      : sarb(sarb), offset(offset), cx(cx), lower_pri(nullptr), back(nullptr) {}
+
+  SharedArrayRawBuffer* sarb;  // The buffer being waited on
+  size_t offset;               // byte offset within the SharedArrayBuffer
+  JSContext* cx;               // The waiting thread
+  FutexWaiter* lower_pri;      // Lower priority nodes in circular doubly-linked
+                               // list of waiters
+  FutexWaiter* back;           // Other direction
+};
+
+// Futex locks and waiter lists, sharded by the waited-on address so that
+// waits and notifies on unrelated locations neither contend on a lock nor
+// scan each other's waiters.  Waiters for one location are always in the
+// same shard, so they stay in FIFO order.
+class FutexShards {
+ public:
+  static constexpr size_t NumShards = 64;
+  static_assert(mozilla::IsPowerOfTwo(NumShards));
+
+  struct Shard {
+    js::Mutex lock{mutexid::FutexThread};
+    FutexWaiter* waiters = nullptr;
+  };
+
+  Shard& shardFor(SharedArrayRawBuffer* sarb, size_t byteOffset) {
+    mozilla::HashNumber hash = mozilla::HashGeneric(sarb, byteOffset);
+    return shards_[hash & (NumShards - 1)];
+  }
+
+ private:
+  Shard shards_[NumShards];
 };
 
 class AutoLockFutexAPI {
-  // We have to wrap this in a Maybe because of the way loading
-  // mozilla::Atomic pointers works.
-  mozilla::Maybe<js::UniqueLock<js::Mutex>> unique_;
+  FutexShards::Shard& shard_;
+  js::UniqueLock<js::Mutex> unique_;
+
+  static FutexShards::Shard& shardFor(SharedArrayRawBuffer* sarb,
+                                      size_t byteOffset) {
+    // Load the atomic pointer.
+    FutexShards* shards = FutexThread::shards_;
+    return shards->shardFor(sarb, byteOffset);
+  }
 
  public:
-  AutoLockFutexAPI() {
-    js::Mutex* lock = FutexThread::lock_;
-    unique_.emplace(*lock);
-  }
+  AutoLockFutexAPI(SharedArrayRawBuffer* sarb, size_t byteOffset)
+      : shard_(shardFor(sarb, byteOffset)), unique_(shard_.lock) {}
 
-  ~AutoLockFutexAPI() { unique_.reset(); }
+  js::Mutex& mutex() { return shard_.lock; }
+  js::UniqueLock<js::Mutex>& unique() { return unique_; }
 
-  js::UniqueLock<js::Mutex>& unique() { return *unique_; }
+  // The list of waiters in this shard.  Waiters for other locations may be
+  // on the same list.
+  FutexWaiter* waiters() const { return shard_.waiters; }
+  void setWaiters(FutexWaiter* waiters) { shard_.waiters = waiters; }
 };
 
 }  // namespace js
@@ -590,9 +624,9 @@ static FutexThread::WaitResult AtomicsWait(
       sarb->dataPointerShared().cast<T*>() + (byteOffset / sizeof(T));
 
   // Steps 15 (reordered), 17.a and 23 (through destructor).
-  // This lock also protects the "waiters" field on SharedArrayRawBuffer,
-  // and it provides the necessary memory fence.
-  AutoLockFutexAPI lock;
+  // This lock also protects the waiter list for the location, and it
+  // provides the necessary memory fence.
+  AutoLockFutexAPI lock(sarb, byteOffset);
 
   // Steps 16-17.
   if (jit::AtomicOperations::loadSafeWhenRacy(addr) != value) {
@@ -600,26 +634,27 @@ static FutexThread::WaitResult AtomicsWait(
   }
 
   // Steps 14, 18-22.
-  FutexWaiter w(byteOffset, cx);
-  if (FutexWaiter* waiters = sarb->waiters()) {
+  FutexWaiter w(sarb, byteOffset, cx);
+  if (FutexWaiter* waiters = lock.waiters()) {
     w.lower_pri = waiters;
     w.back = waiters->back;
     waiters->back->lower_pri = &w;
     waiters->back = &w;
   } else {
     w.lower_pri = w.back = &w;
-    sarb->setWaiters(&w);
+    lock.setWaiters(&w);
   }
 
-  FutexThread::WaitResult retval = cx->fx.wait(cx, lock.unique(), timeout);
+  FutexThread::WaitResult retval =
+      cx->fx.wait(cx, lock.mutex(), lock.unique(), timeout);
 
   if (w.lower_pri == &w) {
-    sarb->setWaiters(nullptr);
+    lock.setWaiters(nullptr);
   } else {
     w.lower_pri->back = w.back;
     w.back->lower_pri = w.lower_pri;
-    if (sarb->waiters() == &w) {
-      sarb->setWaiters(w.lower_pri);
+    if (lock.waiters() == &w) {
+      lock.setWaiters(w.lower_pri);
     }
   }
 
@@ -760,19 +795,20 @@ int64_t js::atomics_notify_impl(SharedArrayRawBuffer* sarb, size_t byteOffset,
   MOZ_ASSERT(sarb, "notify is only applicable to shared memory");
 
   // Steps 12 (reordered), 15 (through destructor).
-  AutoLockFutexAPI lock;
+  AutoLockFutexAPI lock(sarb, byteOffset);
 
   // Step 11 (reordered).
   int64_t woken = 0;
 
   // Steps 10, 13-14.
-  FutexWaiter* waiters = sarb->waiters();
+  FutexWaiter* waiters = lock.waiters();
   if (waiters && count) {
     FutexWaiter* iter = waiters;
     do {
       FutexWaiter* c = iter;
       iter = iter->lower_pri;
-      if (c->offset != byteOffset || !c->cx->fx.isWaiting()) {
+      if (c->sarb != sarb || c->offset != byteOffset ||
+          !c->cx->fx.isWaiting()) {
         continue;
       }
       c->cx->fx.notify(FutexThread::NotifyExplicit);
@@ -891,54 +927,59 @@ static bool atomics_pause(JSContext* cx, unsigned argc, Value* vp) {
 
 /* static */
 bool js::FutexThread::initialize() {
-  MOZ_ASSERT(!lock_);
-  lock_ = js_new<js::Mutex>(mutexid::FutexThread);
-  return lock_ != nullptr;
+  MOZ_ASSERT(!shards_);
+  shards_ = js_new<FutexShards>();
+  return shards_ != nullptr;
 }
 
 /* static */
 void js::FutexThread::destroy() {
-  if (lock_) {
-    js::Mutex* lock = lock_;
-    js_delete(lock);
-    lock_ = nullptr;
+  if (shards_) {
+    FutexShards* shards = shards_;
+    js_delete(shards);
+    shards_ = nullptr;
   }
 }
 
-/* static */
-void js::FutexThread::lock() {
-  // Load the atomic pointer.
-  js::Mutex* lock = lock_;
-
-  lock->lock();
-}
-
-/* static */ mozilla::Atomic<js::Mutex*, mozilla::SequentiallyConsistent>
-    FutexThread::lock_;
-
-/* static */
-void js::FutexThread::unlock() {
-  // Load the atomic pointer.
-  js::Mutex* lock = lock_;
-
-  lock->unlock();
-}
+/* static */ mozilla::Atomic<FutexShards*, mozilla::SequentiallyConsistent>
+    FutexThread::shards_;
 
 js::FutexThread::FutexThread()
-    : cond_(nullptr), state_(Idle), canWait_(false) {}
+    : cond_(nullptr), state_(Idle), waitLock_(nullptr), canWait_(false) {}
 
 bool js::FutexThread::initInstance() {
-  MOZ_ASSERT(lock_);
+  MOZ_ASSERT(shards_);
   cond_ = js_new<js::ConditionVariable>();
   return cond_ != nullptr;
 }
 
 void js::FutexThread::destroyInstance() {
+  MOZ_ASSERT(!waitLock_);
   if (cond_) {
     js_delete(cond_);
   }
 }
 
+void js::FutexThread::notifyForInterrupt() {
+  // The lock protecting state_ is the one for the shard the thread is
+  // waiting in.  It can only change with that lock held, so retry if it
+  // changed before we acquired it.
+  for (;;) {
+    js::Mutex* lock = waitLock_;
+    if (!lock) {
+      return;
+    }
+
+    js::LockGuard<js::Mutex> guard(*lock);
+    if (waitLock_ == lock) {
+      if (isWaiting()) {
+        notify(NotifyForJSInterrupt);
+      }
+      return;
+    }
+  }
+}
+
 bool js::FutexThread::isWaiting() {
   // When a worker is awoken for an interrupt it goes into state
   // WaitingNotifiedForInterrupt for a short time before it actually
@@ -951,7 +992,7 @@ bool js::FutexThread::isWaiting() {
 }
 
 FutexThread::WaitResult js::FutexThread::wait(
-    JSContext* cx, js::UniqueLock<js::Mutex>& locked,
+    JSContext* cx, js::Mutex& lock, js::UniqueLock<js::Mutex>& locked,
     const mozilla::Maybe<mozilla::TimeDuration>& timeout) {
   MOZ_ASSERT(&cx->fx == this);
   MOZ_ASSERT(cx->fx.canWait());
@@ -967,8 +1008,14 @@ FutexThread::WaitResult js::FutexThread::wait(
     return WaitResult::Error;
   }
 
-  // Go back to Idle after returning.
-  auto onFinish = mozilla::MakeScopeExit([&] { state_ = Idle; });
+  // Publish the lock we wait under for notifyForInterrupt(), and go back to
+  // Idle after returning.
+  MOZ_ASSERT(!waitLock_);
+  waitLock_ = &lock;
+  auto onFinish = mozilla::MakeScopeExit([&] {
+    state_ = Idle;
+    waitLock_ = nullptr;
+  });
 
   const bool isTimed = timeout.isSome();
 
@@ -16,6 +16,7 @@
 
 namespace js {
 
+class FutexShards;
 class SharedArrayRawBuffer;
 
 class AtomicsObject : public NativeObject {
@@ -30,9 +31,6 @@ class FutexThread {
   [[nodiscard]] static bool initialize();
   static void destroy();
 
-  static void lock();
-  static void unlock();
-
   FutexThread();
   [[nodiscard]] bool initInstance();
   void destroyInstance();
@@ -53,7 +51,7 @@ class FutexThread {
 
   // Block the calling thread and wait.
   //
-  // The futex lock must be held around this call.
+  // The futex lock `lock` must be held around this call, through `locked`.
   //
   // The timeout is the number of milliseconds, with fractional
   // times allowed; specify mozilla::Nothing() for an indefinite
@@ -61,7 +59,7 @@ class FutexThread {
   //
   // wait() will not wake up spuriously.
   [[nodiscard]] WaitResult wait(
-      JSContext* cx, js::UniqueLock<js::Mutex>& locked,
+      JSContext* cx, js::Mutex& lock, js::UniqueLock<js::Mutex>& locked,
       const mozilla::Maybe<mozilla::TimeDuration>& timeout);
 
   // Notify the thread this is associated with.
@@ -82,6 +80,13 @@ class FutexThread {
   // of wait() must handle the interrupt.
   void notify(NotifyReason reason);
 
+  // Notify the thread this is associated with for an interrupt, if it is
+  // currently waiting.
+  //
+  // This takes the lock the thread is waiting under, so must be called
+  // without any futex lock held.
+  void notifyForInterrupt();
+
   bool isWaiting();
 
   // If canWait() returns false (the default) then wait() is disabled
@@ -110,10 +115,16 @@ class FutexThread {
   // is about to wake up.
   FutexState state_;
 
-  // Shared futex lock for all runtimes.  We can perhaps do better,
-  // but any lock will need to be per-domain (consider SharedWorker)
-  // or coarser.
-  static mozilla::Atomic<js::Mutex*, mozilla::SequentiallyConsistent> lock_;
+  // The futex lock of the shard this thread is waiting in, or nullptr when
+  // the thread is not waiting.  This is only changed with that lock held,
+  // and state_ is protected by it while the thread waits.
+  mozilla::Atomic<js::Mutex*, mozilla::SequentiallyConsistent> waitLock_;
+
+  // Futex locks and waiter lists for all runtimes, sharded by the address
+  // being waited on.  Any lock will need to be per-domain (consider
+  // SharedWorker) or coarser, so the shards are process-wide.
+  static mozilla::Atomic<FutexShards*, mozilla::SequentiallyConsistent>
+      shards_;
 
   // A flag that controls whether waiting is allowed.
   ThreadData<bool> canWait_;
@@ -1037,6 +1037,151 @@ class OwnNonIndexKeysIterForJSON {
   }
 };
 
+// Iterator over a range of keys in a ShapeKeysCacheForJSON. Unlike
+// OwnNonIndexKeysIterForJSON, this never fails: any reason to bail was found
+// when the keys were added to the cache.
+class CachedOwnKeysIterForJSON {
+  uint32_t cur_;
+  uint32_t end_;
+
+ public:
+  CachedOwnKeysIterForJSON(uint32_t start, uint32_t end)
+      : cur_(start), end_(end) {}
+
+  bool done() const { return cur_ == end_; }
+
+  uint32_t next() {
+    MOZ_ASSERT(!done());
+    return cur_++;
+  }
+};
+
+// Cache of the enumerable own string-keyed data properties of the Shapes seen
+// during a single FastSerializeJSONProperty call, along with their keys
+// already quoted and followed by ':'. Objects sharing a Shape store the same
+// keys in the same slots, so when stringifying many like-shaped objects (such
+// as an array of records) the property maps only have to be walked and the
+// keys escaped once per Shape.
+//
+// Nothing can GC or run script while the fast path is active, so holding raw
+// Shape pointers here is safe.
+class MOZ_STACK_CLASS ShapeKeysCacheForJSON {
+ public:
+  struct Key {
+    uint32_t slot;
+    uint32_t fragmentStart;
+    uint32_t fragmentLength;
+  };
+
+ private:
+  struct Entry {
+    NativeShape* shape;
+    uint32_t keysStart;
+    uint32_t keysEnd;
+  };
+
+  // Entries are never evicted, so that iterators saved on the fast path's
+  // stack remain valid. Once the cache is full, objects with new Shapes fall
+  // back to OwnNonIndexKeysIterForJSON.
+  static constexpr size_t MaxEntries = 16;
+
+  JSContext* cx_;
+  Vector<Entry, MaxEntries> entries_;
+  Vector<Key, 32> keys_;
+  StringBuilder fragments_;
+  size_t lastHit_ = 0;
+
+  CachedOwnKeysIterForJSON iterFor(size_t index) {
+    lastHit_ = index;
+    return CachedOwnKeysIterForJSON(entries_[index].keysStart,
+                                    entries_[index].keysEnd);
+  }
+
+ public:
+  explicit ShapeKeysCacheForJSON(JSContext* cx)
+      : cx_(cx), entries_(cx), keys_(cx), fragments_(cx) {}
+
+  const Key& key(uint32_t index) const { return keys_[index]; }
+
+  // Set |*result| to an iterator over the keys of |nobj|'s Shape, adding them
+  // to the cache first if necessary. Leaves |*result| empty if the Shape can't
+  // be cached, or sets |*whySlow| if the object's properties aren't supported
+  // by the fast path.
+  [[nodiscard]] bool lookup(NativeObject* nobj,
+                            Maybe<CachedOwnKeysIterForJSON>* result,
+                            BailReason* whySlow);
+
+  [[nodiscard]] bool appendKey(StringBuilder& sb, const Key& key) const {
+    if (fragments_.isUnderlyingBufferLatin1()) {
+      return sb.append(fragments_.rawLatin1Begin() + key.fragmentStart,
+                       key.fragmentLength);
+    }
+    return sb.append(fragments_.rawTwoByteBegin() + key.fragmentStart,
+                     key.fragmentLength);
+  }
+};
+
+bool ShapeKeysCacheForJSON::lookup(NativeObject* nobj,
+                                   Maybe<CachedOwnKeysIterForJSON>* result,
+                                   BailReason* whySlow) {
+  MOZ_ASSERT(result->isNothing());
+  MOZ_ASSERT(!nobj->is<ArrayObject>());
+
+  // Dictionary shapes are unique to their object, so caching them is useless.
+  NativeShape* shape = nobj->shape();
+  if (shape->isDictionary()) {
+    return true;
+  }
+
+  if (lastHit_ < entries_.length() && entries_[lastHit_].shape == shape) {
+    result->emplace(iterFor(lastHit_));
+    return true;
+  }
+  for (size_t i = 0; i < entries_.length(); i++) {
+    if (entries_[i].shape == shape) {
+      result->emplace(iterFor(i));
+      return true;
+    }
+  }
+
+  if (entries_.length() == MaxEntries) {
+    return true;
+  }
+
+  uint32_t keysStart = keys_.length();
+  OwnNonIndexKeysIterForJSON iter(nobj);
+  while (!iter.done()) {
+    PropertyInfoWithKey prop = iter.next();
+
+    // See the comment in FastSerializeJSONProperty.
+    mozilla::DebugOnly<uint32_t> index = -1;
+    MOZ_ASSERT(!IdIsIndex(prop.key(), &index));
+    MOZ_ASSERT(prop.key().isString());
+
+    size_t fragmentStart = fragments_.length();
+    if (!QuoteJSONString(cx_, fragments_, prop.key().toString()) ||
+        !fragments_.append(':')) {
+      return false;
+    }
+    Key key{prop.slot(), uint32_t(fragmentStart),
+            uint32_t(fragments_.length() - fragmentStart)};
+    if (!keys_.append(key)) {
+      return false;
+    }
+  }
+
+  *whySlow = iter.cannotFastStringify();
+  if (*whySlow != BailReason::NO_REASON) {
+    return true;
+  }
+
+  if (!entries_.append(Entry{shape, keysStart, uint32_t(keys_.length())})) {
+    return false;
+  }
+  result->emplace(iterFor(entries_.length() - 1));
+  return true;
+}
+
 // Steps from https://262.ecma-international.org/14.0/#sec-serializejsonproperty
 static bool EmitSimpleValue(JSContext* cx, StringBuilder& sb, const Value& v) {
   /* Step 8. */
@@ -1164,9 +1309,15 @@ static bool PreprocessFastValue(JSContext* cx, Value* vp, StringifyContext* scx,
 // The iterators for each of those parts are not merged into a single common
 // iterator because the interface is different for the two parts, and they are
 // handled separately in the FastSerializeJSONProperty code.
+//
+// Named properties are read through a CachedOwnKeysIterForJSON when the
+// object's Shape is in the ShapeKeysCacheForJSON, and through an
+// OwnNonIndexKeysIterForJSON otherwise.
 struct FastStackEntry {
   NativeObject* nobj;
-  Variant<DenseElementsIteratorForJSON, OwnNonIndexKeysIterForJSON> iter;
+  Variant<DenseElementsIteratorForJSON, OwnNonIndexKeysIterForJSON,
+          CachedOwnKeysIterForJSON>
+      iter;
   bool isArray;  // Cached nobj->is<ArrayObject>()
 
   // Given an object, a FastStackEntry starts with the dense elements. The
@@ -1192,6 +1343,18 @@ struct FastStackEntry {
   void advanceToProperties() {
     iter = AsVariant(OwnNonIndexKeysIterForJSON(nobj));
   }
+
+  // Advance from dense elements to the named properties, using keys that have
+  // already been cached for this object's Shape.
+  void advanceToCachedProperties(const CachedOwnKeysIterForJSON& cached) {
+    iter = AsVariant(cached);
+  }
+
+  bool propertiesDone() const {
+    return iter.is<CachedOwnKeysIterForJSON>()
+               ? iter.as<CachedOwnKeysIterForJSON>().done()
+               : iter.as<OwnNonIndexKeysIterForJSON>().done();
+  }
 };
 
 /* https://262.ecma-international.org/14.0/#sec-serializejsonproperty */
@@ -1267,6 +1430,7 @@ static bool FastSerializeJSONProperty(JSContext* cx, Handle<Value> v,
   if (!stack.reserve(MAX_STACK_DEPTH - 1)) {
     return false;
   }
+  ShapeKeysCacheForJSON keyCache(cx);
   // Construct an iterator for the object,
   // https://262.ecma-international.org/14.0/#sec-serializejsonobject step 6:
   // EnumerableOwnPropertyNames or
@@ -1358,14 +1522,24 @@ static bool FastSerializeJSONProperty(JSContext* cx, Handle<Value> v,
       if (top.isArray) {
         MOZ_ASSERT(!top.nobj->isIndexed() || IsPackedArray(top.nobj));
       } else {
-        top.advanceToProperties();
+        Maybe<CachedOwnKeysIterForJSON> cached;
+        if (!keyCache.lookup(top.nobj, &cached, whySlow)) {
+          return false;
+        }
+        if (*whySlow != BailReason::NO_REASON) {
+          return true;
+        }
+        if (cached) {
+          top.advanceToCachedProperties(*cached);
+        } else {
+          top.advanceToProperties();
+        }
       }
     }
 
-    if (top.iter.is<OwnNonIndexKeysIterForJSON>()) {
-      auto& iter = top.iter.as<OwnNonIndexKeysIterForJSON>();
+    if (!top.iter.is<DenseElementsIteratorForJSON>()) {
       bool nesting = false;
-      while (!iter.done()) {
+      while (!top.propertiesDone()) {
         // Interrupts can GC and we are working with unrooted pointers.
         if (cx->hasPendingInterrupt(InterruptReason::CallbackUrgent) ||
             cx->hasPendingInterrupt(InterruptReason::CallbackCanWait)) {
@@ -1373,16 +1547,29 @@ static bool FastSerializeJSONProperty(JSContext* cx, Handle<Value> v,
           return true;
         }
 
-        PropertyInfoWithKey prop = iter.next();
-
-        // A non-Array with indexed elements would need to sort the indexes
-        // numerically, which this code does not support. These objects are
-        // skipped when obj->isIndexed(), so no index properties should be found
-        // here.
-        mozilla::DebugOnly<uint32_t> index = -1;
-        MOZ_ASSERT(!IdIsIndex(prop.key(), &index));
+        const ShapeKeysCacheForJSON::Key* cachedKey = nullptr;
+        PropertyKey key;
+        uint32_t slot;
+        if (top.iter.is<CachedOwnKeysIterForJSON>()) {
+          cachedKey =
+              &keyCache.key(top.iter.as<CachedOwnKeysIterForJSON>().next());
+          slot = cachedKey->slot;
+        } else {
+          PropertyInfoWithKey prop =
+              top.iter.as<OwnNonIndexKeysIterForJSON>().next();
+
+          // A non-Array with indexed elements would need to sort the indexes
+          // numerically, which this code does not support. These objects are
+          // skipped when obj->isIndexed(), so no index properties should be
+          // found here.
+          mozilla::DebugOnly<uint32_t> index = -1;
+          MOZ_ASSERT(!IdIsIndex(prop.key(), &index));
+
+          key = prop.key();
+          slot = prop.slot();
+        }
 
-        Value val = top.nobj->getSlot(prop.slot());
+        Value val = top.nobj->getSlot(slot);
         if (!PreprocessFastValue(cx, &val, scx, whySlow)) {
           return false;
         }
@@ -1401,13 +1588,19 @@ static bool FastSerializeJSONProperty(JSContext* cx, Handle<Value> v,
         }
         wroteMember = true;
 
-        MOZ_ASSERT(prop.key().isString());
-        if (!QuoteJSONString(cx, scx->sb, prop.key().toString())) {
-          return false;
-        }
+        if (cachedKey) {
+          if (!keyCache.appendKey(scx->sb, *cachedKey)) {
+            return false;
+          }
+        } else {
+          MOZ_ASSERT(key.isString());
+          if (!QuoteJSONString(cx, scx->sb, key.toString())) {
+            return false;
+          }
 
-        if (!scx->sb.append(':')) {
-          return false;
+          if (!scx->sb.append(':')) {
+            return false;
+          }
         }
         if (val.isObject()) {
           if (JSString* rawJSON = MaybeGetRawJSON(cx, &val.toObject())) {
@@ -1431,14 +1624,17 @@ static bool FastSerializeJSONProperty(JSContext* cx, Handle<Value> v,
           return false;
         }
       }
-      *whySlow = iter.cannotFastStringify();
-      if (*whySlow != BailReason::NO_REASON) {
-        return true;
+      if (top.iter.is<OwnNonIndexKeysIterForJSON>()) {
+        auto& iter = top.iter.as<OwnNonIndexKeysIterForJSON>();
+        *whySlow = iter.cannotFastStringify();
+        if (*whySlow != BailReason::NO_REASON) {
+          return true;
+        }
       }
       if (nesting) {
         continue;  // Break out to outer loop.
       }
-      MOZ_ASSERT(iter.done());
+      MOZ_ASSERT(top.propertiesDone());
     }
 
     if (!scx->sb.append(top.isArray ? ']' : '}')) {
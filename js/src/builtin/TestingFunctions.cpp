@@ -6020,6 +6020,13 @@ bool js::testingFunc_serialize(JSContext* cx, unsigned argc, Value* vp) {
       }
     }
 
+    if (!JS_GetProperty(cx, opts, "shapeTemplates", &v)) {
+      return false;
+    }
+    if (ToBoolean(v)) {
+      policy.allowShapeTemplates();
+    }
+
     if (!JS_GetProperty(cx, opts, "scope", &v)) {
       return false;
     }
@@ -10298,6 +10305,8 @@ JS_FOR_WASM_FEATURES(WASM_FEATURE)
 "  clone buffer object. 'policy' may be an options hash. Valid keys:\n"
 "    'SharedArrayBuffer' - either 'allow' or 'deny' (the default)\n"
 "      to specify whether SharedArrayBuffers may be serialized.\n"
+"    'shapeTemplates' - if true, plain objects with the same shape are\n"
+"      written with their property names only once.\n"
 "    'scope' - SameProcess, DifferentProcess, or\n"
 "      DifferentProcessForIndexedDB. Determines how some values will be\n"
 "      serialized. Clone buffers may only be deserialized with a compatible\n"
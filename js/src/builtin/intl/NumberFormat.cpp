@@ -33,6 +33,7 @@
 #include "builtin/intl/FormatBuffer.h"
 #include "builtin/intl/LanguageTag.h"
 #include "builtin/intl/RelativeTimeFormat.h"
+#include "builtin/intl/SharedIntlData.h"
 #include "gc/GCContext.h"
 #include "js/CharacterEncoding.h"
 #include "js/PropertySpec.h"
@@ -174,15 +175,13 @@ void js::NumberFormatObject::finalize(JS::GCContext* gcx, JSObject* obj) {
   MOZ_ASSERT(gcx->onMainThread());
 
   auto* numberFormat = &obj->as<NumberFormatObject>();
-  mozilla::intl::NumberFormat* nf = numberFormat->getNumberFormatter();
+  intl::SharedNumberFormat* nf = numberFormat->getNumberFormatter();
   mozilla::intl::NumberRangeFormat* nrf =
       numberFormat->getNumberRangeFormatter();
 
+  // The number formatter's memory is accounted to SharedIntlData.
   if (nf) {
-    intl::RemoveICUCellMemory(gcx, obj, NumberFormatObject::EstimatedMemoryUse);
-    // This was allocated using `new` in mozilla::intl::NumberFormat, so we
-    // delete here.
-    delete nf;
+    gcx->runtime()->sharedIntlData.ref().releaseNumberFormat(nf);
   }
 
   if (nrf) {
@@ -759,22 +758,46 @@ static Formatter* NewNumberFormat(JSContext* cx,
   return nullptr;
 }
 
+/**
+ * Returns a shared mozilla::intl::NumberFormat with the locale and number
+ * formatting options of the given NumberFormat, or a nullptr if
+ * initialization failed.
+ */
+static intl::SharedNumberFormat* GetSharedNumberFormat(
+    JSContext* cx, Handle<NumberFormatObject*> numberFormat) {
+  RootedObject internals(cx, intl::GetInternalsObject(cx, numberFormat));
+  if (!internals) {
+    return nullptr;
+  }
+
+  UniqueChars locale = NumberFormatLocale(cx, internals);
+  if (!locale) {
+    return nullptr;
+  }
+
+  NumberFormatOptions options;
+  if (!FillNumberFormatOptions(cx, internals, options)) {
+    return nullptr;
+  }
+
+  intl::SharedIntlData& sharedIntlData = cx->runtime()->sharedIntlData.ref();
+  return sharedIntlData.getNumberFormat(cx, locale.get(), options);
+}
+
 static mozilla::intl::NumberFormat* GetOrCreateNumberFormat(
     JSContext* cx, Handle<NumberFormatObject*> numberFormat) {
   // Obtain a cached mozilla::intl::NumberFormat object.
-  mozilla::intl::NumberFormat* nf = numberFormat->getNumberFormatter();
+  intl::SharedNumberFormat* nf = numberFormat->getNumberFormatter();
   if (nf) {
-    return nf;
+    return nf->numberFormat();
   }
 
-  nf = NewNumberFormat<mozilla::intl::NumberFormat>(cx, numberFormat);
+  nf = GetSharedNumberFormat(cx, numberFormat);
   if (!nf) {
     return nullptr;
   }
   numberFormat->setNumberFormatter(nf);
-
-  intl::AddICUCellMemory(numberFormat, NumberFormatObject::EstimatedMemoryUse);
-  return nf;
+  return nf->numberFormat();
 }
 
 static mozilla::intl::NumberRangeFormat* GetOrCreateNumberRangeFormat(
@@ -20,6 +20,10 @@ class NumberRangeFormat;
 
 namespace js {
 
+namespace intl {
+class SharedNumberFormat;
+}
+
 class NumberFormatObject : public NativeObject {
  public:
   static const JSClass class_;
@@ -35,22 +39,25 @@ class NumberFormatObject : public NativeObject {
                 "object slot");
 
   // Estimated memory use for UNumberFormatter and UFormattedNumber
-  // (see IcuMemoryUsage).
+  // (see IcuMemoryUsage). Number formatters are shared, so this is charged to
+  // intl::SharedIntlData rather than to each object.
   static constexpr size_t EstimatedMemoryUse = 972;
 
   // Estimated memory use for UNumberRangeFormatter and UFormattedNumberRange
   // (see IcuMemoryUsage).
   static constexpr size_t EstimatedRangeFormatterMemoryUse = 19894;
 
-  mozilla::intl::NumberFormat* getNumberFormatter() const {
+  // The number formatter is shared with other NumberFormat objects using the
+  // same locale and options, see intl::SharedIntlData::getNumberFormat.
+  intl::SharedNumberFormat* getNumberFormatter() const {
     const auto& slot = getFixedSlot(UNUMBER_FORMATTER_SLOT);
     if (slot.isUndefined()) {
       return nullptr;
     }
-    return static_cast<mozilla::intl::NumberFormat*>(slot.toPrivate());
+    return static_cast<intl::SharedNumberFormat*>(slot.toPrivate());
   }
 
-  void setNumberFormatter(mozilla::intl::NumberFormat* formatter) {
+  void setNumberFormatter(intl::SharedNumberFormat* formatter) {
     setFixedSlot(UNUMBER_FORMATTER_SLOT, PrivateValue(formatter));
   }
 
@@ -16,6 +16,7 @@
 #include "mozilla/intl/Locale.h"
 #include "mozilla/intl/NumberFormat.h"
 #include "mozilla/intl/TimeZone.h"
+#include "mozilla/Maybe.h"
 #include "mozilla/Span.h"
 #include "mozilla/TextUtils.h"
 
@@ -24,10 +25,12 @@
 #include <string>
 #include <string.h>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 
 #include "builtin/Array.h"
 #include "builtin/intl/CommonFunctions.h"
+#include "builtin/intl/NumberFormat.h"
 #include "builtin/intl/TimeZoneDataGenerated.h"
 #include "js/Utility.h"
 #include "js/Vector.h"
@@ -808,6 +811,144 @@ js::intl::SharedIntlData::getDateTimePatternGenerator(JSContext* cx,
   return dateTimePatternGenerator.get();
 }
 
+js::intl::SharedNumberFormat::~SharedNumberFormat() {
+  MOZ_ASSERT(!useCount_);
+  MOZ_ASSERT(!cached_);
+
+  // This was allocated using `new` in mozilla::intl::NumberFormat, so we
+  // delete here.
+  delete numberFormat_;
+}
+
+size_t js::intl::SharedNumberFormat::sizeOfIncludingThis(
+    mozilla::MallocSizeOf mallocSizeOf) const {
+  // ICU's memory isn't visible to |mallocSizeOf|, so add the estimate from
+  // NumberFormatObject.
+  return mallocSizeOf(this) + mallocSizeOf(key_.get()) +
+         NumberFormatObject::EstimatedMemoryUse;
+}
+
+using NumberFormatKey = js::Vector<char, 128>;
+
+template <typename T>
+static bool AppendToKey(NumberFormatKey& key, const T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  return key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static bool AppendToKey(NumberFormatKey& key, std::string_view str) {
+  return AppendToKey(key, str.length()) && key.append(str.data(), str.length());
+}
+
+template <typename T, typename U>
+static bool AppendToKey(NumberFormatKey& key, const std::pair<T, U>& value) {
+  return AppendToKey(key, value.first) && AppendToKey(key, value.second);
+}
+
+template <typename T>
+static bool AppendToKey(NumberFormatKey& key, const mozilla::Maybe<T>& value) {
+  if (!AppendToKey(key, value.isSome())) {
+    return false;
+  }
+  return value.isNothing() || AppendToKey(key, *value);
+}
+
+/**
+ * Encode |locale| and all fields of |options| into |key|. Two formatters with
+ * equal keys format identically.
+ *
+ * This must be kept in sync with mozilla::intl::NumberFormatOptions.
+ */
+static bool NumberFormatCacheKey(
+    NumberFormatKey& key, const char* locale,
+    const mozilla::intl::NumberFormatOptions& options) {
+  return AppendToKey(key, std::string_view(locale)) &&
+         AppendToKey(key, options.mCurrency) &&
+         AppendToKey(key, options.mFractionDigits) &&
+         AppendToKey(key, options.mMinIntegerDigits) &&
+         AppendToKey(key, options.mSignificantDigits) &&
+         AppendToKey(key, options.mUnit) &&
+         AppendToKey(key, options.mPercent) &&
+         AppendToKey(key, options.mStripTrailingZero) &&
+         AppendToKey(key, options.mGrouping) &&
+         AppendToKey(key, options.mNotation) &&
+         AppendToKey(key, options.mSignDisplay) &&
+         AppendToKey(key, options.mRoundingIncrement) &&
+         AppendToKey(key, options.mRoundingMode) &&
+         AppendToKey(key, options.mRoundingPriority);
+}
+
+js::intl::SharedNumberFormat* js::intl::SharedIntlData::getNumberFormat(
+    JSContext* cx, const char* locale,
+    const mozilla::intl::NumberFormatOptions& options) {
+  NumberFormatKey key(cx);
+  if (!NumberFormatCacheKey(key, locale, options)) {
+    return nullptr;
+  }
+
+  // Return the cached instance and mark it as most recently used.
+  for (size_t i = numberFormatCache.length(); i > 0; i--) {
+    SharedNumberFormat* entry = numberFormatCache[i - 1];
+    if (entry->keyLength_ == key.length() &&
+        std::equal(key.begin(), key.end(), entry->key_.get())) {
+      numberFormatCache.erase(&numberFormatCache[i - 1]);
+      numberFormatCache.infallibleAppend(entry);
+
+      entry->useCount_++;
+      return entry;
+    }
+  }
+
+  auto result = mozilla::intl::NumberFormat::TryCreate(locale, options);
+  if (result.isErr()) {
+    intl::ReportInternalError(cx, result.unwrapErr());
+    return nullptr;
+  }
+  mozilla::UniquePtr<mozilla::intl::NumberFormat> nf = result.unwrap();
+
+  JS::UniqueChars keyCopy = cx->make_pod_array<char>(key.length());
+  if (!keyCopy) {
+    return nullptr;
+  }
+  std::copy(key.begin(), key.end(), keyCopy.get());
+
+  auto* entry = cx->new_<SharedNumberFormat>(nf.release(), std::move(keyCopy),
+                                             key.length());
+  if (!entry) {
+    return nullptr;
+  }
+  entry->useCount_ = 1;
+  numberFormats.insertBack(entry);
+
+  // Evict the least recently used formatter. It's deleted once the last
+  // object using it is finalized.
+  if (numberFormatCache.length() == NumberFormatCacheLength) {
+    SharedNumberFormat* evicted = numberFormatCache[0];
+    numberFormatCache.erase(numberFormatCache.begin());
+
+    evicted->cached_ = false;
+    if (!evicted->useCount_) {
+      js_delete(evicted);
+    }
+  }
+
+  // Caching is optional, so ignore OOM here.
+  if (numberFormatCache.append(entry)) {
+    entry->cached_ = true;
+  }
+
+  return entry;
+}
+
+void js::intl::SharedIntlData::releaseNumberFormat(
+    SharedNumberFormat* numberFormat) {
+  MOZ_ASSERT(numberFormat->useCount_ > 0);
+
+  if (--numberFormat->useCount_ == 0 && !numberFormat->cached_) {
+    js_delete(numberFormat);
+  }
+}
+
 void js::intl::SharedIntlData::destroyInstance() {
   availableTimeZones.clearAndCompact();
   ianaZonesTreatedAsLinksByICU.clearAndCompact();
@@ -818,6 +959,20 @@ void js::intl::SharedIntlData::destroyInstance() {
   upperCaseFirstLocales.clearAndCompact();
   ignorePunctuationLocales.clearAndCompact();
 #endif
+
+  // Formatters still in use are deleted when their last user is finalized.
+  for (SharedNumberFormat* entry : numberFormatCache) {
+    entry->cached_ = false;
+    if (!entry->useCount_) {
+      js_delete(entry);
+    }
+  }
+  numberFormatCache.clearAndFree();
+
+  // Unlink the formatters which are still in use, they outlive this list.
+  while (!numberFormats.isEmpty()) {
+    numberFormats.popFirst();
+  }
 }
 
 void js::intl::SharedIntlData::trace(JSTracer* trc) {
@@ -837,15 +992,21 @@ void js::intl::SharedIntlData::trace(JSTracer* trc) {
 
 size_t js::intl::SharedIntlData::sizeOfExcludingThis(
     mozilla::MallocSizeOf mallocSizeOf) const {
-  return availableTimeZones.shallowSizeOfExcludingThis(mallocSizeOf) +
-         ianaZonesTreatedAsLinksByICU.shallowSizeOfExcludingThis(mallocSizeOf) +
-         ianaLinksCanonicalizedDifferentlyByICU.shallowSizeOfExcludingThis(
-             mallocSizeOf) +
-         supportedLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
-         collatorSupportedLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
+  size_t size =
+      availableTimeZones.shallowSizeOfExcludingThis(mallocSizeOf) +
+      ianaZonesTreatedAsLinksByICU.shallowSizeOfExcludingThis(mallocSizeOf) +
+      ianaLinksCanonicalizedDifferentlyByICU.shallowSizeOfExcludingThis(
+          mallocSizeOf) +
+      supportedLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
+      collatorSupportedLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
 #if DEBUG || MOZ_SYSTEM_ICU
-         upperCaseFirstLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
-         ignorePunctuationLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
+      upperCaseFirstLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
+      ignorePunctuationLocales.shallowSizeOfExcludingThis(mallocSizeOf) +
 #endif
-         mallocSizeOf(dateTimePatternGeneratorLocale.get());
+      mallocSizeOf(dateTimePatternGeneratorLocale.get()) +
+      numberFormatCache.sizeOfExcludingThis(mallocSizeOf);
+  for (const SharedNumberFormat* entry : numberFormats) {
+    size += entry->sizeOfIncludingThis(mallocSizeOf);
+  }
+  return size;
 }
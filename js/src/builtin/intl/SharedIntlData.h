@@ -7,10 +7,12 @@
 #ifndef builtin_intl_SharedIntlData_h
 #define builtin_intl_SharedIntlData_h
 
+#include "mozilla/LinkedList.h"
 #include "mozilla/MemoryReporting.h"
 #include "mozilla/UniquePtr.h"
 
 #include <stddef.h>
+#include <utility>
 
 #include "js/AllocPolicy.h"
 #include "js/GCAPI.h"
@@ -18,10 +20,13 @@
 #include "js/Result.h"
 #include "js/RootingAPI.h"
 #include "js/Utility.h"
+#include "js/Vector.h"
 #include "vm/StringType.h"
 
 namespace mozilla::intl {
 class DateTimePatternGenerator;
+class NumberFormat;
+struct NumberFormatOptions;
 }  // namespace mozilla::intl
 
 namespace js {
@@ -39,6 +44,38 @@ class DateTimePatternGeneratorDeleter {
   void operator()(mozilla::intl::DateTimePatternGenerator* ptr);
 };
 
+/**
+ * A mozilla::intl::NumberFormat shared by all Intl.NumberFormat objects in a
+ * runtime which use the same locale and number formatting options.
+ *
+ * Instances are owned by SharedIntlData and kept alive while any object uses
+ * them or while they're in the cache, see SharedIntlData::getNumberFormat.
+ * Their memory is reported once, by SharedIntlData, rather than by each
+ * object using them.
+ */
+class SharedNumberFormat
+    : public mozilla::LinkedListElement<SharedNumberFormat> {
+  friend class SharedIntlData;
+
+  mozilla::intl::NumberFormat* numberFormat_;
+  JS::UniqueChars key_;
+  size_t keyLength_;
+  uint32_t useCount_ = 0;
+  bool cached_ = false;
+
+ public:
+  SharedNumberFormat(mozilla::intl::NumberFormat* numberFormat,
+                     JS::UniqueChars key, size_t keyLength)
+      : numberFormat_(numberFormat),
+        key_(std::move(key)),
+        keyLength_(keyLength) {}
+  ~SharedNumberFormat();
+
+  mozilla::intl::NumberFormat* numberFormat() const { return numberFormat_; }
+
+  size_t sizeOfIncludingThis(mozilla::MallocSizeOf mallocSizeOf) const;
+};
+
 /**
  * Stores Intl data which can be shared across compartments (but not contexts).
  *
@@ -341,6 +378,33 @@ class SharedIntlData {
   mozilla::intl::DateTimePatternGenerator* getDateTimePatternGenerator(
       JSContext* cx, const char* locale);
 
+ private:
+  // Maximum number of number formatters kept alive when no longer in use.
+  static constexpr size_t NumberFormatCacheLength = 16;
+
+  // Recently used number formatters, least recently used first.
+  js::Vector<SharedNumberFormat*, 0, js::SystemAllocPolicy> numberFormatCache;
+
+  // All live number formatters, whether they're cached or not.
+  mozilla::LinkedList<SharedNumberFormat> numberFormats;
+
+ public:
+  /**
+   * Get a number formatter for |locale| and |options|, creating ICU
+   * formatters only when no formatter with the same locale and options is
+   * cached. The caller must call |releaseNumberFormat| when done with the
+   * formatter.
+   *
+   * Creating ICU number formatters is expensive, and toLocaleString calls
+   * with explicit locales or options create a new Intl.NumberFormat object
+   * each time.
+   */
+  SharedNumberFormat* getNumberFormat(
+      JSContext* cx, const char* locale,
+      const mozilla::intl::NumberFormatOptions& options);
+
+  void releaseNumberFormat(SharedNumberFormat* numberFormat);
+
  public:
   void destroyInstance();
 
@@ -14,6 +14,8 @@
 #ifdef LIFO_CHUNK_PROTECT
 #  include "gc/Memory.h"
 #endif
+#include "threading/Mutex.h"
+#include "vm/MutexIDs.h"
 
 using namespace js;
 
@@ -30,7 +32,7 @@ UniquePtr<BumpChunk> BumpChunk::newWithCapacity(size_t size, arena_id_t arena) {
     return nullptr;
   }
 
-  UniquePtr<BumpChunk> result(new (mem) BumpChunk(size));
+  UniquePtr<BumpChunk> result(new (mem) BumpChunk(size, arena));
 
   // We assume that the alignment of LIFO_ALLOC_ALIGN is less than that of the
   // underlying memory allocator -- creating a new BumpChunk should always
@@ -94,6 +96,126 @@ void BumpChunk::setReadWrite() {
 }  // namespace detail
 }  // namespace js
 
+static constexpr size_t LifoChunkPoolSizeClasses =
+    mozilla::tl::FloorLog2<LifoChunkPool::MaxChunkSize>::value -
+    mozilla::tl::FloorLog2<LifoChunkPool::MinChunkSize>::value + 1;
+
+// The lock is taken with no other lock held, or from within LifoAlloc code
+// which may run under any other lock, so it is ordered after all of them.
+MOZ_RUNINIT static Mutex gLifoChunkPoolLock(mutexid::LifoChunkPool);
+
+// MallocArena and BackgroundMallocArena chunks are pooled separately.
+static constexpr size_t LifoChunkPoolArenas = 2;
+
+// Free lists of released chunks, indexed by arena and size class, and the sum
+// of their sizes. Both are protected by gLifoChunkPoolLock.
+MOZ_RUNINIT static detail::SingleLinkedList<detail::BumpChunk>
+    gLifoChunkPool[LifoChunkPoolArenas][LifoChunkPoolSizeClasses];
+static size_t gLifoChunkPoolBytes = 0;
+
+// Return the index of the free lists for chunks from |arena|, or -1 if such
+// chunks are not pooled.
+static int LifoChunkPoolArena(arena_id_t arena) {
+  if (arena == js::MallocArena) {
+    return 0;
+  }
+  if (arena == js::BackgroundMallocArena) {
+    return 1;
+  }
+  return -1;
+}
+
+// Return the free list index for chunks of |size| bytes, or -1 if such chunks
+// are not pooled.
+static int LifoChunkPoolSizeClass(size_t size) {
+  if (size < LifoChunkPool::MinChunkSize ||
+      size > LifoChunkPool::MaxChunkSize || !mozilla::IsPowerOfTwo(size)) {
+    return -1;
+  }
+  return int(mozilla::FloorLog2(size) -
+             mozilla::FloorLog2(LifoChunkPool::MinChunkSize));
+}
+
+/* static */
+UniquePtr<detail::BumpChunk> LifoChunkPool::take(size_t size,
+                                                  arena_id_t arena) {
+  int arenaIndex = LifoChunkPoolArena(arena);
+  int sizeClass = LifoChunkPoolSizeClass(size);
+  if (arenaIndex < 0 || sizeClass < 0) {
+    return nullptr;
+  }
+
+  LockGuard<Mutex> lock(gLifoChunkPoolLock);
+  auto& list = gLifoChunkPool[arenaIndex][sizeClass];
+  if (list.empty()) {
+    return nullptr;
+  }
+
+  UniquePtr<detail::BumpChunk> chunk = list.popFirst();
+  MOZ_ASSERT(chunk->empty());
+  MOZ_ASSERT(chunk->arena() == arena);
+  MOZ_ASSERT(chunk->computedSizeOfIncludingThis() == size);
+  MOZ_ASSERT(gLifoChunkPoolBytes >= size);
+  gLifoChunkPoolBytes -= size;
+  return chunk;
+}
+
+/* static */
+void LifoChunkPool::give(UniquePtr<detail::BumpChunk> chunk) {
+  MOZ_ASSERT(chunk->empty());
+
+  size_t size = chunk->computedSizeOfIncludingThis();
+  int arenaIndex = LifoChunkPoolArena(chunk->arena());
+  int sizeClass = LifoChunkPoolSizeClass(size);
+  if (arenaIndex < 0 || sizeClass < 0) {
+    return;
+  }
+
+  {
+    LockGuard<Mutex> lock(gLifoChunkPoolLock);
+    if (gLifoChunkPoolBytes + size <= MaxPooledBytes) {
+      gLifoChunkPool[arenaIndex][sizeClass].pushFront(std::move(chunk));
+      gLifoChunkPoolBytes += size;
+      return;
+    }
+  }
+
+  // The pool is full; |chunk| is freed here, outside the lock.
+}
+
+/* static */
+void LifoChunkPool::purge() {
+  detail::SingleLinkedList<detail::BumpChunk> chunks;
+  {
+    LockGuard<Mutex> lock(gLifoChunkPoolLock);
+    for (auto& lists : gLifoChunkPool) {
+      for (auto& list : lists) {
+        chunks.appendAll(std::move(list));
+      }
+    }
+    gLifoChunkPoolBytes = 0;
+  }
+
+  while (!chunks.empty()) {
+    chunks.popFirst();
+  }
+}
+
+/* static */
+size_t LifoChunkPool::sizeOfExcludingThis(
+    mozilla::MallocSizeOf mallocSizeOf) {
+  LockGuard<Mutex> lock(gLifoChunkPoolLock);
+  size_t n = 0;
+  for (auto& lists : gLifoChunkPool) {
+    for (auto& list : lists) {
+      for (detail::BumpChunk& bc : list) {
+        n += bc.sizeOfIncludingThis(mallocSizeOf);
+      }
+    }
+  }
+  return n;
+}
+
 void LifoAlloc::reset(size_t defaultChunkSize) {
   MOZ_ASSERT(mozilla::IsPowerOfTwo(defaultChunkSize));
 
@@ -122,6 +244,10 @@ void LifoAlloc::freeAll() {
   while (!chunks_.empty()) {
     UniqueBumpChunk bc = chunks_.popFirst();
     decrementCurSize(bc->computedSizeOfIncludingThis());
+    if (pooled_) {
+      bc->release();
+      LifoChunkPool::give(std::move(bc));
+    }
   }
   while (!oversize_.empty()) {
     UniqueBumpChunk bc = oversize_.popFirst();
@@ -130,6 +256,9 @@ void LifoAlloc::freeAll() {
   while (!unused_.empty()) {
     UniqueBumpChunk bc = unused_.popFirst();
     decrementCurSize(bc->computedSizeOfIncludingThis());
+    if (pooled_) {
+      LifoChunkPool::give(std::move(bc));
+    }
   }
 
   // Nb: maintaining curSize_ correctly isn't easy.  Fortunately, this is an
@@ -184,6 +313,14 @@ LifoAlloc::UniqueBumpChunk LifoAlloc::newChunkWithCapacity(size_t n,
                                ? MallocGoodSize(minSize)
                                : NextSize(defaultChunkSize_, smallAllocsSize_);
 
+  // Reuse a chunk freed by another pooled LifoAlloc if one of this exact size
+  // from the same arena is available.
+  if (pooled_ && !oversize) {
+    if (UniqueBumpChunk result = LifoChunkPool::take(chunkSize, arena_)) {
+      return result;
+    }
+  }
+
   // Create a new BumpChunk, and allocate space for it.
   UniqueBumpChunk result =
       detail::BumpChunk::newWithCapacity(chunkSize, arena_);
@@ -387,6 +387,8 @@ class BumpChunk : public SingleLinkedListElement<BumpChunk> {
   uint8_t* bump_;
   // Pointer to the first byte after this chunk.
   uint8_t* const capacity_;
+  // Arena the chunk was allocated from.
+  const arena_id_t arena_;
 
 #ifdef MOZ_DIAGNOSTIC_ASSERT_ENABLED
   // Magic number used to check against poisoned values.
@@ -445,9 +447,10 @@ class BumpChunk : public SingleLinkedListElement<BumpChunk> {
   BumpChunk& operator=(const BumpChunk&) = delete;
   BumpChunk(const BumpChunk&) = delete;
 
-  explicit BumpChunk(uintptr_t capacity)
+  BumpChunk(uintptr_t capacity, arena_id_t arena)
       : bump_(begin()),
-        capacity_(base() + capacity)
+        capacity_(base() + capacity),
+        arena_(arena)
 #ifdef MOZ_DIAGNOSTIC_ASSERT_ENABLED
         ,
         magic_(magicNumber)
@@ -518,6 +521,8 @@ class BumpChunk : public SingleLinkedListElement<BumpChunk> {
   // argument includes the space needed for the header of the chunk.
   static UniquePtr<BumpChunk> newWithCapacity(size_t size, arena_id_t arena);
 
+  arena_id_t arena() const { return arena_; }
+
   // Report allocation.
   size_t sizeOfIncludingThis(mozilla::MallocSizeOf mallocSizeOf) const {
     return mallocSizeOf(this);
@@ -661,6 +666,38 @@ inline uint8_t* BumpChunk::begin() { return base() + BumpChunkReservedSpace; }
 
 }  // namespace detail
 
+// Process-wide, bounded pool of free BumpChunks shared by the LifoAllocs which
+// opt in with LifoAlloc::usePooledChunks(). Short-lived LifoAllocs, such as
+// the temporary ones used by each parse or wasm compilation task, return their
+// chunks here when they are destroyed so that the next one can reuse them
+// instead of going back to malloc.
+//
+// Only chunks whose size is a power of two between MinChunkSize and
+// MaxChunkSize are pooled, with one free list per size, and at most
+// MaxPooledBytes are kept in total. Chunks are kept apart by the arena they
+// were allocated from, so that a LifoAlloc only ever gets chunks from its own
+// arena; only MallocArena and BackgroundMallocArena chunks are pooled. The
+// pool can be used from any thread and is purged on shrinking GCs.
+class LifoChunkPool {
+ public:
+  static constexpr size_t MinChunkSize = 4 * 1024;
+  static constexpr size_t MaxChunkSize = 1024 * 1024;
+  static constexpr size_t MaxPooledBytes = 4 * 1024 * 1024;
+
+  // Take a released chunk of exactly |size| bytes allocated from |arena|, or
+  // return nullptr if the pool has none.
+  static js::UniquePtr<detail::BumpChunk> take(size_t size, arena_id_t arena);
+
+  // Give a released chunk to the pool. Chunks which cannot be pooled are
+  // freed.
+  static void give(js::UniquePtr<detail::BumpChunk> chunk);
+
+  // Free all the chunks held by the pool.
+  static void purge();
+
+  static size_t sizeOfExcludingThis(mozilla::MallocSizeOf mallocSizeOf);
+};
+
 // LIFO bump allocator: used for phase-oriented and fast LIFO allocations.
 //
 // Note: We leave BumpChunks latent in the set of unused chunks after they've
@@ -710,6 +747,9 @@ class LifoAlloc {
   // whatever is most current and pick whichever performs better.
   arena_id_t arena_;
 
+  // Whether chunks are drawn from and returned to the LifoChunkPool.
+  bool pooled_;
+
 #if defined(DEBUG) || defined(JS_OOM_BREAKPOINT)
   bool fallibleScope_;
 #endif
@@ -779,7 +819,8 @@ class LifoAlloc {
  public:
   LifoAlloc(size_t defaultChunkSize, arena_id_t arena)
       : peakSize_(0),
-        arena_(arena)
+        arena_(arena),
+        pooled_(false)
 #if defined(DEBUG) || defined(JS_OOM_BREAKPOINT)
         ,
         fallibleScope_(true)
@@ -796,6 +837,11 @@ class LifoAlloc {
     oversizeThreshold_ = oversizeThreshold;
   }
 
+  // Draw new chunks from the LifoChunkPool and give them back to it when this
+  // LifoAlloc frees them. This is meant for short-lived LifoAllocs which are
+  // created and destroyed repeatedly.
+  void usePooledChunks() { pooled_ = true; }
+
   // Steal allocated chunks from |other|.
   void steal(LifoAlloc* other);
 
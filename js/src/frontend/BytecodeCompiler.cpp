@@ -425,6 +425,7 @@ static already_AddRefed<JS::Stencil> CompileGlobalScriptToStencilImpl(
   NoScopeBindingCache scopeCache;
   js::LifoAlloc tempLifoAlloc(JSContext::TEMP_LIFO_ALLOC_PRIMARY_CHUNK_SIZE,
                               js::BackgroundMallocArena);
+  tempLifoAlloc.usePooledChunks();
   CompilationInput compilationInput(options);
   RefPtr<InitialStencilAndDelazifications> stencils;
   if (!CompileGlobalScriptToStencilAndMaybeInstantiate(
@@ -1268,6 +1269,7 @@ static already_AddRefed<JS::Stencil> CompileModuleScriptToStencilImpl(
   NoScopeBindingCache scopeCache;
   js::LifoAlloc tempLifoAlloc(JSContext::TEMP_LIFO_ALLOC_PRIMARY_CHUNK_SIZE,
                               js::BackgroundMallocArena);
+  tempLifoAlloc.usePooledChunks();
   RefPtr<CompilationStencil> stencil = ParseModuleToStencilImpl(
       nullptr, fc, tempLifoAlloc, compilationInput, &scopeCache, srcBuf);
   if (!stencil) {
@@ -14,6 +14,7 @@
 #include "mozilla/Maybe.h"
 #include "mozilla/MemoryChecking.h"
 #include "mozilla/ScopeExit.h"
+#include "mozilla/SIMD.h"
 #include "mozilla/Span.h"
 #include "mozilla/TemplateLib.h"
 #include "mozilla/TextUtils.h"
@@ -58,6 +59,7 @@ using mozilla::IsTrailingUnit;
 using mozilla::MakeScopeExit;
 using mozilla::Maybe;
 using mozilla::PointerRangeSize;
+using mozilla::SIMD;
 using mozilla::Span;
 using mozilla::Utf8Unit;
 
@@ -2097,6 +2099,10 @@ template <typename Unit, class AnyCharsAccess>
   // code points in the loop below.
   int32_t unit;
   while (true) {
+    // Most identifiers are entirely ASCII, so skip runs of ASCII identifier
+    // characters in bulk before examining code units one at a time.
+    this->sourceUnits.consumeAsciiIdentifierParts();
+
     unit = peekCodeUnit();
     if (unit == EOF) {
       break;
@@ -2259,6 +2265,12 @@ static_assert(LastCharKind < (1 << (sizeof(firstCharKinds[0]) * 8)),
 template <>
 void SourceUnits<char16_t>::consumeRestOfSingleLineComment() {
   while (MOZ_LIKELY(!atEnd())) {
+    // Skip over ASCII that can't end the comment in bulk.
+    ptr = SIMD::skipAsciiLineChars16(ptr, remaining());
+    if (atEnd()) {
+      return;
+    }
+
     char16_t unit = peekCodeUnit();
     if (IsLineTerminator(unit)) {
       return;
@@ -2271,6 +2283,13 @@ void SourceUnits<char16_t>::consumeRestOfSingleLineComment() {
 template <>
 void SourceUnits<Utf8Unit>::consumeRestOfSingleLineComment() {
   while (MOZ_LIKELY(!atEnd())) {
+    // Skip over ASCII that can't end the comment in bulk.
+    ptr = reinterpret_cast<const Utf8Unit*>(SIMD::skipAsciiLineChars8(
+        reinterpret_cast<const char*>(ptr), remaining()));
+    if (atEnd()) {
+      return;
+    }
+
     const Utf8Unit unit = peekCodeUnit();
     if (IsSingleUnitLineTerminator(unit)) {
       return;
@@ -2296,6 +2315,41 @@ void SourceUnits<Utf8Unit>::consumeRestOfSingleLineComment() {
   }
 }
 
+// Skip ASCII IdentifierPart code units in [ptr, limit). The vectorized scan in
+// mozglue looks at 16 bytes at a time, so only call out to it when there's at
+// least that much source left; the last few code units are checked here.
+template <typename CharT>
+static MOZ_ALWAYS_INLINE const CharT* SkipAsciiIdentifierParts(
+    const CharT* ptr, const CharT* limit,
+    const CharT* (*skipVectorized)(const CharT*, size_t)) {
+  size_t length = PointerRangeSize(ptr, limit);
+  if (length >= 16 / sizeof(CharT)) {
+    return skipVectorized(ptr, length);
+  }
+
+  for (; ptr < limit; ptr++) {
+    CharT unit = *ptr;
+    if (!IsAsciiAlpha(unit) && !IsAsciiDigit(unit) && unit != '_' &&
+        unit != '$') {
+      break;
+    }
+  }
+  return ptr;
+}
+
+template <>
+void SourceUnits<char16_t>::consumeAsciiIdentifierParts() {
+  ptr = SkipAsciiIdentifierParts(ptr, limit_,
+                                 SIMD::skipAsciiIdentifierChars16);
+}
+
+template <>
+void SourceUnits<Utf8Unit>::consumeAsciiIdentifierParts() {
+  ptr = reinterpret_cast<const Utf8Unit*>(SkipAsciiIdentifierParts(
+      reinterpret_cast<const char*>(ptr), reinterpret_cast<const char*>(limit_),
+      SIMD::skipAsciiIdentifierChars8));
+}
+
 template <typename Unit, class AnyCharsAccess>
 [[nodiscard]] MOZ_ALWAYS_INLINE bool
 TokenStreamSpecific<Unit, AnyCharsAccess>::matchInteger(
@@ -1459,6 +1459,13 @@ class SourceUnits {
    */
   void consumeRestOfSingleLineComment();
 
+  /**
+   * Consume a run of ASCII IdentifierPart code units (ASCII letters, digits,
+   * '_' and '$'), stopping at the first code unit that isn't one.  Non-ASCII
+   * IdentifierPart code points and escapes are left to the caller.
+   */
+  void consumeAsciiIdentifierParts();
+
   /**
    * The maximum radius of code around the location of an error that should
    * be included in a syntax error message -- this many code units to either
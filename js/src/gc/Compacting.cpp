@@ -706,6 +706,22 @@ void GCRuntime::updateCellPointers(Zone* zone, AllocKinds kinds) {
   for (; !fgArenas.done(); fgArenas.next()) {
     UpdateArenaListSegmentPointers(this, fgArenas.get());
   }
+
+  // Once the foreground-only kinds are finished, take segments from the same
+  // work list as the helper threads rather than sitting idle until they have
+  // all finished. The list is only accessed with the helper thread lock held.
+  for (;;) {
+    ArenaListSegment segment;
+    {
+      AutoLockHelperThreadState lock;
+      if (bgArenas.done()) {
+        break;
+      }
+      segment = bgArenas.get();
+      bgArenas.next();
+    }
+    UpdateArenaListSegmentPointers(this, segment);
+  }
 }
 
 // After cells have been relocated any pointers to a cell's old locations must
@@ -209,6 +209,7 @@
 #include "jstypes.h"
 
 #include "debugger/DebugAPI.h"
+#include "ds/LifoAlloc.h"
 #include "gc/ClearEdgesTracer.h"
 #include "gc/GCContext.h"
 #include "gc/GCInternals.h"
@@ -2464,6 +2465,9 @@ void GCRuntime::purgeRuntime() {
 
   if (rt->isMainRuntime()) {
     SharedImmutableStringsCache::getSingleton().purge();
+    if (isShrinkingGC()) {
+      LifoChunkPool::purge();
+    }
   }
 
   MOZ_ASSERT(marker().unmarkGrayStack.empty());
@@ -229,7 +229,7 @@ void ParallelMarkTask::waitUntilResumed(AutoLockHelperThreadState& lock) {
 
   do {
     MOZ_ASSERT(pm->hasActiveTasks(lock));
-    resumed.wait(lock);
+    lock.wait(resumed);
   } while (isWaiting);
 
   MOZ_ASSERT(!pm->isTaskInWaitingList(this, lock));
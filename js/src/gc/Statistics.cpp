@@ -487,7 +487,7 @@ UniqueChars Statistics::formatDetailedDescription() const {
   Zones Collected: %d of %d (-%d)\n\
   Compartments Collected: %d of %d (-%d)\n\
   MinorGCs since last GC: %d\n\
-  Store Buffer Overflows: %d\n\
+  Store Buffer Overflows: %d (slots: %d)\n\
   MMU 20ms:%.1f%%; 50ms:%.1f%%\n\
   SCC Sweep Total (MaxPause): %.3fms (%.3fms)\n\
   HeapSize: %.3f MiB\n\
@@ -504,8 +504,8 @@ UniqueChars Statistics::formatDetailedDescription() const {
       zoneStats.sweptZoneCount, zoneStats.collectedCompartmentCount,
       zoneStats.compartmentCount, zoneStats.sweptCompartmentCount,
       getCount(COUNT_MINOR_GC), getCount(COUNT_STOREBUFFER_OVERFLOW),
-      mmu20 * 100., mmu50 * 100., t(sccTotal), t(sccLongest),
-      double(preTotalGCHeapBytes) / BYTES_PER_MB,
+      getCount(COUNT_STOREBUFFER_SLOT_OVERFLOW), mmu20 * 100., mmu50 * 100.,
+      t(sccTotal), t(sccLongest), double(preTotalGCHeapBytes) / BYTES_PER_MB,
       getCount(COUNT_NEW_CHUNK) - getCount(COUNT_DESTROY_CHUNK),
       getCount(COUNT_NEW_CHUNK) + getCount(COUNT_DESTROY_CHUNK),
       double(ArenaSize * getCount(COUNT_ARENA_RELOCATED)) / BYTES_PER_MB);
@@ -704,6 +704,8 @@ void Statistics::formatJsonDescription(JSONPrinter& json) const {
   uint32_t storebufferOverflows = getCount(COUNT_STOREBUFFER_OVERFLOW);
   if (storebufferOverflows) {
     json.property("store_buffer_overflows", storebufferOverflows);
+    json.property("slot_buffer_overflows",
+                  getCount(COUNT_STOREBUFFER_SLOT_OVERFLOW));
   }
   json.property("slices", slices_.length());
 
@@ -45,6 +45,9 @@ enum Count {
   // compaction
   COUNT_STOREBUFFER_OVERFLOW,
 
+  // Number of those overflows caused by the slots and elements buffer.
+  COUNT_STOREBUFFER_SLOT_OVERFLOW,
+
   // Number of arenas relocated by compacting GC.
   COUNT_ARENA_RELOCATED,
 
@@ -173,6 +173,9 @@ void StoreBuffer::setAboutToOverflow(JS::GCReason reason) {
   if (!aboutToOverflow_) {
     aboutToOverflow_ = true;
     runtime_->gc.stats().count(gcstats::COUNT_STOREBUFFER_OVERFLOW);
+    if (reason == JS::GCReason::FULL_SLOT_BUFFER) {
+      runtime_->gc.stats().count(gcstats::COUNT_STOREBUFFER_SLOT_OVERFLOW);
+    }
   }
   nursery_.requestMinorGC(reason);
 }
@@ -578,7 +578,25 @@ class StoreBuffer {
   }
   void unputCell(JSObject** strp) { unput(bufObjCell, ObjectPtrEdge(strp)); }
 
+  /*
+   * Element writes are recorded at the granularity of fixed size cards rather
+   * than individual elements. Repeated writes anywhere within a card of a
+   * large array then share a single SlotsEdge, so the buffer holds at most one
+   * entry per dirty card and minor GC only rescans those cards, rather than
+   * overflowing and triggering a minor GC after MaxEntries distinct writes.
+   */
+  static const uint32_t ElementsCardShift = 7;
+  static const uint32_t ElementsPerCard = 1 << ElementsCardShift;
+
   void putSlot(NativeObject* obj, int kind, uint32_t start, uint32_t count) {
+    if (kind == SlotsEdge::ElementKind) {
+      // Element indexes are bounded by MAX_DENSE_ELEMENTS_COUNT, so rounding
+      // the end up to the next card boundary can't overflow.
+      uint32_t end = start + count;
+      start &= ~(ElementsPerCard - 1);
+      end = (end + ElementsPerCard - 1) & ~(ElementsPerCard - 1);
+      count = end - start;
+    }
     SlotsEdge edge(obj, kind, start, count);
     if (bufferSlot.last_.touches(edge)) {
       bufferSlot.last_.merge(edge);
@@ -0,0 +1,50 @@
+// Adding and deleting properties gives objects new Shapes, so JSON.stringify
+// must not reuse keys cached for the old ones. Compare against the slow path
+// after each change.
+
+function check(value) {
+  var expected = JSONStringify(value, "SlowOnly");
+  assertEq(JSONStringify(value, "FastOnly"), expected);
+  assertEq(JSON.stringify(value), expected);
+}
+
+var objs = [];
+for (var i = 0; i < 10; i++) {
+  objs.push({first: i, second: "s" + i, third: [i]});
+}
+check(objs);
+
+// Delete the last property, which goes back to an existing Shape.
+delete objs[0].third;
+delete objs[5].third;
+check(objs);
+
+// Add it back, and a new one.
+objs[0].third = "back";
+objs[5].fourth = 4;
+check(objs);
+
+// Delete a property from the middle.
+delete objs[1].second;
+check(objs);
+
+// Properties which the fast path can't handle send the whole call down the
+// slow path, whether or not the object's Shape was cached earlier in it.
+var withGetter = {first: 0, second: "s", third: [0]};
+Object.defineProperty(withGetter, "second", {get() { return "got"; }});
+var mixed = [objs[2], withGetter, objs[3]];
+assertEq(JSON.stringify(mixed), JSONStringify(mixed, "SlowOnly"));
+
+var hidden = {first: 0, second: "s", third: [0]};
+Object.defineProperty(hidden, "third", {enumerable: false});
+mixed = [objs[2], hidden, objs[3]];
+check(mixed);
+
+// Symbol-keyed properties are skipped, and dense elements are serialized
+// before the named properties.
+var sym = {first: 1, second: "s", third: [1]};
+sym[Symbol("s")] = "symbol";
+var indexed = {first: 2, second: "s", third: [2]};
+indexed[0] = "zero";
+indexed[1] = "one";
+check([objs[4], sym, indexed, objs[6]]);
@@ -0,0 +1,44 @@
+// Objects in dictionary mode aren't added to JSON.stringify's Shape key
+// cache. Check that they serialize like the slow path, including when they
+// have the same keys as objects whose Shapes are cached.
+
+function check(value) {
+  var expected = JSONStringify(value, "SlowOnly");
+  assertEq(JSONStringify(value, "FastOnly"), expected);
+  assertEq(JSON.stringify(value), expected);
+}
+
+function makeDictionary(i) {
+  // Deleting a property which wasn't the last one added puts the object in
+  // dictionary mode.
+  var o = {removed: 0, a: i, b: "b" + i, c: [i]};
+  delete o.removed;
+  return o;
+}
+
+var values = [];
+for (var i = 0; i < 30; i++) {
+  values.push(i % 2 ? makeDictionary(i) : {a: i, b: "b" + i, c: [i]});
+}
+check(values);
+
+// Dictionary objects keep changing between calls.
+var dict = makeDictionary(0);
+var arr = [dict, {a: 1, b: "b1", c: [1]}, dict];
+check(arr);
+dict.d = "added";
+check(arr);
+delete dict.b;
+check(arr);
+dict.b = "re-added";
+check(arr);
+
+// Dictionary objects with removed properties in between.
+var big = {};
+for (var i = 0; i < 40; i++) {
+  big["p" + i] = i;
+}
+for (var i = 0; i < 40; i += 7) {
+  delete big["p" + i];
+}
+check([big, big, {p1: 1}]);
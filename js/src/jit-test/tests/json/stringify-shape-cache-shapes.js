@@ -0,0 +1,72 @@
+// JSON.stringify's fast path caches the quoted keys of each Shape it sees
+// during a call. Check it against the slow path as Shapes change, both
+// within a single call and between calls.
+
+function check(value) {
+  var expected = JSONStringify(value, "SlowOnly");
+  assertEq(JSONStringify(value, "FastOnly"), expected);
+  assertEq(JSON.stringify(value), expected);
+}
+
+// Many objects sharing a few Shapes, interleaved.
+var records = [];
+for (var i = 0; i < 100; i++) {
+  if (i % 3 == 0) {
+    records.push({id: i, name: "n" + i, tags: [i, i + 1]});
+  } else if (i % 3 == 1) {
+    records.push({id: i, name: "n" + i});
+  } else {
+    records.push({name: "n" + i, id: i, nested: {id: i, name: "m" + i}});
+  }
+}
+check(records);
+
+// Same keys in a different order are different Shapes.
+check([{a: 1, b: 2}, {b: 3, a: 4}, {a: 5, b: 6}, {b: 7, a: 8}]);
+
+// More Shapes than the cache holds, followed by objects with early Shapes.
+var many = [];
+for (var i = 0; i < 40; i++) {
+  var o = {};
+  o["k" + i] = i;
+  o.common = "c" + i;
+  many.push(o);
+}
+for (var i = 0; i < 40; i++) {
+  var o = {};
+  o["k" + i] = -i;
+  o.common = "d" + i;
+  many.push(o);
+}
+check(many);
+
+// Keys which need escaping, and a two-byte key after Latin-1 ones have been
+// cached.
+check([
+  {"quo\"te": 1, "new\nline": 2, "tab\t": 3},
+  {"quo\"te": 4, "new\nline": 5, "tab\t": 6},
+  {"☃": 7, plain: 8},
+  {"quo\"te": 9, "new\nline": 10, "tab\t": 11},
+  {"☃": 12, plain: 13},
+]);
+
+// The same objects change Shape between calls.
+var objs = [];
+for (var i = 0; i < 20; i++) {
+  objs.push({x: i, y: -i});
+}
+check(objs);
+for (var i = 0; i < objs.length; i += 2) {
+  objs[i].z = "added" + i;
+}
+check(objs);
+for (var i = 0; i < objs.length; i += 3) {
+  objs[i].x = {replaced: i};
+}
+check(objs);
+
+// Values stored in the slots change without changing the Shape.
+for (var i = 0; i < objs.length; i++) {
+  objs[i].y = [i, "s" + i, null, true];
+}
+check(objs);
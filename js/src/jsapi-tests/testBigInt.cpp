@@ -766,3 +766,46 @@ inline bool RadixOutOfRange(uint8_t radix) {
   return true;
 }
 END_TEST(testBigIntToString_RadixOutOfRange)
+
+BEGIN_TEST(testBigIntMul_Large) {
+  JS::Rooted<JS::Value> v(cx);
+
+  // (2^n - 1)^2 == 2^2n - 2^(n+1) + 1, for operand sizes on both sides of
+  // the Karatsuba threshold.
+  EVAL(
+      "[64, 2047, 2560, 4096, 8191, 30000, 65536].every(n => {"
+      "  let x = (1n << BigInt(n)) - 1n;"
+      "  return x * x === (1n << BigInt(2 * n)) - (1n << BigInt(n + 1)) + 1n;"
+      "})",
+      &v);
+  CHECK(v.isTrue());
+
+  // Balanced and unbalanced pseudo-random operands, checked against division.
+  EVAL(
+      "(() => {"
+      "  let seed = 1;"
+      "  let random = bits => {"
+      "    let s = '0x';"
+      "    for (let i = 0; i < bits / 4; i++) {"
+      "      seed = (seed * 1103515245 + 12345) % 2147483648;"
+      "      s += (seed >> 16 & 15).toString(16);"
+      "    }"
+      "    return BigInt(s) | 1n;"
+      "  };"
+      "  for (let [xbits, ybits] of [[3000, 3000], [12800, 5000],"
+      "                              [40000, 2600], [9000, 9000]]) {"
+      "    let x = random(xbits), y = random(ybits);"
+      "    let p = x * y;"
+      "    if (p !== y * x || p / y !== x || p % y !== 0n || p / x !== y ||"
+      "        -x * y !== -p) {"
+      "      return false;"
+      "    }"
+      "  }"
+      "  return true;"
+      "})()",
+      &v);
+  CHECK(v.isTrue());
+
+  return true;
+}
+END_TEST(testBigIntMul_Large)
@@ -0,0 +1,67 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+ * vim: set ts=8 sts=2 et sw=2 tw=80:
+ */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * Benchmarks for multiplying BigInts, around and above the length where
+ * BigInt::mul switches to Karatsuba multiplication. Change
+ * BigInt::KaratsubaThreshold and compare the results to retune it.
+ */
+
+#include "mozilla/Span.h"  // mozilla::Span
+
+#include "js/BigInt.h"  // JS::SimpleStringToBigInt
+#include "js/Utility.h"  // js::UniqueChars, js_pod_malloc
+#include "jsapi-tests/tests.h"
+#include "vm/BigIntType.h"  // JS::BigInt::{mul, DigitBits}
+
+static constexpr uint32_t BigIntMultiplies = 1000;
+
+BEGIN_FIXTURE_TEST(JSAPIBenchmark, testBigIntPerf_Mul) {
+  // Balanced operands, from below the threshold up to where Karatsuba's
+  // recursion dominates.
+  for (size_t digits : {16, 24, 32, 48, 64, 128, 256, 1024}) {
+    char label[32];
+    SprintfLiteral(label, "%zu x %zu digits", digits, digits);
+    CHECK(benchMul(label, digits, digits));
+  }
+
+  // Unbalanced operands are multiplied in chunks of the shorter length.
+  CHECK(benchMul("4096 x 64 digits", 4096, 64));
+
+  return true;
+}
+
+bool benchMul(const char* label, size_t xDigits, size_t yDigits) {
+  JS::Rooted<JS::BigInt*> x(cx, makeBigInt(xDigits, 1));
+  CHECK(x);
+  JS::Rooted<JS::BigInt*> y(cx, makeBigInt(yDigits, 2));
+  CHECK(y);
+
+  CHECK(bench(label, BigIntMultiplies, [&] {
+    CHECK(JS::BigInt::mul(cx, x, y));
+    return true;
+  }));
+  return true;
+}
+
+// Make a positive BigInt of exactly |digits| digits, with pseudo-random
+// contents depending on |seed|.
+JS::BigInt* makeBigInt(size_t digits, uint32_t seed) {
+  size_t length = digits * JS::BigInt::DigitBits / 4;
+  js::UniqueChars chars(js_pod_malloc<char>(length));
+  if (!chars) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < length; i++) {
+    seed = seed * 1103515245 + 12345;
+    chars[i] = "0123456789abcdef"[seed >> 16 & 15];
+  }
+  chars[0] = 'f';
+  return JS::SimpleStringToBigInt(
+      cx, mozilla::Span<const char>(chars.get(), length), 16);
+}
+END_FIXTURE_TEST(JSAPIBenchmark, testBigIntPerf_Mul)
@@ -0,0 +1,91 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+ * vim: set ts=8 sts=2 et sw=2 tw=80:
+ */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "gc/GCRuntime.h"
+#include "gc/StoreBuffer.h"
+#include "js/GCAPI.h"
+#include "jsapi-tests/tests.h"
+#include "vm/NativeObject.h"
+#include "vm/Runtime.h"
+
+#include "vm/JSContext-inl.h"
+
+using namespace JS;
+using namespace js;
+
+BEGIN_TEST(testGCStoreBufferElementCards) {
+  const uint32_t ArrayCount = 4;
+  const uint32_t CardsPerArray = 256;
+  const uint32_t Length = CardsPerArray * gc::StoreBuffer::ElementsPerCard;
+  const uint32_t Rounds = 16;
+
+  JS::RootedValue v(cx);
+  EVAL(
+      "var arrays = [];\n"
+      "for (var i = 0; i < 4; i++) {\n"
+      "  arrays.push(new Array(32768).fill(0));\n"
+      "}\n"
+      "arrays",
+      &v);
+  JS_GC(cx);
+
+  Rooted<NativeObject*> arrays(cx, &v.toObject().as<NativeObject>());
+  CHECK(arrays->getDenseInitializedLength() == ArrayCount);
+  auto arrayAt = [&](uint32_t i) {
+    return &arrays->getDenseElement(i).toObject().as<NativeObject>();
+  };
+  for (uint32_t i = 0; i < ArrayCount; i++) {
+    NativeObject* arr = arrayAt(i);
+    CHECK(!js::gc::IsInsideNursery(arr));
+    CHECK(arr->getDenseInitializedLength() == Length);
+  }
+
+  JS::RootedObject obj(cx, JS_NewPlainObject(cx));
+  CHECK(obj);
+  CHECK(js::gc::IsInsideNursery(obj));
+
+  // Point different elements of every card of several tenured arrays at a
+  // nursery object, round after round. Consecutive writes go to different
+  // arrays so that they can't be merged into the buffer's last entry, and all
+  // go to the hash set. That is more writes than the slots buffer can hold
+  // entries for, but repeated writes to a card share an entry so the buffer
+  // shouldn't request a minor GC. (The slots buffer holds 8192 entries; this
+  // makes 16384 writes to 1024 cards.)
+  gc::GCRuntime& gc = cx->runtime()->gc;
+  uint64_t minorGCs = gc.minorGCCount();
+  for (uint32_t round = 0; round < Rounds; round++) {
+    uint32_t offset = (round * 7) % gc::StoreBuffer::ElementsPerCard;
+    for (uint32_t card = 0; card < CardsPerArray; card++) {
+      for (uint32_t i = 0; i < ArrayCount; i++) {
+        arrayAt(i)->setDenseElement(
+            card * gc::StoreBuffer::ElementsPerCard + offset,
+            ObjectValue(*obj));
+      }
+    }
+  }
+  CHECK(!gc.storeBuffer().isAboutToOverflow());
+  CHECK(gc.minorGCCount() == minorGCs);
+
+  // Every buffered element must still have been traced by the minor GC.
+  cx->minorGC(JS::GCReason::API);
+  CHECK(!js::gc::IsInsideNursery(obj));
+  for (uint32_t i = 0; i < ArrayCount; i++) {
+    NativeObject* arr = arrayAt(i);
+    for (uint32_t j = 0; j < Length; j++) {
+      uint32_t offset = j % gc::StoreBuffer::ElementsPerCard;
+      const Value& elem = arr->getDenseElement(j);
+      if (offset % 7 == 0 && offset / 7 < Rounds) {
+        CHECK(elem.isObject() && &elem.toObject() == obj);
+      } else {
+        CHECK(elem == Int32Value(0));
+      }
+    }
+  }
+
+  return true;
+}
+END_TEST(testGCStoreBufferElementCards)
@@ -0,0 +1,147 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+ * vim: set ts=8 sts=2 et sw=2 tw=80:
+ */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "gc/GCParallelTask.h"
+#include "js/HelperThreadAPI.h"
+#include "jsapi-tests/tests.h"
+#include "vm/HelperThreads.h"
+#include "vm/HelperThreadState.h"
+#include "vm/Runtime.h"
+
+BEGIN_TEST(testHelperThreadLockStats) {
+  // Nothing is recorded until the statistics are enabled.
+  JS::HelperThreadLockStats disabled;
+  JS::GetHelperThreadLockStats(&disabled, /* reset = */ true);
+  { js::AutoLockHelperThreadState lock; }
+  JS::GetHelperThreadLockStats(&disabled);
+  CHECK(disabled.acquisitions == 0);
+
+  JS::SetHelperThreadLockStatsEnabled(true);
+
+  JS::HelperThreadLockStats before;
+  JS::GetHelperThreadLockStats(&before);
+
+  { js::AutoLockHelperThreadState lock; }
+
+  // Both the lock above and the previous query count as acquisitions.
+  JS::HelperThreadLockStats after;
+  JS::GetHelperThreadLockStats(&after, /* reset = */ true);
+  CHECK(after.acquisitions >= before.acquisitions + 2);
+  CHECK(after.totalHoldMicroseconds >= before.totalHoldMicroseconds);
+  CHECK(after.totalHoldMicroseconds >= after.maxHoldMicroseconds);
+
+  JS::HelperThreadLockStats reset;
+  JS::GetHelperThreadLockStats(&reset);
+  CHECK(reset.acquisitions < after.acquisitions);
+
+  JS::SetHelperThreadLockStatsEnabled(false);
+
+  return true;
+}
+END_TEST(testHelperThreadLockStats)
+
+BEGIN_TEST(testHelperThreadLockStatsWait) {
+  js::WaitForAllHelperThreads();
+
+  JS::SetHelperThreadLockStatsEnabled(true);
+  JS::HelperThreadLockStats stats;
+  JS::GetHelperThreadLockStats(&stats, /* reset = */ true);
+
+  // Waiting releases the lock, so the time spent waiting is not hold time.
+  const mozilla::TimeDuration waitTime =
+      mozilla::TimeDuration::FromMilliseconds(200);
+  mozilla::TimeStamp start = mozilla::TimeStamp::Now();
+  {
+    js::AutoLockHelperThreadState lock;
+    mozilla::TimeStamp deadline = start + waitTime;
+    for (mozilla::TimeStamp now = start; now < deadline;
+         now = mozilla::TimeStamp::Now()) {
+      js::HelperThreadState().wait(lock, deadline - now);
+    }
+  }
+  uint64_t waited =
+      uint64_t((mozilla::TimeStamp::Now() - start).ToMicroseconds());
+
+  JS::GetHelperThreadLockStats(&stats, /* reset = */ true);
+  CHECK(stats.acquisitions >= 2);
+  CHECK(stats.totalHoldMicroseconds < waited);
+  CHECK(stats.maxHoldMicroseconds <= stats.totalHoldMicroseconds);
+
+  JS::SetHelperThreadLockStatsEnabled(false);
+
+  return true;
+}
+END_TEST(testHelperThreadLockStatsWait)
+
+namespace {
+
+class NullGCTask : public js::GCParallelTask {
+ public:
+  explicit NullGCTask(js::gc::GCRuntime* gc)
+      : GCParallelTask(gc, js::gcstats::PhaseKind::NONE) {}
+  ~NullGCTask() { join(); }
+  void run(js::AutoLockHelperThreadState& lock) override {}
+};
+
+}  // namespace
+
+BEGIN_TEST(testHelperThreadUrgentTaskPickedFirst) {
+  if (!js::CanUseExtraThreads()) {
+    return true;
+  }
+
+  js::WaitForAllHelperThreads();
+
+  NullGCTask gcTask(&cx->runtime()->gc);
+
+  {
+    js::AutoLockHelperThreadState lock;
+    js::GlobalHelperThreadState& state = js::HelperThreadState();
+
+    // Queue a task of a low priority type without dispatching it, and mark
+    // its type urgent.
+    state.setTaskTypeUrgent(js::THREAD_TYPE_DELAZIFY_FREE, true, lock);
+    auto freeTask = js::MakeUnique<js::FreeDelazifyTask>(nullptr);
+    CHECK(freeTask);
+    CHECK(state.freeDelazifyTaskVector(lock).append(std::move(freeTask)));
+
+    // Starting a GC task, which normally has the highest priority, dispatches
+    // a single task: the highest priority one that is ready. That must be the
+    // urgent one, leaving the GC task waiting for a thread.
+    gcTask.startWithLockHeld(lock);
+    CHECK(state.freeDelazifyTaskVector(lock).empty());
+    CHECK(gcTask.isDispatched(lock));
+
+    state.setTaskTypeUrgent(js::THREAD_TYPE_DELAZIFY_FREE, false, lock);
+  }
+
+  // The GC task is dispatched once the urgent task has finished.
+  gcTask.join();
+  js::WaitForAllHelperThreads();
+
+  return true;
+}
+END_TEST(testHelperThreadUrgentTaskPickedFirst)
+
+BEGIN_TEST(testHelperThreadUrgentTaskType) {
+  // Hints nest, and tasks still run while they are set.
+  JS::SetHelperThreadTaskTypeUrgent(js::THREAD_TYPE_DELAZIFY, true);
+  JS::SetHelperThreadTaskTypeUrgent(js::THREAD_TYPE_DELAZIFY, true);
+  JS::SetHelperThreadTaskTypeUrgent(js::THREAD_TYPE_ION, true);
+
+  JS::RootedValue v(cx);
+  EVAL("function f(x) { return x + 1; } f(1)", &v);
+  CHECK(v.isInt32(2));
+  js::WaitForAllHelperThreads();
+
+  JS::SetHelperThreadTaskTypeUrgent(js::THREAD_TYPE_ION, false);
+  JS::SetHelperThreadTaskTypeUrgent(js::THREAD_TYPE_DELAZIFY, false);
+  JS::SetHelperThreadTaskTypeUrgent(js::THREAD_TYPE_DELAZIFY, false);
+
+  return true;
+}
+END_TEST(testHelperThreadUrgentTaskType)
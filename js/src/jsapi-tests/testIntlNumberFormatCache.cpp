@@ -0,0 +1,113 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+ * vim: set ts=8 sts=2 et sw=2 tw=80:
+ */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "builtin/intl/NumberFormat.h"
+#include "builtin/intl/SharedIntlData.h"
+#include "js/GCAPI.h"
+#include "jsapi-tests/tests.h"
+#include "vm/Runtime.h"
+
+using namespace js;
+
+#ifdef JS_HAS_INTL_API
+// Report nothing for malloc'd memory, leaving only the estimated ICU memory.
+static size_t ICUOnlyMallocSizeOf(const void* ptr) { return 0; }
+#endif
+
+BEGIN_TEST(testIntlNumberFormatCache) {
+  // This test should only attempt to run if we have Intl support.
+  JS::Rooted<JS::Value> haveIntl(cx);
+  EVAL("typeof Intl !== 'undefined'", &haveIntl);
+  if (!haveIntl.toBoolean()) {
+    return true;
+  }
+
+  // Use more distinct locale and option combinations than the number
+  // formatter cache holds, so that formatters still in use get evicted.
+  EXEC(
+      "var formats = []; \n"
+      "for (var digits = 0; digits < 20; digits++) { \n"
+      "  formats.push(new Intl.NumberFormat('en-US', \n"
+      "      {minimumFractionDigits: digits})); \n"
+      "  formats.push(new Intl.NumberFormat('de-DE', \n"
+      "      {minimumFractionDigits: digits})); \n"
+      "} \n"
+      "function check() { \n"
+      "  for (var i = 0; i < formats.length; i++) { \n"
+      "    var digits = i >> 1; \n"
+      "    var expected = (1234.5).toFixed(Math.max(digits, 1)); \n"
+      "    var [int, frac] = expected.split('.'); \n"
+      "    expected = (i & 1) ? '1.234,' + frac : '1,234.' + frac; \n"
+      "    var actual = formats[i].format(1234.5); \n"
+      "    if (actual !== expected) \n"
+      "      throw `${i}: expected ${expected}, got ${actual}`; \n"
+      "  } \n"
+      "} \n"
+      "check();");
+
+#ifdef JS_HAS_INTL_API
+  intl::SharedIntlData& sharedIntlData = cx->runtime()->sharedIntlData.ref();
+  intl::SharedNumberFormat* shared = nullptr;
+
+  // Formatters are shared between objects with the same locale and options,
+  // and only charged once to SharedIntlData.
+  EXEC(
+      "var a = new Intl.NumberFormat('en-US', {style: 'percent'}); \n"
+      "if (a.format(0.5) !== '50%') \n"
+      "  throw 'unexpected formatter result';");
+  CHECK(getNumberFormatter("a", &shared));
+  size_t sizeWithA = sharedIntlData.sizeOfExcludingThis(ICUOnlyMallocSizeOf);
+
+  EXEC(
+      "var b = new Intl.NumberFormat('en-US', {style: 'percent'}); \n"
+      "if (b.format(0.25) !== '25%') \n"
+      "  throw 'unexpected shared formatter result';");
+  intl::SharedNumberFormat* sharedB = nullptr;
+  CHECK(getNumberFormatter("b", &sharedB));
+  CHECK(sharedB == shared);
+  CHECK(sharedIntlData.sizeOfExcludingThis(ICUOnlyMallocSizeOf) == sizeWithA);
+
+  EXEC(
+      "var c = new Intl.NumberFormat('en-US', {style: 'currency', \n"
+      "                                        currency: 'EUR'}); \n"
+      "if (c.format(1) !== '\\u20ac1.00') \n"
+      "  throw 'unexpected formatter result';");
+  intl::SharedNumberFormat* sharedC = nullptr;
+  CHECK(getNumberFormatter("c", &sharedC));
+  CHECK(sharedC != shared);
+
+  // Drop some of the objects and check the remaining ones still work after
+  // their formatters were released.
+  EXEC("formats.length = 10; a = null; b = null; c = null;");
+  JS_GC(cx);
+  EXEC("check();");
+
+  // The percent formatter has no users left but is still cached, so a new
+  // object with the same options gets it back.
+  EXEC(
+      "var d = new Intl.NumberFormat('en-US', {style: 'percent'}); \n"
+      "if (d.format(1) !== '100%') \n"
+      "  throw 'unexpected formatter result after GC';");
+  intl::SharedNumberFormat* sharedD = nullptr;
+  CHECK(getNumberFormatter("d", &sharedD));
+  CHECK(sharedD == shared);
+#endif
+
+  return true;
+}
+
+#ifdef JS_HAS_INTL_API
+bool getNumberFormatter(const char* name, intl::SharedNumberFormat** result) {
+  JS::Rooted<JS::Value> v(cx);
+  CHECK(JS_GetProperty(cx, global, name, &v));
+  CHECK(v.isObject() && v.toObject().is<NumberFormatObject>());
+  *result = v.toObject().as<NumberFormatObject>().getNumberFormatter();
+  CHECK(*result);
+  return true;
+}
+#endif
+END_TEST(testIntlNumberFormatCache)
@@ -0,0 +1,80 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "ds/LifoAlloc.h"
+
+#include "jsapi-tests/tests.h"
+
+using namespace js;
+
+static size_t CountChunk(const void*) { return 1; }
+
+static size_t PooledChunkCount() {
+  return LifoChunkPool::sizeOfExcludingThis(CountChunk);
+}
+
+BEGIN_TEST(testLifoChunkPool) {
+  LifoChunkPool::purge();
+  CHECK(PooledChunkCount() == 0);
+
+  // Chunks of an ordinary LifoAlloc are not pooled.
+  {
+    LifoAlloc lifo(LifoChunkPool::MinChunkSize, js::MallocArena);
+    CHECK(lifo.alloc(64));
+  }
+  CHECK(PooledChunkCount() == 0);
+
+  // Chunks of a pooled LifoAlloc are kept when it is destroyed, and handed
+  // to the next pooled LifoAlloc which needs a chunk of the same size.
+  void* first;
+  {
+    LifoAlloc lifo(LifoChunkPool::MinChunkSize, js::MallocArena);
+    lifo.usePooledChunks();
+    first = lifo.alloc(64);
+    CHECK(first);
+  }
+  CHECK(PooledChunkCount() == 1);
+
+  // Chunks are only reused by LifoAllocs using the same arena.
+  {
+    LifoAlloc lifo(LifoChunkPool::MinChunkSize, js::BackgroundMallocArena);
+    lifo.usePooledChunks();
+    void* second = lifo.alloc(64);
+    CHECK(second);
+    CHECK(second != first);
+    CHECK(PooledChunkCount() == 1);
+  }
+  CHECK(PooledChunkCount() == 2);
+
+  {
+    LifoAlloc lifo(LifoChunkPool::MinChunkSize, js::MallocArena);
+    lifo.usePooledChunks();
+    void* second = lifo.alloc(64);
+    CHECK(second == first);
+    CHECK(PooledChunkCount() == 1);
+  }
+  LifoChunkPool::purge();
+  CHECK(PooledChunkCount() == 0);
+
+  // Oversize chunks are never pooled.
+  {
+    LifoAlloc lifo(LifoChunkPool::MinChunkSize, js::MallocArena);
+    lifo.usePooledChunks();
+    CHECK(lifo.alloc(LifoChunkPool::MinChunkSize * 2));
+  }
+  CHECK(PooledChunkCount() == 0);
+
+  {
+    LifoAlloc lifo(LifoChunkPool::MinChunkSize, js::MallocArena);
+    lifo.usePooledChunks();
+    CHECK(lifo.alloc(64));
+  }
+  CHECK(PooledChunkCount() == 1);
+
+  LifoChunkPool::purge();
+  CHECK(PooledChunkCount() == 0);
+
+  return true;
+}
+END_TEST(testLifoChunkPool)
@@ -0,0 +1,87 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+ * vim: set ts=8 sts=2 et sw=2 tw=80:
+ */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * Benchmarks for compiling JavaScript source, mostly to measure the tokenizer.
+ */
+
+#include "mozilla/RefPtr.h"     // RefPtr
+#include "mozilla/ScopeExit.h"  // MakeScopeExit
+#include "mozilla/Utf8.h"       // mozilla::Utf8Unit
+
+#include "js/CompileOptions.h"              // JS::CompileOptions
+#include "js/experimental/CompileScript.h"  // JS::NewFrontendContext
+#include "js/SourceText.h"                  // JS::Source{Ownership,Text}
+#include "jsapi-tests/tests.h"
+
+static constexpr uint32_t ParseFunctions = 20000;
+static constexpr uint32_t ParseIterations = 5;
+
+BEGIN_FIXTURE_TEST(JSAPIBenchmark, testParsePerf_Identifiers) {
+  JS::FrontendContext* fc = JS::NewFrontendContext();
+  CHECK(fc);
+  auto destroyFc =
+      mozilla::MakeScopeExit([fc] { JS::DestroyFrontendContext(fc); });
+
+  // Minified code, with one or two letter names, against code with long,
+  // descriptive names.
+  for (const char* prefix : {"", "descriptiveName_"}) {
+    js::Vector<char, 0, js::SystemAllocPolicy> utf8;
+    CHECK(makeScript(prefix, utf8));
+    js::Vector<char16_t, 0, js::SystemAllocPolicy> utf16;
+    CHECK(utf16.resize(utf8.length()));
+    for (size_t i = 0; i < utf8.length(); i++) {
+      utf16[i] = char16_t(utf8[i]);
+    }
+
+    char label[64];
+    SprintfLiteral(label, "%s identifiers, UTF-8", *prefix ? "long" : "short");
+    CHECK(bench(label, ParseIterations, [&] {
+      return compile<mozilla::Utf8Unit>(fc, utf8.begin(), utf8.length());
+    }));
+
+    SprintfLiteral(label, "%s identifiers, UTF-16", *prefix ? "long" : "short");
+    CHECK(bench(label, ParseIterations, [&] {
+      return compile<char16_t>(fc, utf16.begin(), utf16.length());
+    }));
+  }
+
+  return true;
+}
+
+// Generate a script of ParseFunctions small functions whose identifiers all
+// start with |prefix|.
+bool makeScript(const char* prefix,
+                js::Vector<char, 0, js::SystemAllocPolicy>& script) {
+  for (uint32_t i = 0; i < ParseFunctions; i++) {
+    char function[512];
+    int length = SprintfLiteral(
+        function,
+        "function %sf%u(%sa,%sb){var %sc=%sa+%sb;"
+        "// %sa and %sb are summed\n"
+        "return %sc*%u}\n",
+        prefix, i, prefix, prefix, prefix, prefix, prefix, prefix, prefix,
+        prefix, i);
+    CHECK(length > 0 && size_t(length) < sizeof(function));
+    CHECK(script.append(function, length));
+  }
+  return true;
+}
+
+template <typename Unit, typename CharT>
+bool compile(JS::FrontendContext* fc, const CharT* chars, size_t length) {
+  JS::CompileOptions options(cx);
+  options.setFileAndLine("parse-perf.js", 1);
+
+  JS::SourceText<Unit> srcBuf;
+  CHECK(srcBuf.init(cx, chars, length, JS::SourceOwnership::Borrowed));
+  RefPtr<JS::Stencil> stencil =
+      JS::CompileGlobalScriptToStencil(fc, options, srcBuf);
+  CHECK(stencil);
+  return true;
+}
+END_FIXTURE_TEST(JSAPIBenchmark, testParsePerf_Identifiers)
@@ -0,0 +1,61 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+ * vim: set ts=8 sts=2 et sw=2 tw=80:
+ */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+ * Benchmarks for comparing a Latin-1 string against an equal two-byte string,
+ * around the length where EqualChars stops comparing inline.
+ */
+
+#include "js/Equality.h"  // JS::StrictlyEqual
+#include "js/String.h"
+#include "js/Utility.h"  // js_pod_malloc
+#include "jsapi-tests/tests.h"
+
+static constexpr uint32_t StringCompares = 1000000;
+
+BEGIN_FIXTURE_TEST(JSAPIBenchmark, testStringEqualityPerf_Mixed) {
+  for (size_t length : {8, 15, 64, 1024}) {
+    JS::Rooted<JS::Value> latin1(cx);
+    JS::Rooted<JS::Value> twoByte(cx);
+    CHECK(makeStrings(length, &latin1, &twoByte));
+
+    char label[32];
+    SprintfLiteral(label, "length %zu", length);
+    CHECK(bench(label, StringCompares, [&] {
+      bool equal = false;
+      CHECK(JS::StrictlyEqual(cx, latin1, twoByte, &equal));
+      CHECK(equal);
+      return true;
+    }));
+  }
+
+  return true;
+}
+
+// Make a Latin-1 string and a two-byte string with the same |length|
+// characters. Neither is an atom, so comparing them compares the characters.
+bool makeStrings(size_t length, JS::MutableHandle<JS::Value> latin1,
+                 JS::MutableHandle<JS::Value> twoByte) {
+  char chars[1024];
+  CHECK(length <= sizeof(chars));
+  JS::UniqueTwoByteChars twoByteChars(js_pod_malloc<char16_t>(length + 1));
+  CHECK(twoByteChars);
+  for (size_t i = 0; i < length; i++) {
+    chars[i] = char('a' + i % 26);
+    twoByteChars[i] = char16_t(chars[i]);
+  }
+  twoByteChars[length] = 0;
+
+  JSString* str = JS_NewStringCopyN(cx, chars, length);
+  CHECK(str);
+  latin1.setString(str);
+  str = JS_NewUCStringDontDeflate(cx, std::move(twoByteChars), length);
+  CHECK(str);
+  twoByte.setString(str);
+  return true;
+}
+END_FIXTURE_TEST(JSAPIBenchmark, testStringEqualityPerf_Mixed)
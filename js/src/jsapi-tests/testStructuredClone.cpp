@@ -67,6 +67,47 @@ BEGIN_TEST(testStructuredClone_object) {
 }
 END_TEST(testStructuredClone_object)
 
+BEGIN_TEST(testStructuredClone_shapeTemplates) {
+  JS::RootedValue v1(cx);
+  EVAL(
+      "var records = [];\n"
+      "for (var i = 0; i < 100; i++) {\n"
+      "  records.push({id: i, name: 'item' + i, pos: {x: i, y: -i}});\n"
+      "}\n"
+      "records.push({name: 'reordered', id: 100});\n"
+      "records.push({id: 101, name: 'extra', pos: null, tag: 'x'});\n"
+      "records.push(records[0]);\n"
+      "records;\n",
+      &v1);
+
+  JS::CloneDataPolicy policy;
+  JSAutoStructuredCloneBuffer plain(JS::StructuredCloneScope::DifferentProcess,
+                                    nullptr, nullptr);
+  CHECK(plain.write(cx, v1, JS::UndefinedHandleValue, policy));
+
+  policy.allowShapeTemplates();
+  JSAutoStructuredCloneBuffer templated(
+      JS::StructuredCloneScope::DifferentProcess, nullptr, nullptr);
+  CHECK(templated.write(cx, v1, JS::UndefinedHandleValue, policy));
+  CHECK(templated.data().Size() < plain.data().Size());
+
+  JS::RootedValue v2(cx);
+  CHECK(templated.read(cx, &v2));
+  CHECK(v2.isObject());
+  CHECK(JS_SetProperty(cx, global, "copy", v2));
+
+  JS::RootedValue result(cx);
+  EVAL("JSON.stringify(copy) === JSON.stringify(records)", &result);
+  CHECK(result.isTrue());
+  EVAL("Object.keys(copy[100]).join() === 'name,id'", &result);
+  CHECK(result.isTrue());
+  EVAL("copy[102] === copy[0]", &result);
+  CHECK(result.isTrue());
+
+  return true;
+}
+END_TEST(testStructuredClone_shapeTemplates)
+
 BEGIN_TEST(testStructuredClone_string) {
   JS::RootedObject g1(cx, createGlobal());
   JS::RootedObject g2(cx, createGlobal());
@@ -8,6 +8,7 @@
 #define jsapi_tests_tests_h
 
 #include "mozilla/Sprintf.h"
+#include "mozilla/TimeStamp.h"
 
 #include <errno.h>
 #include <iterator>
@@ -468,6 +469,30 @@ class JSAPIFrontendTest : public JSAPITest {
   ;                                         \
   MOZ_RUNINIT static cls_##testname cls_##testname##_instance;
 
+/*
+ * A fixture for micro-benchmarks of engine fast paths. bench() calls |func|
+ * |iterations| times and prints the average time per call to stderr, so that
+ * the numbers can be compared before and after a change. The iteration counts
+ * should keep each test well under a second, since the benchmarks run with
+ * the rest of the tests.
+ */
+class JSAPIBenchmark : public JSAPIRuntimeTest {
+ protected:
+  template <typename F>
+  bool bench(const char* label, uint32_t iterations, F&& func) {
+    mozilla::TimeStamp start = mozilla::TimeStamp::Now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      if (!func()) {
+        return false;
+      }
+    }
+    mozilla::TimeDuration elapsed = mozilla::TimeStamp::Now() - start;
+    fprintf(stderr, "%s: %s: %.1f ns\n", name(), label,
+            elapsed.ToMicroseconds() * 1000.0 / iterations);
+    return true;
+  }
+};
+
 /*
  * A class for creating and managing one temporary file.
  *
@@ -8325,6 +8325,7 @@ static void BufferStreamMain(BufferStreamJob* job) {
     bytes = cache.bytes().begin();
     byteLength = cache.bytes().length();
     listener = &cache;
+    job->consumer->noteOptimizedEncodingWanted();
   } else {
     bytes = job->source.as<Uint8Vector>().begin();
     byteLength = job->source.as<Uint8Vector>().length();
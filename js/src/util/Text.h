@@ -13,6 +13,7 @@
 #include "mozilla/Casting.h"
 #include "mozilla/Latin1.h"
 #include "mozilla/Likely.h"
+#include "mozilla/SIMD.h"
 #include "mozilla/TextUtils.h"
 #include "mozilla/Utf8.h"
 
@@ -85,6 +86,19 @@ inline bool EqualChars(const Char1* s1, const Char2* s2, size_t len) {
   } else if constexpr (std::is_same_v<Char1, JS::Latin1Char> &&
                        std::is_same_v<Char2, char>) {
     return mozilla::ArrayEqual(reinterpret_cast<const char*>(s1), s2, len);
+  } else if constexpr (std::is_same_v<Char1, JS::Latin1Char> &&
+                       std::is_same_v<Char2, char16_t>) {
+    // Mixed-encoding comparisons can't use memcmp. Short strings are compared
+    // inline, and longer ones by widening the Latin-1 side 16 characters at a
+    // time, which isn't worth the call for less than one vector.
+    if (len < 16) {
+      return mozilla::ArrayEqual(s1, s2, len);
+    }
+    return mozilla::SIMD::memeq8x16(reinterpret_cast<const char*>(s1), s2,
+                                    len);
+  } else if constexpr (std::is_same_v<Char1, char16_t> &&
+                       std::is_same_v<Char2, JS::Latin1Char>) {
+    return EqualChars(s2, s1, len);
   } else {
     return mozilla::ArrayEqual(s1, s2, len);
   }
@@ -80,6 +80,7 @@
 
 #include "mozilla/Casting.h"
 #include "mozilla/CheckedInt.h"
+#include "mozilla/DebugOnly.h"
 #include "mozilla/FloatingPoint.h"
 #include "mozilla/HashFunctions.h"
 #include "mozilla/MathAlgorithms.h"
@@ -92,6 +93,7 @@
 #include "mozilla/Try.h"
 #include "mozilla/WrappingOperations.h"
 
+#include <algorithm>
 #include <charconv>
 #include <functional>
 #include <limits>
@@ -496,6 +498,140 @@ void BigInt::multiplyAccumulate(const BigInt* multiplicand, Digit multiplier,
   }
 }
 
+BigInt::Digit BigInt::digitsInplaceAdd(Digits x, ConstDigits y) {
+  MOZ_ASSERT(x.Length() >= y.Length());
+
+  Digit carry = 0;
+  size_t i = 0;
+  for (; i < y.Length(); i++) {
+    Digit newCarry = 0;
+    Digit sum = digitAdd(x[i], y[i], &newCarry);
+    x[i] = digitAdd(sum, carry, &newCarry);
+    carry = newCarry;
+  }
+  for (; carry && i < x.Length(); i++) {
+    Digit newCarry = 0;
+    x[i] = digitAdd(x[i], carry, &newCarry);
+    carry = newCarry;
+  }
+  return carry;
+}
+
+BigInt::Digit BigInt::digitsInplaceSub(Digits x, ConstDigits y) {
+  MOZ_ASSERT(x.Length() >= y.Length());
+
+  Digit borrow = 0;
+  size_t i = 0;
+  for (; i < y.Length(); i++) {
+    Digit newBorrow = 0;
+    Digit difference = digitSub(x[i], y[i], &newBorrow);
+    x[i] = digitSub(difference, borrow, &newBorrow);
+    borrow = newBorrow;
+  }
+  for (; borrow && i < x.Length(); i++) {
+    Digit newBorrow = 0;
+    x[i] = digitSub(x[i], borrow, &newBorrow);
+    borrow = newBorrow;
+  }
+  return borrow;
+}
+
+void BigInt::multiplySchoolbook(ConstDigits x, ConstDigits y, Digits result) {
+  MOZ_ASSERT(result.Length() == x.Length() + y.Length());
+
+  std::fill(result.begin(), result.end(), 0);
+
+  for (size_t j = 0; j < y.Length(); j++) {
+    Digit multiplier = y[j];
+    if (!multiplier) {
+      continue;
+    }
+
+    // result[i + j] + x[i] * multiplier + carry is at most (2^DigitBits)^2 - 1,
+    // so the high half of each step always fits in a single digit.
+    Digit carry = 0;
+    for (size_t i = 0; i < x.Length(); i++) {
+      Digit high = 0;
+      Digit low = digitMul(x[i], multiplier, &high);
+      Digit newCarry = 0;
+      Digit acc = digitAdd(result[i + j], low, &newCarry);
+      result[i + j] = digitAdd(acc, carry, &newCarry);
+      carry = high + newCarry;
+    }
+    result[j + x.Length()] = carry;
+  }
+}
+
+size_t BigInt::karatsubaScratchLength(size_t length) {
+  // Each level needs two half-length sums and their product, and recurses
+  // (at most) once on the product of the sums.
+  size_t scratch = 0;
+  while (length >= KaratsubaThreshold) {
+    size_t sumLength = length - length / 2 + 1;
+    scratch += 4 * sumLength;
+    length = sumLength;
+  }
+  return scratch;
+}
+
+// Karatsuba multiplication: split both operands at `low` digits into
+// x = x1 * B^low + x0 and y = y1 * B^low + y0. Then
+//
+//   x * y = z2 * B^(2 * low) + z1 * B^low + z0
+//
+// where z0 = x0 * y0, z2 = x1 * y1 and
+// z1 = (x0 + x1) * (y0 + y1) - z0 - z2, which needs three recursive
+// multiplications of half the size instead of four.
+void BigInt::multiplyKaratsuba(ConstDigits x, ConstDigits y, Digits result,
+                               Digits scratch) {
+  size_t length = x.Length();
+  MOZ_ASSERT(y.Length() == length);
+  MOZ_ASSERT(result.Length() == 2 * length);
+  MOZ_ASSERT(scratch.Length() >= karatsubaScratchLength(length));
+
+  if (length < KaratsubaThreshold) {
+    multiplySchoolbook(x, y, result);
+    return;
+  }
+
+  size_t low = length / 2;
+  size_t high = length - low;
+  size_t sumLength = high + 1;
+
+  Digits sumX = scratch.To(sumLength);
+  Digits sumY = scratch.Subspan(sumLength, sumLength);
+  Digits z1 = scratch.Subspan(2 * sumLength, 2 * sumLength);
+  Digits rest = scratch.From(4 * sumLength);
+
+  // z0 and z2 are computed in place in the low and high parts of the result.
+  Digits z0 = result.To(2 * low);
+  Digits z2 = result.From(2 * low);
+  multiplyKaratsuba(x.To(low), y.To(low), z0, rest);
+  multiplyKaratsuba(x.From(low), y.From(low), z2, rest);
+
+  std::copy(x.begin() + low, x.end(), sumX.begin());
+  sumX[high] = 0;
+  mozilla::DebugOnly<Digit> carry = digitsInplaceAdd(sumX, x.To(low));
+  MOZ_ASSERT(!carry);
+
+  std::copy(y.begin() + low, y.end(), sumY.begin());
+  sumY[high] = 0;
+  carry = digitsInplaceAdd(sumY, y.To(low));
+  MOZ_ASSERT(!carry);
+
+  multiplyKaratsuba(sumX, sumY, z1, rest);
+
+  mozilla::DebugOnly<Digit> borrow = digitsInplaceSub(z1, z0);
+  MOZ_ASSERT(!borrow);
+  borrow = digitsInplaceSub(z1, z2);
+  MOZ_ASSERT(!borrow);
+
+  // z1 < 2 * B^(low + high), so its top digits are zero and it fits in the
+  // result above `low` digits.
+  carry = digitsInplaceAdd(result.From(low), z1);
+  MOZ_ASSERT(!carry);
+}
+
 inline int8_t BigInt::absoluteCompare(const BigInt* x, const BigInt* y) {
   MOZ_ASSERT(!HasLeadingZeroes(x));
   MOZ_ASSERT(!HasLeadingZeroes(y));
@@ -1891,8 +2027,59 @@ BigInt* BigInt::mul(JSContext* cx, HandleBigInt x, HandleBigInt y) {
     std::swap(left, right);
   }
 
-  for (size_t i = 0; i < right->digitLength(); i++) {
-    multiplyAccumulate(left, right->digit(i), result, i);
+  if (right->digitLength() < KaratsubaThreshold) {
+    for (size_t i = 0; i < right->digitLength(); i++) {
+      multiplyAccumulate(left, right->digit(i), result, i);
+    }
+
+    return destructivelyTrimHighZeroDigits(cx, result);
+  }
+
+  // For large operands, split the longer one into chunks as long as the
+  // shorter one and multiply each chunk with Karatsuba. The last chunk is
+  // zero-padded to full length.
+  size_t chunkLength = right->digitLength();
+  bool balanced = left->digitLength() == chunkLength;
+  size_t scratchLength = karatsubaScratchLength(chunkLength);
+  if (!balanced) {
+    scratchLength += 3 * chunkLength;
+  }
+
+  auto scratch = cx->make_pod_array<Digit>(scratchLength);
+  if (!scratch) {
+    return nullptr;
+  }
+  Digits scratchDigits(scratch.get(), scratchLength);
+
+  ConstDigits leftDigits = left->digits();
+  ConstDigits rightDigits = right->digits();
+  Digits resultDigits = result->digits();
+
+  if (balanced) {
+    multiplyKaratsuba(leftDigits, rightDigits, resultDigits, scratchDigits);
+    return destructivelyTrimHighZeroDigits(cx, result);
+  }
+
+  Digits paddedChunk = scratchDigits.To(chunkLength);
+  Digits product = scratchDigits.Subspan(chunkLength, 2 * chunkLength);
+  Digits rest = scratchDigits.From(3 * chunkLength);
+
+  for (size_t start = 0; start < leftDigits.Length(); start += chunkLength) {
+    size_t length = std::min(chunkLength, leftDigits.Length() - start);
+    ConstDigits chunk = leftDigits.Subspan(start, length);
+    if (length < chunkLength) {
+      std::copy(chunk.begin(), chunk.end(), paddedChunk.begin());
+      std::fill(paddedChunk.begin() + length, paddedChunk.end(), 0);
+      chunk = paddedChunk;
+    }
+
+    multiplyKaratsuba(chunk, rightDigits, product, rest);
+
+    // Only the low `length + chunkLength` digits of the product can be
+    // non-zero.
+    mozilla::DebugOnly<Digit> carry = digitsInplaceAdd(
+        resultDigits.From(start), product.To(length + chunkLength));
+    MOZ_ASSERT(!carry);
   }
 
   return destructivelyTrimHighZeroDigits(cx, result);
@@ -327,6 +327,31 @@ class BigInt final : public js::gc::CellWithLengthAndFlags {
   static void multiplyAccumulate(const BigInt* multiplicand, Digit multiplier,
                                  BigInt* accumulator,
                                  unsigned accumulatorIndex);
+
+  // Operands with at least this many digits are multiplied with Karatsuba
+  // multiplication instead of the schoolbook method. Tuned with
+  // testBigIntPerf_Mul: Karatsuba starts winning at 24-32 digits, and larger
+  // thresholds are measurably slower for operands of hundreds of digits.
+  static constexpr size_t KaratsubaThreshold = 32;
+
+  // Number of scratch digits needed by multiplyKaratsuba for two operands of
+  // `length` digits.
+  static size_t karatsubaScratchLength(size_t length);
+
+  // Compute `x * y` into `result`, which must have exactly
+  // `x.Length() + y.Length()` digits.
+  static void multiplySchoolbook(ConstDigits x, ConstDigits y, Digits result);
+
+  // As above, but `x` and `y` must have the same length and `scratch` must
+  // have at least `karatsubaScratchLength(x.Length())` digits.
+  static void multiplyKaratsuba(ConstDigits x, ConstDigits y, Digits result,
+                                Digits scratch);
+
+  // Compute `x += y` or `x -= y` in place, propagating the carry or borrow
+  // through the digits of `x` above `y.Length()`. Returns the final carry or
+  // borrow (0 or 1).
+  static Digit digitsInplaceAdd(Digits x, ConstDigits y);
+  static Digit digitsInplaceSub(Digits x, ConstDigits y);
   static bool absoluteDivWithBigIntDivisor(
       JSContext* cx, Handle<BigInt*> dividend, Handle<BigInt*> divisor,
       const mozilla::Maybe<MutableHandle<BigInt*>>& quotient,
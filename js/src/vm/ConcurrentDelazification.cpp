@@ -214,6 +214,7 @@ bool DelazificationContext::delazify() {
 
   LifoAlloc tempLifoAlloc(JSContext::TEMP_LIFO_ALLOC_PRIMARY_CHUNK_SIZE,
                           js::BackgroundMallocArena);
+  tempLifoAlloc.usePooledChunks();
 
   while (!strategy_->done()) {
     if (isInterrupted_) {
@@ -136,6 +136,13 @@ class GlobalHelperThreadState {
       runningTaskCount;
   size_t totalCountRunningTasks;
 
+  // Count of outstanding embedder hints that tasks of each threadType are
+  // latency sensitive. See JS::SetHelperThreadTaskTypeUrgent.
+  mozilla::EnumeratedArray<ThreadType, uint32_t,
+                           size_t(ThreadType::THREAD_TYPE_MAX)>
+      urgentTaskCount;
+  uint32_t totalUrgentTaskCount;
+
   WriteOnceData<JS::RegisterThreadCallback> registerThread;
   WriteOnceData<JS::UnregisterThreadCallback> unregisterThread;
 
@@ -502,7 +509,15 @@ class GlobalHelperThreadState {
 
   using Selector = HelperThreadTask* (
       GlobalHelperThreadState::*)(const AutoLockHelperThreadState&);
-  static const Selector selectors[];
+  struct SelectorEntry {
+    ThreadType threadType;
+    Selector select;
+  };
+  static const SelectorEntry selectors[];
+
+ public:
+  void setTaskTypeUrgent(ThreadType threadType, bool urgent,
+                         const AutoLockHelperThreadState& lock);
 };
 
 static inline bool IsHelperThreadStateInitialized() {
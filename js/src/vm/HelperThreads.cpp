@@ -58,6 +58,7 @@ static void CancelOffThreadWasmPartialTier2CompileLocked(
 namespace js {
 
 MOZ_RUNINIT Mutex gHelperThreadLock(mutexid::GlobalHelperThreadState);
+mozilla::Atomic<bool, mozilla::Relaxed> gHelperThreadLockStatsEnabled(false);
 GlobalHelperThreadState* gHelperThreadState = nullptr;
 
 }  // namespace js
@@ -143,6 +144,62 @@ JS_PUBLIC_API MOZ_NEVER_INLINE const char* JS::GetHelperThreadTaskName(
   return task->getName();
 }
 
+JS_PUBLIC_API void JS::SetHelperThreadTaskTypeUrgent(js::ThreadType type,
+                                                     bool urgent) {
+  AutoLockHelperThreadState lock;
+  HelperThreadState().setTaskTypeUrgent(type, urgent, lock);
+}
+
+void GlobalHelperThreadState::setTaskTypeUrgent(
+    ThreadType threadType, bool urgent, const AutoLockHelperThreadState& lock) {
+  MOZ_RELEASE_ASSERT(threadType > THREAD_TYPE_MAIN &&
+                     threadType < THREAD_TYPE_MAX);
+
+  if (urgent) {
+    urgentTaskCount[threadType]++;
+    totalUrgentTaskCount++;
+    return;
+  }
+
+  MOZ_RELEASE_ASSERT(urgentTaskCount[threadType] != 0,
+                     "Unbalanced call to SetHelperThreadTaskTypeUrgent");
+  urgentTaskCount[threadType]--;
+  totalUrgentTaskCount--;
+}
+
+// Statistics for the helper thread lock, protected by the lock itself.
+static JS::HelperThreadLockStats gHelperThreadLockStats;
+
+void AutoLockHelperThreadState::recordHoldTime() {
+  uint64_t held = uint64_t(
+      (mozilla::TimeStamp::Now() - lockedAt_).ToMicroseconds());
+  lockedAt_ = mozilla::TimeStamp();
+  gHelperThreadLockStats.acquisitions++;
+  gHelperThreadLockStats.totalHoldMicroseconds += held;
+  gHelperThreadLockStats.maxHoldMicroseconds =
+      std::max(gHelperThreadLockStats.maxHoldMicroseconds, held);
+}
+
+void AutoLockHelperThreadState::wait(ConditionVariable& condVar,
+                                     TimeDuration timeout) {
+  noteUnlocking();
+  condVar.wait_for(*this, timeout);
+  noteLocked();
+}
+
+JS_PUBLIC_API void JS::SetHelperThreadLockStatsEnabled(bool enabled) {
+  gHelperThreadLockStatsEnabled = enabled;
+}
+
+JS_PUBLIC_API void JS::GetHelperThreadLockStats(HelperThreadLockStats* stats,
+                                                bool reset) {
+  AutoLockHelperThreadState lock;
+  *stats = gHelperThreadLockStats;
+  if (reset) {
+    gHelperThreadLockStats = HelperThreadLockStats();
+  }
+}
+
 void GlobalHelperThreadState::setDispatchTaskCallback(
     JS::HelperThreadTaskCallback callback, size_t threadCount, size_t stackSize,
     const AutoLockHelperThreadState& lock) {
@@ -213,6 +270,7 @@ GlobalHelperThreadState::GlobalHelperThreadState()
     : cpuCount(0),
       threadCount(0),
       totalCountRunningTasks(0),
+      totalUrgentTaskCount(0),
       registerThread(nullptr),
       unregisterThread(nullptr),
       wasmCompleteTier2GeneratorsFinished_(0) {
@@ -221,6 +279,10 @@ GlobalHelperThreadState::GlobalHelperThreadState()
   cpuCount = ClampDefaultCPUCount(GetCPUCount());
   threadCount = ThreadCountForCPUCount(cpuCount);
 
+  for (uint32_t& count : urgentTaskCount) {
+    count = 0;
+  }
+
   MOZ_ASSERT(cpuCount > 0, "GetCPUCount() seems broken");
 }
 
@@ -286,7 +348,7 @@ void GlobalHelperThreadState::wait(
     AutoLockHelperThreadState& lock,
     TimeDuration timeout /* = TimeDuration::Forever() */) {
   MOZ_ASSERT(!lock.hasQueuedTasks());
-  consumerWakeup.wait_for(lock, timeout);
+  lock.wait(consumerWakeup, timeout);
 }
 
 void GlobalHelperThreadState::notifyAll(const AutoLockHelperThreadState&) {
@@ -573,21 +635,34 @@ void GlobalHelperThreadState::trace(JSTracer* trc) {
 
 // Definition of helper thread tasks.
 //
-// Priority is determined by the order they're listed here.
-const GlobalHelperThreadState::Selector GlobalHelperThreadState::selectors[] = {
-    &GlobalHelperThreadState::maybeGetGCParallelTask,
-    &GlobalHelperThreadState::maybeGetBaselineCompileTask,
-    &GlobalHelperThreadState::maybeGetIonCompileTask,
-    &GlobalHelperThreadState::maybeGetWasmTier1CompileTask,
-    &GlobalHelperThreadState::maybeGetPromiseHelperTask,
-    &GlobalHelperThreadState::maybeGetFreeDelazifyTask,
-    &GlobalHelperThreadState::maybeGetDelazifyTask,
-    &GlobalHelperThreadState::maybeGetCompressionTask,
-    &GlobalHelperThreadState::maybeGetLowPrioIonCompileTask,
-    &GlobalHelperThreadState::maybeGetIonFreeTask,
-    &GlobalHelperThreadState::maybeGetWasmPartialTier2CompileTask,
-    &GlobalHelperThreadState::maybeGetWasmTier2CompileTask,
-    &GlobalHelperThreadState::maybeGetWasmCompleteTier2GeneratorTask};
+// Priority is determined by the order they're listed here, except that task
+// types the embedder has marked as urgent are considered first.
+const GlobalHelperThreadState::SelectorEntry
+    GlobalHelperThreadState::selectors[] = {
+        {THREAD_TYPE_GCPARALLEL,
+         &GlobalHelperThreadState::maybeGetGCParallelTask},
+        {THREAD_TYPE_BASELINE,
+         &GlobalHelperThreadState::maybeGetBaselineCompileTask},
+        {THREAD_TYPE_ION, &GlobalHelperThreadState::maybeGetIonCompileTask},
+        {THREAD_TYPE_WASM_COMPILE_TIER1,
+         &GlobalHelperThreadState::maybeGetWasmTier1CompileTask},
+        {THREAD_TYPE_PROMISE_TASK,
+         &GlobalHelperThreadState::maybeGetPromiseHelperTask},
+        {THREAD_TYPE_DELAZIFY_FREE,
+         &GlobalHelperThreadState::maybeGetFreeDelazifyTask},
+        {THREAD_TYPE_DELAZIFY,
+         &GlobalHelperThreadState::maybeGetDelazifyTask},
+        {THREAD_TYPE_COMPRESS,
+         &GlobalHelperThreadState::maybeGetCompressionTask},
+        {THREAD_TYPE_ION,
+         &GlobalHelperThreadState::maybeGetLowPrioIonCompileTask},
+        {THREAD_TYPE_ION_FREE, &GlobalHelperThreadState::maybeGetIonFreeTask},
+        {THREAD_TYPE_WASM_COMPILE_PARTIAL_TIER2,
+         &GlobalHelperThreadState::maybeGetWasmPartialTier2CompileTask},
+        {THREAD_TYPE_WASM_COMPILE_TIER2,
+         &GlobalHelperThreadState::maybeGetWasmTier2CompileTask},
+        {THREAD_TYPE_WASM_GENERATOR_COMPLETE_TIER2,
+         &GlobalHelperThreadState::maybeGetWasmCompleteTier2GeneratorTask}};
 
 bool GlobalHelperThreadState::canStartTasks(
     const AutoLockHelperThreadState& lock) {
@@ -630,8 +705,19 @@ HelperThreadTask* GlobalHelperThreadState::findHighestPriorityTask(
     const AutoLockHelperThreadState& locked) {
   // Return the highest priority task that is ready to start, or nullptr.
 
+  if (totalUrgentTaskCount) {
+    for (const auto& selector : selectors) {
+      if (!urgentTaskCount[selector.threadType]) {
+        continue;
+      }
+      if (auto* task = (this->*(selector.select))(locked)) {
+        return task;
+      }
+    }
+  }
+
   for (const auto& selector : selectors) {
-    if (auto* task = (this->*(selector))(locked)) {
+    if (auto* task = (this->*(selector.select))(locked)) {
       return task;
     }
   }
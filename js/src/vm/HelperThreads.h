@@ -11,6 +11,8 @@
 #ifndef vm_HelperThreads_h
 #define vm_HelperThreads_h
 
+#include "mozilla/Atomics.h"
+#include "mozilla/TimeStamp.h"
 #include "mozilla/Variant.h"
 
 #include "js/AllocPolicy.h"
@@ -38,6 +40,7 @@ class SourceText;
 namespace js {
 
 class AutoLockHelperThreadState;
+class ConditionVariable;
 struct PromiseHelperTask;
 class SourceCompressionTask;
 
@@ -72,6 +75,10 @@ using UniquePartialTier2CompileTask = UniquePtr<PartialTier2CompileTask>;
  */
 extern Mutex gHelperThreadLock MOZ_UNANNOTATED;
 
+// Whether to time how long gHelperThreadLock is held. This is off unless an
+// embedder asks for it, see JS::SetHelperThreadLockStatsEnabled.
+extern mozilla::Atomic<bool, mozilla::Relaxed> gHelperThreadLockStatsEnabled;
+
 // Set of tasks to dispatch when the helper thread state lock is released.
 class AutoHelperTaskQueue {
  public:
@@ -93,16 +100,48 @@ class MOZ_RAII AutoLockHelperThreadState
     : public AutoHelperTaskQueue,  // Must come before LockGuard.
       public LockGuard<Mutex> {
  public:
-  AutoLockHelperThreadState() : LockGuard<Mutex>(gHelperThreadLock) {}
+  AutoLockHelperThreadState() : LockGuard<Mutex>(gHelperThreadLock) {
+    noteLocked();
+  }
   AutoLockHelperThreadState(const AutoLockHelperThreadState&) = delete;
 
+  ~AutoLockHelperThreadState() { noteUnlocking(); }
+
+  // Wait on a condition variable that is used with gHelperThreadLock. The
+  // lock is released while waiting, so the wait doesn't count towards the
+  // time the lock is held.
+  void wait(ConditionVariable& condVar,
+            mozilla::TimeDuration timeout = mozilla::TimeDuration::Forever());
+
  private:
   friend class UnlockGuard<AutoLockHelperThreadState>;
+  void lock() {
+    LockGuard<Mutex>::lock();
+    noteLocked();
+  }
   void unlock() {
+    noteUnlocking();
     LockGuard<Mutex>::unlock();
     dispatchQueuedTasks();
   }
 
+  void noteLocked() {
+    if (gHelperThreadLockStatsEnabled) {
+      lockedAt_ = mozilla::TimeStamp::Now();
+    }
+  }
+  void noteUnlocking() {
+    if (!lockedAt_.IsNull()) {
+      recordHoldTime();
+    }
+  }
+
+  // Record how long the lock was held in the lock statistics.
+  void recordHoldTime();
+
+  // When the lock was taken, or null if lock statistics are disabled.
+  mozilla::TimeStamp lockedAt_;
+
   friend class GlobalHelperThreadState;
 };
 
@@ -21,6 +21,7 @@
 
 #include "builtin/AtomicsObject.h"
 #include "builtin/TestingFunctions.h"
+#include "ds/LifoAlloc.h"
 #include "gc/Statistics.h"
 #include "jit/Assembler.h"
 #include "jit/Ion.h"
@@ -274,6 +275,9 @@ static void ShutdownImpl(JS::detail::FrontendOnly frontendOnly) {
 
   js::wasm::ShutDown();
 
+  // Free pooled LifoAlloc chunks before their malloc arenas are destroyed.
+  js::LifoChunkPool::purge();
+
 #if JS_HAS_INTL_API
   mozilla::intl::ICU4CLibrary::Cleanup();
 #  if MOZ_ICU4X
@@ -313,7 +313,7 @@ void HelperThread::threadLoop(InternalThreadPool* pool) {
   while (!pool->terminating) {
     if (!nextTask) {
       AUTO_PROFILER_LABEL("HelperThread::threadLoop::wait", IDLE);
-      wakeup.wait(lock);
+      lock.wait(wakeup);
       continue;
     }
 
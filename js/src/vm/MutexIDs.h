@@ -70,7 +70,9 @@
   _(VTuneLock, 600)                   \
   _(ShellTelemetry, 600)              \
   _(ShellUseCounters, 600)            \
-  _(WasmCodeMetaStats, 600)
+  _(WasmCodeMetaStats, 600)           \
+                                      \
+  _(LifoChunkPool, 700)
 
 namespace js {
 namespace mutexid {
@@ -211,7 +211,7 @@ void OffThreadPromiseRuntimeState::internalDrain(JSContext* cx) {
       // There are extant live OffThreadPromiseTasks. If none are in the queue,
       // block until one of them finishes and enqueues a dispatchable.
       while (internalDispatchQueue().empty()) {
-        internalDispatchQueueAppended().wait(lock);
+        lock.wait(internalDispatchQueueAppended());
       }
 
       d = internalDispatchQueue().popCopyFront();
@@ -274,7 +274,7 @@ void OffThreadPromiseRuntimeState::shutdown(JSContext* cx) {
   // runs only on the JSContext's thread, so we can delete them all here.
   while (live().count() != numCanceled_) {
     MOZ_ASSERT(numCanceled_ < live().count());
-    allCanceled().wait(lock);
+    lock.wait(allCanceled());
   }
 
   // Now that live_ contains only cancelled tasks, we can just delete
@@ -20,6 +20,7 @@
 #include "jsfriendapi.h"
 #include "jsmath.h"
 
+#include "ds/LifoAlloc.h"
 #include "frontend/CompilationStencil.h"
 #include "frontend/ParserAtom.h"  // frontend::WellKnownParserAtoms
 #include "gc/GC.h"
@@ -347,6 +348,8 @@ void JSRuntime::addSizeOfIncludingThis(mozilla::MallocSizeOf mallocSizeOf,
     rtSizes->atomsTable +=
         js::frontend::WellKnownParserAtoms::getSingleton().sizeOfExcludingThis(
             mallocSizeOf);
+    rtSizes->lifoChunkPool +=
+        js::LifoChunkPool::sizeOfExcludingThis(mallocSizeOf);
   }
 
 #ifdef JS_HAS_INTL_API
@@ -477,11 +480,7 @@ void JSContext::requestInterrupt(InterruptReason reason) {
     // If this interrupt is urgent (slow script dialog for instance), take
     // additional steps to interrupt corner cases where the above fields are
     // not regularly polled.
-    FutexThread::lock();
-    if (fx.isWaiting()) {
-      fx.notify(FutexThread::NotifyForJSInterrupt);
-    }
-    fx.unlock();
+    fx.notifyForInterrupt();
   }
 
   if (reason == InterruptReason::CallbackUrgent ||
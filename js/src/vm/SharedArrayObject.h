@@ -17,7 +17,6 @@
 
 namespace js {
 
-class FutexWaiter;
 class WasmSharedArrayRawBuffer;
 
 /*
@@ -62,10 +61,6 @@ class SharedArrayRawBuffer {
   mozilla::Atomic<uint32_t, mozilla::ReleaseAcquire> refcount_;
   mozilla::Atomic<size_t, mozilla::SequentiallyConsistent> length_;
 
-  // A list of structures representing tasks waiting on some
-  // location within this buffer.
-  FutexWaiter* waiters_ = nullptr;
-
  protected:
   SharedArrayRawBuffer(bool isGrowable, uint8_t* buffer, size_t length)
       : isWasm_(false), isGrowable_(isGrowable), refcount_(1), length_(length) {
@@ -85,14 +80,6 @@ class SharedArrayRawBuffer {
 
   inline WasmSharedArrayRawBuffer* toWasmBuffer();
 
-  // This may be called from multiple threads.  The caller must take
-  // care of mutual exclusion.
-  FutexWaiter* waiters() const { return waiters_; }
-
-  // This may be called from multiple threads.  The caller must take
-  // care of mutual exclusion.
-  void setWaiters(FutexWaiter* waiters) { waiters_ = waiters; }
-
   inline SharedMem<uint8_t*> dataPointerShared() const;
 
   size_t volatileByteLength() const { return length_; }
@@ -14,11 +14,12 @@ namespace js {
 template <typename IntoOwnedChars>
 [[nodiscard]] SharedImmutableString SharedImmutableStringsCache::getOrCreate(
     const char* chars, size_t length, IntoOwnedChars intoOwnedChars) {
-  MOZ_ASSERT(inner_);
   MOZ_ASSERT(chars);
-  Hasher::Lookup lookup(Hasher::hashLongString(chars, length), chars, length);
+  HashNumber hash = Hasher::hashLongString(chars, length);
+  Hasher::Lookup lookup(hash, chars, length);
 
-  auto locked = inner_->lock();
+  const ExclusiveData<Inner>* shard = shardFor(hash);
+  auto locked = shard->lock();
   auto entry = locked->set.lookupForAdd(lookup);
   if (!entry) {
     OwnedChars ownedChars(intoOwnedChars());
@@ -27,7 +28,7 @@ template <typename IntoOwnedChars>
     }
     MOZ_ASSERT(ownedChars.get() == chars ||
                memcmp(ownedChars.get(), chars, length) == 0);
-    auto box = StringBox::Create(std::move(ownedChars), length, inner_);
+    auto box = StringBox::Create(std::move(ownedChars), length, shard);
     if (!box || !locked->set.add(entry, std::move(box))) {
       return SharedImmutableString();
     }
@@ -42,13 +43,13 @@ template <typename IntoOwnedTwoByteChars>
 SharedImmutableStringsCache::getOrCreate(
     const char16_t* chars, size_t length,
     IntoOwnedTwoByteChars intoOwnedTwoByteChars) {
-  MOZ_ASSERT(inner_);
   MOZ_ASSERT(chars);
   auto hash = Hasher::hashLongString(reinterpret_cast<const char*>(chars),
                                      length * sizeof(char16_t));
   Hasher::Lookup lookup(hash, chars, length);
 
-  auto locked = inner_->lock();
+  const ExclusiveData<Inner>* shard = shardFor(hash);
+  auto locked = shard->lock();
   auto entry = locked->set.lookupForAdd(lookup);
   if (!entry) {
     OwnedTwoByteChars ownedTwoByteChars(intoOwnedTwoByteChars());
@@ -60,7 +61,7 @@ SharedImmutableStringsCache::getOrCreate(
         memcmp(ownedTwoByteChars.get(), chars, length * sizeof(char16_t)) == 0);
     OwnedChars ownedChars(reinterpret_cast<char*>(ownedTwoByteChars.release()));
     auto box = StringBox::Create(std::move(ownedChars),
-                                 length * sizeof(char16_t), inner_);
+                                 length * sizeof(char16_t), shard);
     if (!box || !locked->set.add(entry, std::move(box))) {
       return SharedImmutableTwoByteString();
     }
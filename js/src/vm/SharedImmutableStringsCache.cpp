@@ -101,24 +101,29 @@ SharedImmutableTwoByteString SharedImmutableTwoByteString::clone() const {
 }
 
 bool SharedImmutableStringsCache::init() {
-  MOZ_ASSERT(!inner_);
-
-  auto* inner =
-      js_new<ExclusiveData<Inner>>(mutexid::SharedImmutableStringsCache);
-  if (!inner) {
-    return false;
+  MOZ_ASSERT(!shards_[0]);
+
+  for (size_t i = 0; i < NumShards; i++) {
+    auto* shard =
+        js_new<ExclusiveData<Inner>>(mutexid::SharedImmutableStringsCache);
+    if (!shard) {
+      free();
+      return false;
+    }
+
+    auto locked = shard->lock();
+    shards_[i] = locked.parent();
   }
 
-  auto locked = inner->lock();
-  inner_ = locked.parent();
-
   return true;
 }
 
 void SharedImmutableStringsCache::free() {
-  if (inner_) {
-    js_delete(inner_);
-    inner_ = nullptr;
+  for (const ExclusiveData<Inner>*& shard : shards_) {
+    if (shard) {
+      js_delete(shard);
+      shard = nullptr;
+    }
   }
 }
 
@@ -7,6 +7,8 @@
 #ifndef vm_SharedImmutableStringsCache_h
 #define vm_SharedImmutableStringsCache_h
 
+#include "mozilla/Array.h"
+#include "mozilla/MathAlgorithms.h"
 #include "mozilla/Maybe.h"
 #include "mozilla/UniquePtr.h"
 
@@ -31,10 +33,12 @@ class SharedImmutableTwoByteString;
  * immutable strings (either `const char*` [any encoding, not restricted to
  * only Latin-1 or only UTF-8] or `const char16_t*`) between threads.
  *
- * The locking mechanism is dead-simple and coarse grained: a single lock guards
- * all of the internal table itself, the table's entries, and the entries'
- * reference counts. It is only safe to perform any mutation on the cache or any
- * data stored within the cache when this lock is acquired.
+ * The cache is split into a fixed number of shards, selected by the string's
+ * hash, so that threads registering unrelated strings (for example off-thread
+ * parse tasks registering script sources) do not contend on a single lock.
+ * Each shard has a single lock guarding its table, the table's entries, and
+ * the entries' reference counts. It is only safe to perform any mutation on a
+ * shard or any data stored within it when its lock is acquired.
  */
 class SharedImmutableStringsCache {
   static SharedImmutableStringsCache singleton_;
@@ -135,19 +139,23 @@ class SharedImmutableStringsCache {
                                                          size_t length);
 
   size_t sizeOfExcludingThis(mozilla::MallocSizeOf mallocSizeOf) const {
-    MOZ_ASSERT(inner_);
-    size_t n = mallocSizeOf(inner_);
+    MOZ_ASSERT(shards_[0]);
+    size_t n = 0;
 
-    auto locked = inner_->lock();
+    for (const ExclusiveData<Inner>* shard : shards_) {
+      n += mallocSizeOf(shard);
 
-    // Size of the table.
-    n += locked->set.shallowSizeOfExcludingThis(mallocSizeOf);
+      auto locked = shard->lock();
 
-    // Sizes of the strings and their boxes.
-    for (auto r = locked->set.all(); !r.empty(); r.popFront()) {
-      n += mallocSizeOf(r.front().get());
-      if (const char* chars = r.front()->chars()) {
-        n += mallocSizeOf(chars);
+      // Size of the table.
+      n += locked->set.shallowSizeOfExcludingThis(mallocSizeOf);
+
+      // Sizes of the strings and their boxes.
+      for (auto r = locked->set.all(); !r.empty(); r.popFront()) {
+        n += mallocSizeOf(r.front().get());
+        if (const char* chars = r.front()->chars()) {
+          n += mallocSizeOf(chars);
+        }
       }
     }
 
@@ -163,7 +171,7 @@ class SharedImmutableStringsCache {
   static void freeSingleton();
 
   static SharedImmutableStringsCache& getSingleton() {
-    MOZ_ASSERT(singleton_.inner_);
+    MOZ_ASSERT(singleton_.shards_[0]);
     return singleton_;
   }
 
@@ -185,16 +193,18 @@ class SharedImmutableStringsCache {
    * Purge the cache of all refcount == 0 entries.
    */
   void purge() {
-    auto locked = inner_->lock();
-
-    for (Inner::Set::Enum e(locked->set); !e.empty(); e.popFront()) {
-      if (e.front()->refcount == 0) {
-        // The chars should be eagerly freed when refcount reaches zero.
-        MOZ_ASSERT(!e.front()->chars());
-        e.removeFront();
-      } else {
-        // The chars should exist as long as the refcount is non-zero.
-        MOZ_ASSERT(e.front()->chars());
+    for (const ExclusiveData<Inner>* shard : shards_) {
+      auto locked = shard->lock();
+
+      for (Inner::Set::Enum e(locked->set); !e.empty(); e.popFront()) {
+        if (e.front()->refcount == 0) {
+          // The chars should be eagerly freed when refcount reaches zero.
+          MOZ_ASSERT(!e.front()->chars());
+          e.removeFront();
+        } else {
+          // The chars should exist as long as the refcount is non-zero.
+          MOZ_ASSERT(e.front()->chars());
+        }
       }
     }
   }
@@ -300,9 +310,9 @@ class SharedImmutableStringsCache {
     }
   };
 
-  // The `Inner` struct contains the actual cached contents and shared between
-  // the `SharedImmutableStringsCache` singleton and all
-  // `SharedImmutable[TwoByte]String` holders.
+  // The `Inner` struct contains the cached contents of one shard and is shared
+  // between the `SharedImmutableStringsCache` singleton and all
+  // `SharedImmutable[TwoByte]String` holders of strings in that shard.
   struct Inner {
     using Set = HashSet<StringBox::Ptr, Hasher, SystemAllocPolicy>;
 
@@ -314,7 +324,15 @@ class SharedImmutableStringsCache {
     Inner& operator=(const Inner&) = delete;
   };
 
-  const ExclusiveData<Inner>* inner_ = nullptr;
+  static constexpr size_t NumShards = 16;
+  static_assert(mozilla::IsPowerOfTwo(NumShards));
+
+  const ExclusiveData<Inner>* shardFor(HashNumber hash) const {
+    MOZ_ASSERT(shards_[0]);
+    return shards_[hash & (NumShards - 1)];
+  }
+
+  mozilla::Array<const ExclusiveData<Inner>*, NumShards> shards_{};
 };
 
 /**
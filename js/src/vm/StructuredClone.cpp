@@ -69,6 +69,7 @@
 #include "vm/TypedArrayObject.h"
 #include "wasm/WasmJS.h"
 
+#include "gc/StableCellHasher-inl.h"
 #include "vm/ArrayObject-inl.h"
 #include "vm/Compartment-inl.h"
 #include "vm/ErrorObject-inl.h"
@@ -76,6 +77,7 @@
 #include "vm/JSObject-inl.h"
 #include "vm/NativeObject-inl.h"
 #include "vm/ObjectOperations-inl.h"
+#include "vm/PlainObject-inl.h"
 #include "vm/Realm-inl.h"
 #include "vm/StringType-inl.h"
 
@@ -150,6 +152,11 @@ enum StructuredDataType : uint32_t {
   SCTAG_RESIZABLE_ARRAY_BUFFER_OBJECT,
   SCTAG_GROWABLE_SHARED_ARRAY_BUFFER_OBJECT,
 
+  // Plain objects written with a shape template. See traverseShapeTemplate.
+  SCTAG_SHAPE_TEMPLATE_DEFINITION,
+  SCTAG_SHAPE_TEMPLATE_OBJECT,
+  SCTAG_SHAPE_TEMPLATE_HOLE,
+
   SCTAG_TYPED_ARRAY_V1_MIN = 0xFFFF0100,
   SCTAG_TYPED_ARRAY_V1_INT8 = SCTAG_TYPED_ARRAY_V1_MIN + Scalar::Int8,
   SCTAG_TYPED_ARRAY_V1_UINT8 = SCTAG_TYPED_ARRAY_V1_MIN + Scalar::Uint8,
@@ -491,6 +498,16 @@ struct JSStructuredCloneReader {
 
   [[nodiscard]] bool readObjectField(HandleObject obj, HandleValue key);
 
+  // Plain objects written with a shape template. See traverseShapeTemplate.
+  [[nodiscard]] bool readShapeTemplateDefinition(uint32_t nkeys,
+                                                 MutableHandleValue vp);
+  [[nodiscard]] bool readShapeTemplateObject(uint32_t index,
+                                             MutableHandleValue vp);
+  [[nodiscard]] bool startShapeTemplateObject(PlainObject* obj,
+                                              uint32_t index,
+                                              MutableHandleValue vp);
+  [[nodiscard]] bool readShapeTemplateField(Handle<PlainObject*> obj);
+
   [[nodiscard]] bool startRead(
       MutableHandleValue vp,
       ShouldAtomizeStrings atomizeStrings = DontAtomizeStrings);
@@ -537,6 +554,26 @@ struct JSStructuredCloneReader {
   // one `undefined` placeholder value (the readTypedArray hack).
   RootedValueVector allObjs;
 
+  // Shape templates read so far, in order of definition. Each template's keys
+  // are stored in shapeTemplateKeys, and new objects using the template are
+  // allocated directly with its shape.
+  struct ShapeTemplate {
+    uint32_t firstKey;
+    uint32_t keyCount;
+  };
+  Vector<ShapeTemplate, 0, SystemAllocPolicy> shapeTemplates;
+  RootedIdVector shapeTemplateKeys;
+  Rooted<GCVector<SharedShape*, 0, SystemAllocPolicy>> shapeTemplateShapes;
+
+  // Objects on the `objs` stack that are being filled in from a shape
+  // template, along with the index of the next key to read a value for.
+  struct ShapeTemplateState {
+    size_t objsIndex;
+    uint32_t templateIndex;
+    uint32_t nextKey;
+  };
+  Vector<ShapeTemplateState, 0, SystemAllocPolicy> shapeTemplateStates;
+
   size_t numItemsRead;
 
   // The user defined callbacks that will be used for cloning.
@@ -582,6 +619,8 @@ struct JSStructuredCloneWriter {
         objs(cx),
         counts(cx),
         objectEntries(cx),
+        templatedObjs(cx),
+        shapeTemplates(cx),
         otherEntries(cx),
         memory(cx),
         transferable(cx, tVal),
@@ -623,6 +662,7 @@ struct JSStructuredCloneWriter {
   bool writePrimitive(HandleValue v);
   bool startWrite(HandleValue v);
   bool traverseObject(HandleObject obj, ESClass cls);
+  bool traverseShapeTemplate(HandleObject obj, bool* templated);
   bool traverseMap(HandleObject obj);
   bool traverseSet(HandleObject obj);
   bool traverseSavedFrame(HandleObject obj);
@@ -658,6 +698,16 @@ struct JSStructuredCloneWriter {
   // For JSObject: Property IDs as value
   RootedIdVector objectEntries;
 
+  // Indices into objs of the objects being written with a shape template.
+  // Their properties are written as values only, in shape order.
+  Vector<size_t> templatedObjs;
+
+  // The shape templates written so far, mapped to their index in the order
+  // they were written.
+  using ShapeTemplateMap = GCHashMap<Shape*, uint32_t, StableCellHasher<Shape*>,
+                                     SystemAllocPolicy>;
+  Rooted<ShapeTemplateMap> shapeTemplates;
+
   // For Map: Key followed by value
   // For Set: Key
   // For SavedFrame: parent SavedFrame
@@ -989,6 +1039,13 @@ bool SCOutput::writeArray(const T* p, size_t nelems) {
     return true;
   }
 
+#if MOZ_LITTLE_ENDIAN()
+  // No byte swapping needed, so append the whole array at once.
+  if (!buf.AppendBytes(reinterpret_cast<const char*>(p), nelems * sizeof(T))) {
+    ReportOutOfMemory(context());
+    return false;
+  }
+#else
   for (size_t i = 0; i < nelems; i++) {
     T value = NativeEndian::swapToLittleEndian(p[i]);
     if (!buf.AppendBytes(reinterpret_cast<char*>(&value), sizeof(value))) {
@@ -996,6 +1053,7 @@ bool SCOutput::writeArray(const T* p, size_t nelems) {
       return false;
     }
   }
+#endif
 
   // Zero-pad to 8 bytes boundary.
   size_t padbytes = ComputePadding(nelems, sizeof(T));
@@ -1658,6 +1716,16 @@ static bool TryAppendNativeProperties(JSContext* cx, HandleObject obj,
 // ends with its end-of-children marker) and so it can be presented indented.
 // But see traverseMap below for how this looks different for Maps.
 bool JSStructuredCloneWriter::traverseObject(HandleObject obj, ESClass cls) {
+  if (cls == ESClass::Object && cloneDataPolicy.areShapeTemplatesAllowed()) {
+    bool templated;
+    if (!traverseShapeTemplate(obj, &templated)) {
+      return false;
+    }
+    if (templated) {
+      return true;
+    }
+  }
+
   size_t count;
   bool optimized = false;
   if (!js::SupportDifferentialTesting()) {
@@ -1716,6 +1784,94 @@ bool JSStructuredCloneWriter::traverseObject(HandleObject obj, ESClass cls) {
   return out.writePair(SCTAG_OBJECT_OBJECT, 0);
 }
 
+// Plain objects whose properties are all enumerable data properties with
+// non-index string keys can be written with a shape template, if the clone
+// data policy allows it. The first object with a given shape writes the
+// property names once:
+//
+//     <SCTAG_SHAPE_TEMPLATE_DEFINITION, number of keys>
+//       <key1 data>
+//       <key2 data>
+//
+// and every later object with the same shape refers to that definition by
+// index (in order of definition):
+//
+//     <SCTAG_SHAPE_TEMPLATE_OBJECT, template index>
+//
+// Either header is followed by one value per key, in shape order, and then the
+// usual end-of-children marker. The reader allocates the objects directly with
+// the template's shape and fills in the slots. A property that disappears
+// while the object is being written is written as SCTAG_SHAPE_TEMPLATE_HOLE in
+// place of its value.
+static constexpr uint32_t ShapeTemplateMaxKeys = 256;
+
+bool JSStructuredCloneWriter::traverseShapeTemplate(HandleObject obj,
+                                                    bool* templated) {
+  *templated = false;
+
+  if (!obj->is<PlainObject>()) {
+    return true;
+  }
+
+  Handle<PlainObject*> plain = obj.as<PlainObject>();
+  if (plain->inDictionaryMode() || plain->isIndexed() ||
+      plain->getDenseInitializedLength() != 0) {
+    return true;
+  }
+
+  uint32_t count = 0;
+  for (ShapePropertyIter<NoGC> iter(plain->shape()); !iter.done(); iter++) {
+    if (!iter->enumerable() || !iter->isDataProperty() ||
+        !iter->key().isAtom()) {
+      return true;
+    }
+    count++;
+  }
+
+  if (count == 0 || count > ShapeTemplateMaxKeys) {
+    return true;
+  }
+
+  // Push the property ids in reverse order so that they will come off the
+  // stack in forward order.
+  size_t firstEntry = objectEntries.length();
+  for (ShapePropertyIter<NoGC> iter(plain->shape()); !iter.done(); iter++) {
+    if (!objectEntries.append(iter->key())) {
+      return false;
+    }
+  }
+
+  if (!objs.append(ObjectValue(*obj)) || !counts.append(count) ||
+      !templatedObjs.append(objs.length() - 1)) {
+    return false;
+  }
+
+  checkStack();
+
+  *templated = true;
+
+  auto p = shapeTemplates.lookupForAdd(plain->shape());
+  if (p) {
+    return out.writePair(SCTAG_SHAPE_TEMPLATE_OBJECT, p->value());
+  }
+
+  uint32_t index = shapeTemplates.count();
+  if (!shapeTemplates.add(p, plain->shape(), index)) {
+    ReportOutOfMemory(context());
+    return false;
+  }
+
+  if (!out.writePair(SCTAG_SHAPE_TEMPLATE_DEFINITION, count)) {
+    return false;
+  }
+  for (size_t i = objectEntries.length(); i > firstEntry; i--) {
+    if (!writeString(SCTAG_STRING, objectEntries[i - 1].toAtom())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Use the same basic setup as for traverseObject, but now keys can themselves
 // be complex objects. Keys and values are visited first via startWrite(), then
 // the key's children (if any) are handled, then the value's children.
@@ -2476,11 +2632,20 @@ bool JSStructuredCloneWriter::write(HandleValue v) {
         key = IdToValue(id);
         checkStack();
 
+        // Objects written with a shape template have already written their
+        // keys, so only the value (or a hole) is written here.
+        bool templated = !templatedObjs.empty() &&
+                         templatedObjs.back() == objs.length() - 1;
+
         // If obj still has an own property named id, write it out.
         bool found;
         if (GetOwnPropertyPure(context(), obj, id, val.address(), &found)) {
           if (found) {
-            if (!writePrimitive(key) || !startWrite(val)) {
+            if ((!templated && !writePrimitive(key)) || !startWrite(val)) {
+              return false;
+            }
+          } else if (templated) {
+            if (!out.writePair(SCTAG_SHAPE_TEMPLATE_HOLE, 0)) {
               return false;
             }
           }
@@ -2500,16 +2665,24 @@ bool JSStructuredCloneWriter::write(HandleValue v) {
           }
 #endif
 
-          if (!writePrimitive(key) ||
+          if ((!templated && !writePrimitive(key)) ||
               !GetProperty(context(), obj, obj, id, &val) || !startWrite(val)) {
             return false;
           }
+        } else if (templated) {
+          if (!out.writePair(SCTAG_SHAPE_TEMPLATE_HOLE, 0)) {
+            return false;
+          }
         }
       }
     } else {
       if (!out.writePair(SCTAG_END_OF_KEYS, 0)) {
         return false;
       }
+      if (!templatedObjs.empty() &&
+          templatedObjs.back() == objs.length() - 1) {
+        templatedObjs.popBack();
+      }
       objs.popBack();
       counts.popBack();
     }
@@ -2529,6 +2702,8 @@ JSStructuredCloneReader::JSStructuredCloneReader(
       objs(in.context()),
       objState(in.context(), in.context()),
       allObjs(in.context()),
+      shapeTemplateKeys(in.context()),
+      shapeTemplateShapes(in.context()),
       numItemsRead(0),
       callbacks(cb),
       closure(cbClosure),
@@ -3316,6 +3491,24 @@ bool JSStructuredCloneReader::startRead(MutableHandleValue vp,
       break;
     }
 
+    case SCTAG_SHAPE_TEMPLATE_DEFINITION:
+      if (!readShapeTemplateDefinition(data, vp)) {
+        return false;
+      }
+      break;
+
+    case SCTAG_SHAPE_TEMPLATE_OBJECT:
+      if (!readShapeTemplateObject(data, vp)) {
+        return false;
+      }
+      break;
+
+    case SCTAG_SHAPE_TEMPLATE_HOLE:
+      JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                                JSMSG_SC_BAD_SERIALIZED_DATA,
+                                "unexpected shape template hole");
+      return false;
+
     case SCTAG_END_OF_KEYS:
       JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
                                 JSMSG_SC_BAD_SERIALIZED_DATA,
@@ -3922,6 +4115,150 @@ bool JSStructuredCloneReader::readObjectField(HandleObject obj,
   return DefineDataProperty(context(), obj, id, val);
 }
 
+bool JSStructuredCloneReader::readShapeTemplateDefinition(
+    uint32_t nkeys, MutableHandleValue vp) {
+  if (nkeys == 0 || nkeys > ShapeTemplateMaxKeys) {
+    JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                              JSMSG_SC_BAD_SERIALIZED_DATA,
+                              "invalid shape template");
+    return false;
+  }
+
+  // Build the template's shape on the first object that uses it, by adding
+  // every key with an undefined value. The values are filled in later.
+  NewObjectKind kind =
+      gcHeap == gc::Heap::Tenured ? TenuredObject : GenericObject;
+  Rooted<PlainObject*> obj(
+      context(),
+      NewPlainObjectWithAllocKind(context(), gc::GetGCObjectKind(nkeys), kind));
+  if (!obj) {
+    return false;
+  }
+
+  uint32_t firstKey = shapeTemplateKeys.length();
+  RootedValue key(context());
+  RootedId id(context());
+  for (uint32_t i = 0; i < nkeys; i++) {
+    if (!startRead(&key, AtomizeStrings)) {
+      return false;
+    }
+    if (!key.isString()) {
+      JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                                JSMSG_SC_BAD_SERIALIZED_DATA,
+                                "property key expected");
+      return false;
+    }
+    if (!PrimitiveValueToId<CanGC>(context(), key, &id)) {
+      return false;
+    }
+    if (!id.isAtom() || obj->contains(context(), id)) {
+      JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                                JSMSG_SC_BAD_SERIALIZED_DATA,
+                                "invalid shape template key");
+      return false;
+    }
+    if (!AddDataPropertyToPlainObject(context(), obj, id,
+                                      UndefinedHandleValue)) {
+      return false;
+    }
+    if (!shapeTemplateKeys.append(id)) {
+      return false;
+    }
+  }
+
+  uint32_t index = shapeTemplates.length();
+  if (!shapeTemplates.append(ShapeTemplate{firstKey, nkeys}) ||
+      !shapeTemplateShapes.append(obj->sharedShape())) {
+    ReportOutOfMemory(context());
+    return false;
+  }
+
+  return startShapeTemplateObject(obj, index, vp);
+}
+
+bool JSStructuredCloneReader::readShapeTemplateObject(uint32_t index,
+                                                      MutableHandleValue vp) {
+  if (index >= shapeTemplates.length()) {
+    JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                              JSMSG_SC_BAD_SERIALIZED_DATA,
+                              "invalid shape template index");
+    return false;
+  }
+
+  NewObjectKind kind =
+      gcHeap == gc::Heap::Tenured ? TenuredObject : GenericObject;
+  Rooted<SharedShape*> shape(context(), shapeTemplateShapes[index]);
+  PlainObject* obj = PlainObject::createWithShape(context(), shape, kind);
+  if (!obj) {
+    return false;
+  }
+
+  return startShapeTemplateObject(obj, index, vp);
+}
+
+bool JSStructuredCloneReader::startShapeTemplateObject(PlainObject* obj,
+                                                       uint32_t index,
+                                                       MutableHandleValue vp) {
+  if (!objs.append(ObjectValue(*obj))) {
+    return false;
+  }
+  if (!shapeTemplateStates.append(
+          ShapeTemplateState{objs.length() - 1, index, 0})) {
+    ReportOutOfMemory(context());
+    return false;
+  }
+
+  vp.setObject(*obj);
+  return true;
+}
+
+bool JSStructuredCloneReader::readShapeTemplateField(
+    Handle<PlainObject*> obj) {
+  size_t stateIndex = shapeTemplateStates.length() - 1;
+  ShapeTemplateState state = shapeTemplateStates[stateIndex];
+  ShapeTemplate tmpl = shapeTemplates[state.templateIndex];
+
+  if (state.nextKey >= tmpl.keyCount) {
+    JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                              JSMSG_SC_BAD_SERIALIZED_DATA,
+                              "too many shape template values");
+    return false;
+  }
+
+  // Reading the value may push more states, so update ours first.
+  uint32_t keyIndex = state.nextKey;
+  shapeTemplateStates[stateIndex].nextKey++;
+
+  RootedId id(context(), shapeTemplateKeys[tmpl.firstKey + keyIndex]);
+
+  uint32_t tag, data;
+  if (!in.getPair(&tag, &data)) {
+    return false;
+  }
+
+  if (tag == SCTAG_SHAPE_TEMPLATE_HOLE) {
+    // The property was deleted while the object was being written.
+    MOZ_ALWAYS_TRUE(in.readPair(&tag, &data));
+    ObjectOpResult ignored;
+    return NativeDeleteProperty(context(), obj, id, ignored);
+  }
+
+  RootedValue val(context());
+  if (!startRead(&val)) {
+    return false;
+  }
+
+  // Unless a hole has removed a property, the object still has the template's
+  // shape and the key's slot is its index in the template.
+  if (obj->shape() == shapeTemplateShapes[state.templateIndex]) {
+    MOZ_ASSERT(obj->lookupPure(id)->slot() == keyIndex);
+    obj->setSlot(keyIndex, val);
+    return true;
+  }
+
+  return NativeDefineDataProperty(context(), obj, id, val, JSPROP_ENUMERATE);
+}
+
 // Perform the whole recursive reading procedure.
 bool JSStructuredCloneReader::read(MutableHandleValue vp, size_t nbytes) {
   auto startTime = mozilla::TimeStamp::Now();
@@ -3956,7 +4293,21 @@ bool JSStructuredCloneReader::read(MutableHandleValue vp, size_t nbytes) {
       return false;
     }
 
+    bool templated = !shapeTemplateStates.empty() &&
+                     shapeTemplateStates.back().objsIndex == objs.length() - 1;
+
     if (tag == SCTAG_END_OF_KEYS) {
+      if (templated) {
+        const ShapeTemplateState& state = shapeTemplateStates.back();
+        if (state.nextKey != shapeTemplates[state.templateIndex].keyCount) {
+          JS_ReportErrorNumberASCII(context(), GetErrorMessage, nullptr,
+                                    JSMSG_SC_BAD_SERIALIZED_DATA,
+                                    "missing shape template values");
+          return false;
+        }
+        shapeTemplateStates.popBack();
+      }
+
       // Pop the current obj off the stack, since we are done with it and
       // its children.
       MOZ_ALWAYS_TRUE(in.readPair(&tag, &data));
@@ -3967,6 +4318,14 @@ bool JSStructuredCloneReader::read(MutableHandleValue vp, size_t nbytes) {
       continue;
     }
 
+    if (templated) {
+      Rooted<PlainObject*> plain(context(), &obj->as<PlainObject>());
+      if (!readShapeTemplateField(plain)) {
+        return false;
+      }
+      continue;
+    }
+
     // Remember the index of the current top of the state stack, which will
     // correspond to the state for `obj` iff `obj` is a type that uses state.
     // startRead() may push additional entries before the state is accessed and
@@ -791,7 +791,8 @@ void CompilerEnvironment::computeParameters() {
   state_ = Computed;
 }
 
-void CompilerEnvironment::computeParameters(const ModuleMetadata& moduleMeta) {
+void CompilerEnvironment::computeParameters(const ModuleMetadata& moduleMeta,
+                                            bool serializable) {
   MOZ_ASSERT(!isComputed());
 
   if (state_ == InitialWithModeTierDebug) {
@@ -815,9 +816,11 @@ void CompilerEnvironment::computeParameters(const ModuleMetadata& moduleMeta) {
   uint32_t codeSectionSize = moduleMeta.codeMeta->codeSectionSize();
 
   // We use lazy tiering if the 'for-all' pref is enabled, or the 'gc-only'
-  // pref is enabled and we're compiling a GC module.
-  bool lazyTiering = JS::Prefs::wasm_lazy_tiering() ||
-                     (JS::Prefs::wasm_lazy_tiering_for_gc() && isGcModule);
+  // pref is enabled and we're compiling a GC module, unless the module is to
+  // be serialized, which requires a complete optimized tier.
+  bool lazyTiering = !serializable &&
+                     (JS::Prefs::wasm_lazy_tiering() ||
+                      (JS::Prefs::wasm_lazy_tiering_for_gc() && isGcModule));
 
   if (baselineEnabled && hasSecondTier &&
       (TieringBeneficial(lazyTiering, codeSectionSize) || forceTiering) &&
@@ -909,7 +912,7 @@ SharedModule wasm::CompileBuffer(const CompileArgs& args,
     return nullptr;
   }
   CompilerEnvironment compilerEnv(args);
-  compilerEnv.computeParameters(*moduleMeta);
+  compilerEnv.computeParameters(*moduleMeta, /* serializable = */ !!listener);
   if (!moduleMeta->prepareForCompile(compilerEnv.mode())) {
     return nullptr;
   }
@@ -1069,7 +1072,7 @@ SharedModule wasm::CompileStreaming(
     const CompileArgs& args, const Bytes& envBytes, const Bytes& codeBytes,
     const ExclusiveBytesPtr& codeBytesEnd,
     const ExclusiveStreamEndData& exclusiveStreamEnd,
-    const Atomic<bool>& cancelled, UniqueChars* error,
+    const Atomic<bool>& cancelled, bool serializable, UniqueChars* error,
     UniqueCharsVector* warnings) {
   CompilerEnvironment compilerEnv(args);
   MutableModuleMetadata moduleMeta = js_new<ModuleMetadata>();
@@ -1084,7 +1087,7 @@ SharedModule wasm::CompileStreaming(
     if (!DecodeModuleEnvironment(d, &codeMeta, moduleMeta)) {
       return nullptr;
     }
-    compilerEnv.computeParameters(*moduleMeta);
+    compilerEnv.computeParameters(*moduleMeta, serializable);
 
     if (!codeMeta.codeSectionRange) {
       d.fail("unknown section before code section");
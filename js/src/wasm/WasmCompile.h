@@ -77,6 +77,9 @@ bool CompilePartialTier2(const Code& code, uint32_t funcIndex,
 //  - streamEnd contains the final information received after the code section:
 //    the remaining module bytecodes and maybe a JS::OptimizedEncodingListener.
 //    When the stream is successfully closed, streamEnd.reached is set.
+//  - serializable is set if the embedding announced that it will pass a
+//    listener at stream end, in which case lazy tiering is not used so that
+//    the complete tier can be handed to the listener.
 // The ExclusiveWaitableData are notified when CompileStreaming() can make
 // progress (i.e., codeBytesEnd advances or streamEnd.reached is set).
 // If cancelled is set to true, compilation aborts and returns null. After
@@ -99,7 +102,8 @@ SharedModule CompileStreaming(const CompileArgs& args, const Bytes& envBytes,
                               const ExclusiveBytesPtr& codeBytesEnd,
                               const ExclusiveStreamEndData& streamEnd,
                               const mozilla::Atomic<bool>& cancelled,
-                              UniqueChars* error, UniqueCharsVector* warnings);
+                              bool serializable, UniqueChars* error,
+                              UniqueCharsVector* warnings);
 
 // What to print out from dumping a function from Ion.
 enum class IonDumpContents {
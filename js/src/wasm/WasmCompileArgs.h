@@ -290,8 +290,11 @@ struct CompilerEnvironment {
   // final value of gc/refTypes.
   CompilerEnvironment(CompileMode mode, Tier tier, DebugEnabled debugEnabled);
 
-  // Compute any remaining compilation parameters.
-  void computeParameters(const ModuleMetadata& moduleMeta);
+  // Compute any remaining compilation parameters. If |serializable| is true,
+  // the embedding wants to cache the module, so lazy tiering (whose code
+  // cannot be serialized) is not used.
+  void computeParameters(const ModuleMetadata& moduleMeta,
+                         bool serializable = false);
 
   // Compute any remaining compilation parameters.  Only use this method if
   // the CompilerEnvironment was created with values for mode, tier, and
@@ -126,7 +126,7 @@ ModuleGenerator::~ModuleGenerator() {
           break;
         }
 
-        taskState_.condVar().wait(lock); /* failed or finished */
+        lock.wait(taskState_.condVar()); /* failed or finished */
       }
     }
   } else {
@@ -721,7 +721,7 @@ bool ModuleGenerator::finishOutstandingTask() {
         break;
       }
 
-      taskState_.condVar().wait(lock); /* failed or finished */
+      lock.wait(taskState_.condVar()); /* failed or finished */
     }
   }
 
@@ -175,7 +175,9 @@ struct CompileTask : public HelperThreadTask {
         compilerEnv(compilerEnv),
         compileState(compileState),
         state(state),
-        lifo(defaultChunkSize, js::MallocArena) {}
+        lifo(defaultChunkSize, js::MallocArena) {
+    lifo.usePooledChunks();
+  }
 
   virtual ~CompileTask() = default;
 
@@ -4644,6 +4644,10 @@ class CompileStreamTask : public PromiseHelperTask, public JS::StreamConsumer {
   // first call on stream thread:
   const MutableCompileArgs compileArgs_;
 
+  // Immutable after noteOptimizedEncodingWanted() which is likewise called
+  // before the first call on stream thread:
+  bool optimizedEncodingWanted_;
+
   // Immutable after Env state:
   Bytes envBytes_;
   BytecodeRange codeSection_;
@@ -4680,6 +4684,10 @@ class CompileStreamTask : public PromiseHelperTask, public JS::StreamConsumer {
     }
   }
 
+  void noteOptimizedEncodingWanted() override {
+    optimizedEncodingWanted_ = true;
+  }
+
   // Called on a stream thread:
 
   // Until StartOffThreadPromiseHelperTask succeeds, we are responsible for
@@ -4815,7 +4823,7 @@ class CompileStreamTask : public PromiseHelperTask, public JS::StreamConsumer {
           return;
         }
         module_ = CompileBuffer(*compileArgs_, *bytecode, &compileError_,
-                                &warnings_, nullptr);
+                                &warnings_, completeTier2Listener);
         setClosedAndDestroyBeforeHelperThreadStarted();
         return;
       }
@@ -4864,7 +4872,8 @@ class CompileStreamTask : public PromiseHelperTask, public JS::StreamConsumer {
   void execute() override {
     module_ = CompileStreaming(*compileArgs_, envBytes_, codeBytes_,
                                exclusiveCodeBytesEnd_, exclusiveStreamEnd_,
-                               streamFailed_, &compileError_, &warnings_);
+                               streamFailed_, optimizedEncodingWanted_,
+                               &compileError_, &warnings_);
 
     // When execute() returns, the CompileStreamTask will be dispatched
     // back to its JS thread to call resolve() and then be destroyed. We
@@ -4908,6 +4917,7 @@ class CompileStreamTask : public PromiseHelperTask, public JS::StreamConsumer {
         instantiate_(instantiate),
         importObj_(cx, importObj),
         compileArgs_(&compileArgs),
+        optimizedEncodingWanted_(false),
         codeSection_{},
         codeBytesEnd_(nullptr),
         exclusiveCodeBytesEnd_(mutexid::WasmCodeBytesEnd, nullptr),
@@ -1933,6 +1933,11 @@ void ReportJSRuntimeExplicitTreeStats(const JS::RuntimeStats& rtStats,
   RREPORT_BYTES(rtPath + "runtime/interpreter-stack"_ns, KIND_HEAP,
                 rtStats.runtime.interpreterStack, "JS interpreter frames.");
 
+  RREPORT_BYTES(rtPath + "runtime/lifo-chunk-pool"_ns, KIND_HEAP,
+                rtStats.runtime.lifoChunkPool,
+                "Free LifoAlloc chunks kept for reuse by parsing and wasm "
+                "compilation, shared across all JSRuntimes.");
+
   RREPORT_BYTES(
       rtPath + "runtime/shared-immutable-strings-cache"_ns, KIND_HEAP,
       rtStats.runtime.sharedImmutableStringsCache,
@@ -328,6 +328,12 @@ class BufferList : private AllocPolicy {
   // bytes may be split across multiple buffers. Size() is increased by aSize.
   [[nodiscard]] inline bool WriteBytes(const char* aData, size_t aSize);
 
+  // Like WriteBytes, but whatever does not fit in the last segment is copied
+  // into a single new segment sized to hold it, rather than being split into
+  // segments of the standard capacity. Intended for large payloads, which can
+  // then be read back with one copy.
+  [[nodiscard]] inline bool WriteLargeBytes(const char* aData, size_t aSize);
+
   // Allocates a buffer of at most |aMaxBytes| bytes and, if successful, returns
   // that buffer, and places its size in |aSize|. If unsuccessful, returns null
   // and leaves |aSize| undefined.
@@ -451,6 +457,44 @@ template <typename AllocPolicy>
   return true;
 }
 
+template <typename AllocPolicy>
+[[nodiscard]] bool BufferList<AllocPolicy>::WriteLargeBytes(const char* aData,
+                                                            size_t aSize) {
+  MOZ_RELEASE_ASSERT(mOwning);
+  MOZ_RELEASE_ASSERT(mStandardCapacity);
+
+  size_t copied = 0;
+  if (!mSegments.empty()) {
+    Segment& lastSegment = mSegments.back();
+
+    copied = std::min(aSize, lastSegment.mCapacity - lastSegment.mSize);
+    memcpy(lastSegment.mData + lastSegment.mSize, aData, copied);
+    lastSegment.mSize += copied;
+    mSize += copied;
+  }
+
+  size_t remaining = aSize - copied;
+  if (!remaining) {
+    return true;
+  }
+
+  // Round the capacity up so that following writes stay aligned and small
+  // trailing writes (e.g. padding) can share the segment.
+  size_t capacity = std::max(
+      (remaining + kSegmentAlignment - 1) & ~(kSegmentAlignment - 1),
+      mStandardCapacity);
+  if (capacity < remaining) {
+    return false;
+  }
+
+  char* data = AllocateSegment(remaining, capacity);
+  if (!data) {
+    return false;
+  }
+  memcpy(data, aData + copied, remaining);
+  return true;
+}
+
 template <typename AllocPolicy>
 char* BufferList<AllocPolicy>::AllocateBytes(size_t aMaxSize, size_t* aSize) {
   MOZ_RELEASE_ASSERT(mOwning);
@@ -368,5 +368,32 @@ int main(void) {
   MOZ_RELEASE_ASSERT(iter.Done());
   MOZ_RELEASE_ASSERT(bl13.Size() == 0);
 
+  // WriteLargeBytes fills the last segment, then puts the rest in one segment.
+  BufferList bl14(0, 0, 16);
+  MOZ_ALWAYS_TRUE(bl14.WriteBytes("abcdefgh", 8));
+  char large[100];
+  for (size_t i = 0; i < sizeof(large); i++) {
+    large[i] = char(i % 37);
+  }
+  MOZ_ALWAYS_TRUE(bl14.WriteLargeBytes(large, sizeof(large)));
+  MOZ_RELEASE_ASSERT(bl14.Size() == 108);
+
+  iter = bl14.Iter();
+  MOZ_RELEASE_ASSERT(iter.RemainingInSegment() == 16);
+  iter.Advance(bl14, 16);
+  MOZ_RELEASE_ASSERT(iter.RemainingInSegment() == 92);
+  for (size_t i = 8; i < sizeof(large); i++) {
+    MOZ_RELEASE_ASSERT(*iter.Data() == large[i]);
+    iter.Advance(bl14, 1);
+  }
+  MOZ_RELEASE_ASSERT(iter.Done());
+
+  // Small writes after a large one share its segment's spare capacity.
+  MOZ_ALWAYS_TRUE(bl14.WriteBytes("1234", 4));
+  MOZ_RELEASE_ASSERT(bl14.Size() == 112);
+  iter = bl14.Iter();
+  iter.Advance(bl14, 16);
+  MOZ_RELEASE_ASSERT(iter.RemainingInSegment() == 96);
+
   return 0;
 }
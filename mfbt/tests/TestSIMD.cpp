@@ -591,6 +591,95 @@ void TestSpecialCases() {
   MOZ_RELEASE_ASSERT(SIMD::memchr2x16(test2wide, 'a', 'b', 26) == nullptr);
 }
 
+void TestEqualWidened() {
+  const char* narrow =
+      "abcdefghijklmnopqrstuvwxyz0123456789"
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZ\xe9\xff";
+  const size_t length = 64;
+  char16_t wide[length];
+  for (size_t i = 0; i < length; i++) {
+    wide[i] = char16_t(static_cast<unsigned char>(narrow[i]));
+  }
+
+  for (size_t len = 0; len <= length; len++) {
+    MOZ_RELEASE_ASSERT(SIMD::memeq8x16(narrow, wide, len));
+  }
+
+  // Flip each position in turn, including into the high byte, which a naive
+  // byte-wise comparison would miss.
+  for (size_t i = 0; i < length; i++) {
+    char16_t saved = wide[i];
+    wide[i] = saved | 0x100;
+    for (size_t len = 0; len <= length; len++) {
+      MOZ_RELEASE_ASSERT(SIMD::memeq8x16(narrow, wide, len) == (len <= i));
+    }
+    wide[i] = saved ^ 0x1;
+    for (size_t len = 0; len <= length; len++) {
+      MOZ_RELEASE_ASSERT(SIMD::memeq8x16(narrow, wide, len) == (len <= i));
+    }
+    wide[i] = saved;
+  }
+}
+
+static bool IsAsciiIdentifierChar(char16_t c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+static bool IsAsciiLineChar(char16_t c) {
+  return c < 0x80 && c != '\n' && c != '\r';
+}
+
+void TestSkipAscii() {
+  const size_t length = 40;
+  char narrow[length];
+  char16_t wide[length];
+
+  // Values whose low byte aliases an ASCII identifier character, or which
+  // sit just outside one of the ranges, are the interesting ones.
+  const char16_t wideOnly[] = {0x0141, 0x0161, 0x0130, 0x2028, 0x2029,
+                               0x8041, 0xff41, 0xff5a, 0xffff};
+
+  auto check = [&](char16_t c, size_t pos) {
+    for (size_t i = 0; i < length; i++) {
+      narrow[i] = 'x';
+      wide[i] = 'x';
+    }
+    wide[pos] = c;
+    bool isNarrow = c <= 0xff;
+    if (isNarrow) {
+      narrow[pos] = char(c);
+    }
+
+    for (size_t len = 0; len <= length; len++) {
+      size_t expected = (pos < len && !IsAsciiIdentifierChar(c)) ? pos : len;
+      MOZ_RELEASE_ASSERT(SIMD::skipAsciiIdentifierChars16(wide, len) ==
+                         wide + expected);
+      if (isNarrow) {
+        MOZ_RELEASE_ASSERT(SIMD::skipAsciiIdentifierChars8(narrow, len) ==
+                           narrow + expected);
+      }
+
+      expected = (pos < len && !IsAsciiLineChar(c)) ? pos : len;
+      MOZ_RELEASE_ASSERT(SIMD::skipAsciiLineChars16(wide, len) ==
+                         wide + expected);
+      if (isNarrow) {
+        MOZ_RELEASE_ASSERT(SIMD::skipAsciiLineChars8(narrow, len) ==
+                           narrow + expected);
+      }
+    }
+  };
+
+  for (size_t pos = 0; pos < length; pos++) {
+    for (char16_t c = 0; c <= 0xff; c++) {
+      check(c, pos);
+    }
+    for (char16_t c : wideOnly) {
+      check(c, pos);
+    }
+  }
+}
+
 int main(void) {
   TestTinyString();
   TestShortString();
@@ -620,6 +709,10 @@ int main(void) {
   TestMediumString2x16();
   TestLongString2x16();
 
+  TestEqualWidened();
+
+  TestSkipAscii();
+
   TestSpecialCases();
 
   // These are too slow to run all the time, but they should be run when making
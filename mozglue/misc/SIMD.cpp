@@ -34,6 +34,37 @@ const TValue* FindInBufferNaive(const TValue* ptr, TValue value,
   return nullptr;
 }
 
+bool EqualWidenedNaive(const unsigned char* narrow, const char16_t* wide,
+                       size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (char16_t(narrow[i]) != wide[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename TValue>
+bool IsAsciiIdentifierChar(TValue c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+template <typename TValue>
+bool IsAsciiLineChar(TValue c) {
+  return c < 0x80 && c != '\n' && c != '\r';
+}
+
+template <typename TValue, typename Predicate>
+const TValue* SkipWhileNaive(const TValue* ptr, size_t length,
+                             Predicate predicate) {
+  const TValue* end = ptr + length;
+  while (ptr < end && predicate(*ptr)) {
+    ptr++;
+  }
+  return ptr;
+}
+
 #ifdef MOZILLA_PRESUME_SSE2
 
 const __m128i* Cast128(uintptr_t ptr) {
@@ -510,6 +541,136 @@ const char16_t* SIMD::memchr2x16(const char16_t* ptr, char16_t v1, char16_t v2,
   return FindTwoInBuffer<char16_t>(ptr, v1, v2, length);
 }
 
+bool SIMD::memeq8x16(const char* narrow, const char16_t* wide, size_t length) {
+  const unsigned char* unarrow = reinterpret_cast<const unsigned char*>(narrow);
+  if (length < 16) {
+    return EqualWidenedNaive(unarrow, wide, length);
+  }
+
+  // Widen 16 narrow chars at a time by interleaving them with zero bytes and
+  // compare the result against two 8-wide loads of the other side. Both
+  // halves are and'ed together so the loop only has a single branch.
+  const __m128i zero = _mm_setzero_si128();
+  auto check16 = [&](size_t i) {
+    __m128i n = _mm_loadu_si128(Cast128(uintptr_t(unarrow + i)));
+    __m128i lo = _mm_unpacklo_epi8(n, zero);
+    __m128i hi = _mm_unpackhi_epi8(n, zero);
+    __m128i wlo = _mm_loadu_si128(Cast128(uintptr_t(wide + i)));
+    __m128i whi = _mm_loadu_si128(Cast128(uintptr_t(wide + i + 8)));
+    __m128i cmp =
+        _mm_and_si128(_mm_cmpeq_epi16(lo, wlo), _mm_cmpeq_epi16(hi, whi));
+    return _mm_movemask_epi8(cmp) == 0xffff;
+  };
+
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    if (!check16(i)) {
+      return false;
+    }
+  }
+
+  // Overlap the final block with what we already checked rather than falling
+  // back to a scalar loop for the tail.
+  if (i < length) {
+    return check16(length - 16);
+  }
+  return true;
+}
+
+// Return a mask with all bits of each lane set if the lane holds an ASCII
+// letter, digit, '_' or '$'. Range checks are done with signed compares by
+// biasing each range so that it starts at the minimum lane value.
+template <typename TValue>
+__m128i AsciiIdentifierCharMask(__m128i v) {
+  static_assert(sizeof(TValue) == 1 || sizeof(TValue) == 2);
+  if (sizeof(TValue) == 1) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha =
+        _mm_cmplt_epi8(_mm_add_epi8(lower, _mm_set1_epi8(char(0x80 - 'a'))),
+                       _mm_set1_epi8(char(0x80 + 26)));
+    __m128i digit =
+        _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(char(0x80 - '0'))),
+                       _mm_set1_epi8(char(0x80 + 10)));
+    __m128i other = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+    return _mm_or_si128(_mm_or_si128(alpha, digit), other);
+  }
+  __m128i lower = _mm_or_si128(v, _mm_set1_epi16(0x20));
+  __m128i alpha =
+      _mm_cmplt_epi16(_mm_add_epi16(lower, _mm_set1_epi16(short(0x8000 - 'a'))),
+                      _mm_set1_epi16(short(0x8000 + 26)));
+  __m128i digit =
+      _mm_cmplt_epi16(_mm_add_epi16(v, _mm_set1_epi16(short(0x8000 - '0'))),
+                      _mm_set1_epi16(short(0x8000 + 10)));
+  __m128i other = _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('_')),
+                               _mm_cmpeq_epi16(v, _mm_set1_epi16('$')));
+  return _mm_or_si128(_mm_or_si128(alpha, digit), other);
+}
+
+// Return a mask with all bits of each lane set if the lane holds an ASCII
+// character other than '\n' or '\r'.
+template <typename TValue>
+__m128i AsciiLineCharMask(__m128i v) {
+  static_assert(sizeof(TValue) == 1 || sizeof(TValue) == 2);
+  __m128i ascii, lf, cr;
+  if (sizeof(TValue) == 1) {
+    ascii = _mm_cmpgt_epi8(v, _mm_set1_epi8(-1));
+    lf = _mm_set1_epi8('\n');
+    cr = _mm_set1_epi8('\r');
+  } else {
+    ascii = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xff80))),
+                            _mm_setzero_si128());
+    lf = _mm_set1_epi16('\n');
+    cr = _mm_set1_epi16('\r');
+  }
+  __m128i newline =
+      _mm_or_si128(CmpEq128<TValue>(v, lf), CmpEq128<TValue>(v, cr));
+  return _mm_andnot_si128(newline, ascii);
+}
+
+template <typename TValue, typename MaskFn, typename Predicate>
+const TValue* SkipWhile(const TValue* ptr, size_t length, MaskFn mask,
+                        Predicate predicate) {
+  constexpr size_t valuesPer16Bytes = 16 / sizeof(TValue);
+
+  const TValue* end = ptr + length;
+  while (size_t(end - ptr) >= valuesPer16Bytes) {
+    __m128i v = _mm_loadu_si128(Cast128(uintptr_t(ptr)));
+    int matches = _mm_movemask_epi8(mask(v));
+    if (matches != 0xffff) {
+      return ptr + __builtin_ctz(~matches) / sizeof(TValue);
+    }
+    ptr += valuesPer16Bytes;
+  }
+  return SkipWhileNaive(ptr, size_t(end - ptr), predicate);
+}
+
+const char* SIMD::skipAsciiIdentifierChars8(const char* ptr, size_t length) {
+  const unsigned char* uptr = reinterpret_cast<const unsigned char*>(ptr);
+  return reinterpret_cast<const char*>(
+      SkipWhile(uptr, length, AsciiIdentifierCharMask<unsigned char>,
+                IsAsciiIdentifierChar<unsigned char>));
+}
+
+const char16_t* SIMD::skipAsciiIdentifierChars16(const char16_t* ptr,
+                                                 size_t length) {
+  return SkipWhile(ptr, length, AsciiIdentifierCharMask<char16_t>,
+                   IsAsciiIdentifierChar<char16_t>);
+}
+
+const char* SIMD::skipAsciiLineChars8(const char* ptr, size_t length) {
+  const unsigned char* uptr = reinterpret_cast<const unsigned char*>(ptr);
+  return reinterpret_cast<const char*>(
+      SkipWhile(uptr, length, AsciiLineCharMask<unsigned char>,
+                IsAsciiLineChar<unsigned char>));
+}
+
+const char16_t* SIMD::skipAsciiLineChars16(const char16_t* ptr,
+                                           size_t length) {
+  return SkipWhile(ptr, length, AsciiLineCharMask<char16_t>,
+                   IsAsciiLineChar<char16_t>);
+}
+
 #else
 
 const char* SIMD::memchr8(const char* ptr, char value, size_t length) {
@@ -573,6 +734,33 @@ const char16_t* SIMD::memchr2x16(const char16_t* ptr, char16_t v1, char16_t v2,
   return nullptr;
 }
 
+bool SIMD::memeq8x16(const char* narrow, const char16_t* wide, size_t length) {
+  return EqualWidenedNaive(reinterpret_cast<const unsigned char*>(narrow), wide,
+                           length);
+}
+
+const char* SIMD::skipAsciiIdentifierChars8(const char* ptr, size_t length) {
+  const unsigned char* uptr = reinterpret_cast<const unsigned char*>(ptr);
+  return reinterpret_cast<const char*>(
+      SkipWhileNaive(uptr, length, IsAsciiIdentifierChar<unsigned char>));
+}
+
+const char16_t* SIMD::skipAsciiIdentifierChars16(const char16_t* ptr,
+                                                 size_t length) {
+  return SkipWhileNaive(ptr, length, IsAsciiIdentifierChar<char16_t>);
+}
+
+const char* SIMD::skipAsciiLineChars8(const char* ptr, size_t length) {
+  const unsigned char* uptr = reinterpret_cast<const unsigned char*>(ptr);
+  return reinterpret_cast<const char*>(
+      SkipWhileNaive(uptr, length, IsAsciiLineChar<unsigned char>));
+}
+
+const char16_t* SIMD::skipAsciiLineChars16(const char16_t* ptr,
+                                           size_t length) {
+  return SkipWhileNaive(ptr, length, IsAsciiLineChar<char16_t>);
+}
+
 #endif
 
 }  // namespace mozilla
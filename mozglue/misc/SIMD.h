@@ -83,6 +83,31 @@ class SIMD {
   // `v1`.
   static MFBT_API const char16_t* memchr2x16(const char16_t* ptr, char16_t v1,
                                              char16_t v2, size_t length);
+
+  // Return whether `narrow[0..length]`, with every byte zero-extended to a
+  // char16_t, is equal to `wide[0..length]`. This is the comparison needed to
+  // check a Latin-1 string against a UTF-16 string without inflating it first.
+  static MFBT_API bool memeq8x16(const char* narrow, const char16_t* wide,
+                                 size_t length);
+
+  // Return a pointer to the first element of `ptr[0..length]` which is not an
+  // ASCII letter, ASCII digit, '_' or '$', or `ptr + length` if every element
+  // is one of those.
+  static MFBT_API const char* skipAsciiIdentifierChars8(const char* ptr,
+                                                        size_t length);
+
+  // As above, for char16_t.
+  static MFBT_API const char16_t* skipAsciiIdentifierChars16(
+      const char16_t* ptr, size_t length);
+
+  // Return a pointer to the first element of `ptr[0..length]` which is '\n',
+  // '\r' or not ASCII, or `ptr + length` if there is no such element.
+  static MFBT_API const char* skipAsciiLineChars8(const char* ptr,
+                                                  size_t length);
+
+  // As above, for char16_t.
+  static MFBT_API const char16_t* skipAsciiLineChars16(const char16_t* ptr,
+                                                       size_t length);
 };
 
 }  // namespace mozilla
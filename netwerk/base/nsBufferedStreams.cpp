@@ -430,9 +430,51 @@ nsBufferedInputStream::Read(char* buf, uint32_t count, uint32_t* result) {
     return rv;
   }
 
+  {
+    // Reads at least as large as the buffer would only be staged through it,
+    // so once it has been drained, read them straight into the caller's
+    // buffer instead.
+    RecursiveMutexAutoLock lock(mBufferMutex);
+    if (mStream && mCursor == mFillPoint && count >= mBufferSize) {
+      nsresult rv = Source()->Read(buf, count, result);
+      if (NS_FAILED(rv)) {
+        *result = 0;
+        return rv;
+      }
+      mBufferStartOffset += mFillPoint + *result;
+      mCursor = mFillPoint = 0;
+      if (*result == 0) {
+        mEOF = true;
+      }
+      return NS_OK;
+    }
+  }
+
   return ReadSegments(NS_CopySegmentToBuffer, buf, count, result);
 }
 
+namespace {
+
+// Hands the segments of a buffered stream's source to the caller's writer as
+// if they had come from the buffered stream itself.
+struct ForwardedSegments {
+  nsIInputStream* mStream;
+  nsWriteSegmentFun mWriter;
+  void* mClosure;
+  bool mWriterCalled = false;
+};
+
+}  // namespace
+
+static nsresult ForwardSegment(nsIInputStream* aInStr, void* aClosure,
+                               const char* aFromSegment, uint32_t aToOffset,
+                               uint32_t aCount, uint32_t* aWriteCount) {
+  auto* forwarded = static_cast<ForwardedSegments*>(aClosure);
+  forwarded->mWriterCalled = true;
+  return forwarded->mWriter(forwarded->mStream, forwarded->mClosure,
+                            aFromSegment, aToOffset, aCount, aWriteCount);
+}
+
 NS_IMETHODIMP
 nsBufferedInputStream::ReadSegments(nsWriteSegmentFun writer, void* closure,
                                     uint32_t count, uint32_t* result) {
@@ -444,6 +486,30 @@ nsBufferedInputStream::ReadSegments(nsWriteSegmentFun writer, void* closure,
 
   nsresult rv = NS_OK;
   RecursiveMutexAutoLock lock(mBufferMutex);
+
+  // Like Read(), once the buffer has been drained, reads at least as large as
+  // it skip it: if the source has segments of its own, they are passed to the
+  // writer directly instead of being copied into the buffer first. Sources
+  // which don't implement ReadSegments() still go through the buffer.
+  if (mCursor == mFillPoint && count >= mBufferSize) {
+    ForwardedSegments forwarded{static_cast<nsIBufferedInputStream*>(this),
+                                writer, closure};
+    uint32_t read = 0;
+    rv = Source()->ReadSegments(ForwardSegment, &forwarded, count, &read);
+    if (rv != NS_ERROR_NOT_IMPLEMENTED) {
+      if (NS_FAILED(rv)) {
+        return rv;
+      }
+      mBufferStartOffset += mFillPoint + read;
+      mCursor = mFillPoint = 0;
+      if (!forwarded.mWriterCalled) {
+        mEOF = true;
+      }
+      *result = read;
+      return NS_OK;
+    }
+    rv = NS_OK;
+  }
   while (count > 0) {
     uint32_t amt = std::min(count, mFillPoint - mCursor);
     if (amt > 0) {
@@ -942,6 +1008,21 @@ nsBufferedOutputStream::Write(const char* buf, uint32_t count,
   }
 
   RecursiveMutexAutoLock lock(mBufferMutex);
+
+  // Writes at least as large as the buffer would only be copied into it to be
+  // flushed again straight away, so flush what we have and hand them to the
+  // sink directly.  Anything the sink doesn't take, including everything if
+  // it fails, goes through the buffer as usual, which reports any error.
+  if (count >= mBufferSize && mCursor == mFillPoint &&
+      NS_SUCCEEDED(Flush())) {
+    uint32_t amt = 0;
+    if (NS_SUCCEEDED(Sink()->Write(buf, count, &amt))) {
+      mBufferStartOffset += amt;
+      written = amt;
+      count -= amt;
+    }
+  }
+
   while (count > 0) {
     uint32_t amt = std::min(count, mBufferSize - mCursor);
     if (amt > 0) {
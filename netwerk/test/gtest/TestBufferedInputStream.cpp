@@ -5,6 +5,7 @@
 #include "nsIThread.h"
 #include "nsNetUtil.h"
 #include "nsStreamUtils.h"
+#include "nsStringStream.h"
 #include "nsThreadUtils.h"
 #include "Helpers.h"
 
@@ -58,6 +59,111 @@ TEST(TestBufferedInputStream, SimpleReadSegments)
   ASSERT_TRUE(nsCString(buf.get(), kBufSize).Equals(nsCString(buf2, count)));
 }
 
+// Reads at least as large as the buffer bypass it once it is empty, without
+// losing buffered data or the stream position.
+TEST(TestBufferedInputStream, LargeRead)
+{
+  const size_t kBufSize = 100;
+  const uint32_t kBufferedSize = 16;
+
+  nsCString buf;
+  buf.SetLength(kBufSize);
+  for (uint32_t i = 0; i < kBufSize; ++i) {
+    buf.BeginWriting()[i] = char(i);
+  }
+
+  nsCOMPtr<nsIInputStream> stream = new testing::AsyncStringStream(buf);
+  RefPtr<nsBufferedInputStream> bis = new nsBufferedInputStream();
+  ASSERT_EQ(NS_OK, bis->Init(stream, kBufferedSize));
+
+  // This fills the buffer and leaves most of it unread.
+  char buf2[kBufSize];
+  uint32_t count;
+  ASSERT_EQ(NS_OK, bis->Read(buf2, 5, &count));
+  ASSERT_EQ(count, 5u);
+
+  // This drains the buffer.
+  ASSERT_EQ(NS_OK, bis->Read(buf2 + 5, 11, &count));
+  ASSERT_EQ(count, 11u);
+
+  // Now the buffer is empty, so this reads straight from the source.
+  ASSERT_EQ(NS_OK, bis->Read(buf2 + 16, 50, &count));
+  ASSERT_EQ(count, 50u);
+
+  int64_t pos;
+  ASSERT_EQ(NS_OK, bis->Tell(&pos));
+  ASSERT_EQ(pos, 66);
+
+  ASSERT_EQ(NS_OK, bis->Read(buf2 + 66, 10, &count));
+  ASSERT_EQ(count, 10u);
+  ASSERT_EQ(NS_OK, bis->Read(buf2 + 76, kBufSize, &count));
+  ASSERT_EQ(count, 24u);
+  ASSERT_EQ(NS_OK, bis->Read(buf2, kBufSize, &count));
+  ASSERT_EQ(count, 0u);
+
+  ASSERT_TRUE(buf.Equals(nsDependentCSubstring(buf2, kBufSize)));
+}
+
+// Records where each segment passed to the writer came from.
+static nsresult RecordSegment(nsIInputStream* aInStr, void* aClosure,
+                              const char* aFromSegment, uint32_t aToOffset,
+                              uint32_t aCount, uint32_t* aWriteCount) {
+  static_cast<nsTArray<const char*>*>(aClosure)->AppendElement(aFromSegment);
+  *aWriteCount = aCount;
+  return NS_OK;
+}
+
+// Like reads, segment reads at least as large as the buffer bypass it once it
+// is empty, and get the source's own segments.
+TEST(TestBufferedInputStream, LargeReadSegments)
+{
+  const size_t kBufSize = 100;
+  const uint32_t kBufferedSize = 16;
+
+  nsCString buf;
+  buf.SetLength(kBufSize);
+  for (uint32_t i = 0; i < kBufSize; ++i) {
+    buf.BeginWriting()[i] = char(i);
+  }
+
+  nsCOMPtr<nsIInputStream> stream;
+  ASSERT_EQ(NS_OK, NS_NewByteInputStream(getter_AddRefs(stream),
+                                         mozilla::Span(buf.get(), kBufSize),
+                                         NS_ASSIGNMENT_DEPEND));
+  RefPtr<nsBufferedInputStream> bis = new nsBufferedInputStream();
+  ASSERT_EQ(NS_OK, bis->Init(stream, kBufferedSize));
+
+  // These fill and then drain the buffer.
+  char buf2[kBufSize];
+  uint32_t count;
+  ASSERT_EQ(NS_OK, bis->Read(buf2, 5, &count));
+  ASSERT_EQ(count, 5u);
+  nsTArray<const char*> segments;
+  ASSERT_EQ(NS_OK, bis->ReadSegments(RecordSegment, &segments, 11, &count));
+  ASSERT_EQ(count, 11u);
+  ASSERT_EQ(segments.Length(), 1u);
+  ASSERT_NE(segments[0], buf.get() + 5);
+
+  // Now the buffer is empty, so the writer sees the source's data in place.
+  segments.Clear();
+  ASSERT_EQ(NS_OK, bis->ReadSegments(RecordSegment, &segments, 50, &count));
+  ASSERT_EQ(count, 50u);
+  ASSERT_EQ(segments.Length(), 1u);
+  ASSERT_EQ(segments[0], buf.get() + 16);
+
+  int64_t pos;
+  ASSERT_EQ(NS_OK, bis->Tell(&pos));
+  ASSERT_EQ(pos, 66);
+
+  ASSERT_EQ(NS_OK, bis->ReadSegments(NS_CopySegmentToBuffer, buf2 + 66,
+                                     kBufSize, &count));
+  ASSERT_EQ(count, 34u);
+  ASSERT_TRUE(Substring(buf, 66).Equals(nsDependentCSubstring(buf2 + 66, 34)));
+  ASSERT_EQ(NS_OK, bis->ReadSegments(NS_CopySegmentToBuffer, buf2, kBufSize,
+                                     &count));
+  ASSERT_EQ(count, 0u);
+}
+
 // AsyncWait - sync
 TEST(TestBufferedInputStream, AsyncWait_sync)
 {
@@ -0,0 +1,111 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "gtest/gtest.h"
+#include "mozilla/gtest/MozAssertions.h"
+#include "nsBufferedStreams.h"
+#include "nsIOutputStream.h"
+#include "nsString.h"
+#include "nsTArray.h"
+
+namespace {
+
+// Collects everything written to it, remembering the size of each write.
+class RecordingOutputStream final : public nsIOutputStream {
+ public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+
+  NS_IMETHOD Close() override { return NS_OK; }
+  NS_IMETHOD Flush() override { return NS_OK; }
+  NS_IMETHOD StreamStatus() override { return NS_OK; }
+
+  NS_IMETHOD Write(const char* aBuf, uint32_t aCount,
+                   uint32_t* aResult) override {
+    mData.Append(aBuf, aCount);
+    mWrites.AppendElement(aCount);
+    *aResult = aCount;
+    return NS_OK;
+  }
+
+  NS_IMETHOD WriteFrom(nsIInputStream*, uint32_t, uint32_t*) override {
+    return NS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  NS_IMETHOD WriteSegments(nsReadSegmentFun, void*, uint32_t,
+                           uint32_t*) override {
+    return NS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  NS_IMETHOD IsNonBlocking(bool* aNonBlocking) override {
+    *aNonBlocking = false;
+    return NS_OK;
+  }
+
+  nsCString mData;
+  nsTArray<uint32_t> mWrites;
+
+ private:
+  ~RecordingOutputStream() = default;
+};
+
+NS_IMPL_ISUPPORTS(RecordingOutputStream, nsIOutputStream)
+
+}  // namespace
+
+// Writes at least as large as the buffer go straight to the sink after
+// whatever was already buffered, rather than being copied through the buffer.
+TEST(TestBufferedOutputStream, LargeWrite)
+{
+  const uint32_t kBufferSize = 16;
+
+  RefPtr<RecordingOutputStream> sink = new RecordingOutputStream();
+  RefPtr<nsBufferedOutputStream> bos = new nsBufferedOutputStream();
+  ASSERT_NS_SUCCEEDED(bos->Init(sink, kBufferSize));
+
+  nsCString data;
+  for (uint32_t i = 0; i < 100; ++i) {
+    data.Append(char('a' + i % 26));
+  }
+
+  uint32_t count;
+  ASSERT_NS_SUCCEEDED(bos->Write(data.get(), 5, &count));
+  ASSERT_EQ(count, 5u);
+  EXPECT_TRUE(sink->mWrites.IsEmpty());
+
+  ASSERT_NS_SUCCEEDED(bos->Write(data.get() + 5, 40, &count));
+  ASSERT_EQ(count, 40u);
+  EXPECT_EQ(sink->mWrites, (nsTArray<uint32_t>{5, 40}));
+
+  ASSERT_NS_SUCCEEDED(bos->Write(data.get() + 45, 55, &count));
+  ASSERT_EQ(count, 55u);
+  EXPECT_EQ(sink->mWrites, (nsTArray<uint32_t>{5, 40, 55}));
+
+  int64_t pos;
+  ASSERT_NS_SUCCEEDED(bos->Tell(&pos));
+  EXPECT_EQ(pos, 100);
+
+  ASSERT_NS_SUCCEEDED(bos->Close());
+  EXPECT_TRUE(sink->mData.Equals(data));
+}
+
+// Smaller writes are still buffered.
+TEST(TestBufferedOutputStream, SmallWrites)
+{
+  const uint32_t kBufferSize = 16;
+
+  RefPtr<RecordingOutputStream> sink = new RecordingOutputStream();
+  RefPtr<nsBufferedOutputStream> bos = new nsBufferedOutputStream();
+  ASSERT_NS_SUCCEEDED(bos->Init(sink, kBufferSize));
+
+  uint32_t count;
+  for (uint32_t i = 0; i < 10; ++i) {
+    ASSERT_NS_SUCCEEDED(bos->Write("abcd", 4, &count));
+    ASSERT_EQ(count, 4u);
+  }
+  ASSERT_NS_SUCCEEDED(bos->Flush());
+
+  EXPECT_EQ(sink->mWrites, (nsTArray<uint32_t>{16, 16, 8}));
+  EXPECT_EQ(sink->mData.Length(), 40u);
+}
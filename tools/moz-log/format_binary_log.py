@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+"""
+Turns a log written with MOZ_LOG=binary into the text MOZ_LOG would have
+written with the timestamp option.  See detail::BinaryLogBuffer in
+xpcom/base/Logging.cpp for the file format.
+
+Usage: format_binary_log.py LOGFILE [OUTPUT]
+"""
+
+import datetime
+import re
+import struct
+import sys
+
+MAGIC = b"MOZLOGB1"
+
+RECORD_PROCESS = 1
+RECORD_THREAD = 2
+RECORD_THREAD_NAME = 3
+RECORD_STRING = 4
+RECORD_MESSAGE = 5
+RECORD_DROPPED = 6
+
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D", 5: "V"}
+
+INT64_MIN = -(2**63)
+
+CONVERSION = re.compile(
+    r"%(?P<flags>[-+ #0']*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d*))?"
+    r"(?P<length>hh|h|ll|l|q|z|j|t|L)?(?P<type>[diouxXceEfFgGaAspn%])"
+)
+
+
+class Args:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def next(self):
+        if self.pos >= len(self.data):
+            return None
+        tag = chr(self.data[self.pos])
+        if tag == "s":
+            (length,) = struct.unpack_from("<H", self.data, self.pos + 1)
+            start = self.pos + 3
+            self.pos = start + length
+            return self.data[start : self.pos].decode("utf-8", "replace")
+        self.pos += 9
+        if tag == "d":
+            return struct.unpack_from("<d", self.data, self.pos - 8)[0]
+        return struct.unpack_from("<q", self.data, self.pos - 8)[0]
+
+
+def format_message(fmt, args):
+    def convert(match):
+        conv = match.group("type")
+        if conv == "%":
+            return "%"
+        if conv == "n":
+            return ""
+        spec = match.group("flags").replace("'", "")
+        for part, prefix in (("width", ""), ("precision", ".")):
+            value = match.group(part)
+            if value == "*":
+                value = str(args.next())
+            if value is not None:
+                spec += prefix + value
+        value = args.next()
+        if value is None:
+            return "<missing>"
+        if conv in "ouxX":
+            value &= 2**64 - 1
+        elif conv == "p":
+            return "%#{}x".format(spec) % (value & (2**64 - 1))
+        elif conv in "aA":
+            return float(value).hex()
+        elif conv == "c":
+            value = chr(value & 0xFF)
+        elif conv in "iu":
+            conv = "d"
+        return "%{}{}".format(spec, conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def format_time(epoch_us, offset_us):
+    time = datetime.datetime.fromtimestamp(
+        (epoch_us + offset_us) / 1e6, datetime.timezone.utc
+    )
+    return time.strftime("%Y-%m-%d %H:%M:%S.%f")
+
+
+def format_log(data, out):
+    strings = {}
+    thread_names = {}
+    thread = None
+    epoch_us, pid, mode = 0, 0, ""
+
+    pos = 0
+    while pos < len(data):
+        if data[pos : pos + len(MAGIC)] == MAGIC:
+            pos += len(MAGIC)
+            continue
+        kind, length = struct.unpack_from("<BI", data, pos)
+        payload = data[pos + 5 : pos + 5 + length]
+        pos += 5 + length
+
+        if kind == RECORD_PROCESS:
+            epoch_us, pid = struct.unpack_from("<qI", payload)
+            mode = payload[12:].decode("utf-8", "replace")
+        elif kind == RECORD_THREAD:
+            (thread,) = struct.unpack_from("<Q", payload)
+        elif kind == RECORD_THREAD_NAME:
+            thread_names[thread] = payload.decode("utf-8", "replace")
+        elif kind == RECORD_STRING:
+            (string_id,) = struct.unpack_from("<Q", payload)
+            strings[string_id] = payload[8:].decode("utf-8", "replace")
+        elif kind == RECORD_DROPPED:
+            (count,) = struct.unpack_from("<Q", payload)
+            out.write(
+                "[%s %d: %s]: dropped %d messages\n"
+                % (mode, pid, thread_names.get(thread, thread), count)
+            )
+        elif kind == RECORD_MESSAGE:
+            time, start, module, fmt, level = struct.unpack_from("<qqQQB", payload)
+            message = format_message(strings.get(fmt, ""), Args(payload[33:]))
+            if start != INT64_MIN:
+                prefix = "%s -> %s UTC (%.1gms)" % (
+                    format_time(epoch_us, start),
+                    format_time(epoch_us, time)[11:],
+                    (time - start) / 1000,
+                )
+            else:
+                prefix = "%s UTC" % format_time(epoch_us, time)
+            out.write(
+                "%s - [%s %d: %s]: %s/%s %s%s"
+                % (
+                    prefix,
+                    mode,
+                    pid,
+                    thread_names.get(thread, thread),
+                    LEVELS.get(level, "?"),
+                    strings.get(module, "?"),
+                    message,
+                    "" if message.endswith("\n") else "\n",
+                )
+            )
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 1
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    if not data.startswith(MAGIC):
+        sys.stderr.write("%s is not a binary MOZ_LOG file\n" % argv[1])
+        return 1
+    if len(argv) == 3:
+        with open(argv[2], "w") as out:
+            format_log(data, out)
+    else:
+        format_log(data, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
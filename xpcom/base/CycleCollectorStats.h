@@ -78,6 +78,16 @@ struct CycleCollectorStats {
   uint32_t mForgetSkippableBeforeCC = 0;
 
   uint32_t mRemovedPurples = 0;
+
+  // Time spent building the graph, scanning it and unlinking the garbage in
+  // the current CC, summed over all of its slices.
+  TimeDuration mGraphBuildTime;
+  TimeDuration mScanRootsTime;
+  TimeDuration mCollectWhiteTime;
+
+  // Number of helper threads that scanned the graph alongside the collecting
+  // thread in the current CC.
+  uint32_t mScanHelperThreads = 0;
 };
 
 }  // namespace mozilla
@@ -8,15 +8,22 @@
 
 #include "base/process_util.h"
 #include "GeckoProfiler.h"
+#include "mozilla/Casting.h"
 #include "mozilla/ClearOnShutdown.h"
+#include "mozilla/CondVar.h"
+#include "mozilla/EndianUtils.h"
 #include "mozilla/FileUtils.h"
 #include "mozilla/GeckoTrace.h"
 #include "mozilla/LateWriteChecks.h"
+#include "mozilla/MathAlgorithms.h"
 #include "mozilla/Mutex.h"
+#include "mozilla/PodOperations.h"
 #include "mozilla/StaticPtr.h"
 #include "mozilla/Printf.h"
 #include "mozilla/Atomics.h"
 #include "mozilla/Sprintf.h"
+#include "mozilla/TextUtils.h"
+#include "mozilla/TimeStamp.h"
 #include "mozilla/UniquePtrExtensions.h"
 #include "MainThreadUtils.h"
 #include "nsClassHashtable.h"
@@ -28,7 +35,13 @@
 #include "LogCommandLineHandler.h"
 #include "fmt/format.h"
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+
 #include "prenv.h"
+#include "prinrval.h"
+#include "prthread.h"
 #ifdef XP_WIN
 #  include <fcntl.h>
 #  include <process.h>
@@ -50,6 +63,12 @@ const uint32_t kInitialModuleCount = 1024;
 // (Note: When this is changed to be >= 10, SandboxBroker::LaunchApp must add
 // another rule to allow logfile.?? be written by content processes.)
 const uint32_t kRotateFilesNumber = 4;
+// How often the binary log drainer thread wakes up, depending on whether it
+// found anything to write the last time.
+const uint32_t kBinaryLogBusyDrainMs = 10;
+const uint32_t kBinaryLogIdleDrainMs = 100;
+// Stack space for the encoded arguments of a binary log message.
+const size_t kBinaryLogArgsSize = 2048;
 
 namespace mozilla {
 
@@ -107,7 +126,10 @@ class LogFile {
 
  public:
   LogFile(FILE* aFile, uint32_t aFileNum)
-      : mFile(aFile), mFileNum(aFileNum), mNextToRelease(nullptr) {}
+      : mFile(aFile),
+        mFileNum(aFileNum),
+        mNextToRelease(nullptr),
+        mHasBinaryHeader(false) {}
 
   ~LogFile() {
     fclose(mFile);
@@ -118,6 +140,8 @@ class LogFile {
   uint32_t Num() const { return mFileNum; }
 
   LogFile* mNextToRelease;
+  // Only used by the binary log drainer thread.
+  bool mHasBinaryHeader;
 };
 
 static const char* ExpandLogFileName(const char* aFilename,
@@ -290,6 +314,428 @@ bool LimitFileToLessThanSize(const char* aFilename, uint32_t aSize,
 
 }  // namespace detail
 
+namespace detail {
+
+/**
+ * Binary logging (MOZ_LOG=binary,...) replaces formatting and the file write
+ * on the logging thread with a copy of the raw arguments into a per-thread
+ * single-producer/single-consumer ring buffer.  A background thread drains
+ * the buffers into the log file, and tools/moz-log/format_binary_log.py
+ * turns that file back into the usual text output.
+ *
+ * The file starts with kBinaryLogMagic, followed by records consisting of a
+ * one byte BinaryLogRecord kind, a 32-bit payload length and the payload.
+ * All integers are little-endian.
+ *
+ *  - Process: uint64 PR_Now() of the zero timestamp, uint32 pid, then the
+ *    multiprocess mode string.  Written by the drainer whenever it starts a
+ *    new file.
+ *  - Thread: uint64 thread id.  Written by the drainer; the records that
+ *    follow it, up to the next Thread record, were logged by that thread.
+ *  - ThreadName: the name of the current thread.
+ *  - String: uint64 id, then the string.  Defines a module name or format
+ *    string id before its first use on a thread.
+ *  - Message: int64 microseconds since the zero timestamp, int64 interval
+ *    start in the same unit (INT64_MIN if none), uint64 module id, uint64
+ *    format id, uint8 log level, then the arguments as produced by
+ *    EncodeBinaryLogArgs().
+ *  - Dropped: uint64 number of messages this thread dropped because its
+ *    buffer was full.
+ *
+ * Module names and format strings are identified by their address, so
+ * format strings must be string literals, as they are for MOZ_LOG.  Binary
+ * logging doesn't add profiler markers.
+ */
+static const char kBinaryLogMagic[8] = {'M', 'O', 'Z', 'L', 'O', 'G', 'B', '1'};
+
+enum class BinaryLogRecord : uint8_t {
+  Process = 1,
+  Thread,
+  ThreadName,
+  String,
+  Message,
+  Dropped,
+};
+
+enum class BinaryLogArg : uint8_t {
+  Int = 'i',
+  Double = 'd',
+  Pointer = 'p',
+  String = 's',
+};
+
+// String arguments longer than this are truncated.
+static const size_t kMaxBinaryLogStringArg = 1024;
+
+static size_t EncodeBinaryLogValue(BinaryLogArg aType, uint64_t aValue,
+                                   uint8_t* aBuffer, size_t aLength) {
+  if (aLength < 9) {
+    return 0;
+  }
+  aBuffer[0] = static_cast<uint8_t>(aType);
+  LittleEndian::writeUint64(aBuffer + 1, aValue);
+  return 9;
+}
+
+size_t EncodeBinaryLogString(const char* aString, size_t aStringLength,
+                             uint8_t* aBuffer, size_t aLength) {
+  if (aLength < 3) {
+    return 0;
+  }
+  size_t length =
+      std::min({aStringLength, kMaxBinaryLogStringArg, aLength - 3});
+  aBuffer[0] = static_cast<uint8_t>(BinaryLogArg::String);
+  LittleEndian::writeUint16(aBuffer + 1, length);
+  memcpy(aBuffer + 3, aString, length);
+  return length + 3;
+}
+
+/**
+ * Walks the printf conversions in aFmt and appends each argument they consume
+ * to aBuffer as a BinaryLogArg tag followed by its value: a 64-bit integer
+ * (sign or zero extended according to the conversion), a double, a pointer,
+ * or a 16-bit length followed by the string contents.  Returns the number of
+ * bytes written; arguments which don't fit are left out.
+ */
+size_t EncodeBinaryLogArgs(const char* aFmt, va_list aArgs, uint8_t* aBuffer,
+                           size_t aLength) {
+  enum class Size {
+    Default,
+    Char,
+    Short,
+    Long,
+    LongLong,
+    SizeT,
+    IntMax,
+    PtrDiff,
+    LongDouble,
+  };
+  size_t written = 0;
+  auto append = [&](BinaryLogArg aType, uint64_t aValue) {
+    written += EncodeBinaryLogValue(aType, aValue, aBuffer + written,
+                                    aLength - written);
+  };
+
+  for (const char* p = aFmt; *p; ++p) {
+    if (*p != '%') {
+      continue;
+    }
+    ++p;
+    while (*p && strchr("-+ #0'", *p)) {
+      ++p;
+    }
+    // Width and precision, either of which may be taken from an int argument.
+    // The precision also limits how much of a %s argument is read, so it
+    // needn't be null-terminated.
+    if (*p == '*') {
+      append(BinaryLogArg::Int, static_cast<int64_t>(va_arg(aArgs, int)));
+      ++p;
+    }
+    while (IsAsciiDigit(*p)) {
+      ++p;
+    }
+    size_t precision = kMaxBinaryLogStringArg;
+    if (*p == '.') {
+      ++p;
+      if (*p == '*') {
+        int value = va_arg(aArgs, int);
+        append(BinaryLogArg::Int, static_cast<int64_t>(value));
+        // A negative precision is taken as if it were omitted.
+        if (value >= 0) {
+          precision = std::min(size_t(value), precision);
+        }
+        ++p;
+      } else {
+        size_t value = 0;
+        while (IsAsciiDigit(*p)) {
+          value = std::min(value * 10 + (*p - '0'), kMaxBinaryLogStringArg);
+          ++p;
+        }
+        precision = value;
+      }
+    }
+
+    Size size = Size::Default;
+    switch (*p) {
+      case 'h':
+        size = p[1] == 'h' ? Size::Char : Size::Short;
+        p += p[1] == 'h' ? 2 : 1;
+        break;
+      case 'l':
+        size = p[1] == 'l' ? Size::LongLong : Size::Long;
+        p += p[1] == 'l' ? 2 : 1;
+        break;
+      case 'q':
+        size = Size::LongLong;
+        ++p;
+        break;
+      case 'z':
+        size = Size::SizeT;
+        ++p;
+        break;
+      case 'j':
+        size = Size::IntMax;
+        ++p;
+        break;
+      case 't':
+        size = Size::PtrDiff;
+        ++p;
+        break;
+      case 'L':
+        size = Size::LongDouble;
+        ++p;
+        break;
+    }
+
+    switch (*p) {
+      case 'd':
+      case 'i': {
+        int64_t value;
+        switch (size) {
+          case Size::Long:
+            value = va_arg(aArgs, long);
+            break;
+          case Size::LongLong:
+            value = va_arg(aArgs, long long);
+            break;
+          case Size::SizeT:
+            value = va_arg(aArgs, std::make_signed_t<size_t>);
+            break;
+          case Size::IntMax:
+            value = va_arg(aArgs, intmax_t);
+            break;
+          case Size::PtrDiff:
+            value = va_arg(aArgs, ptrdiff_t);
+            break;
+          case Size::Char:
+            value = static_cast<signed char>(va_arg(aArgs, int));
+            break;
+          case Size::Short:
+            value = static_cast<short>(va_arg(aArgs, int));
+            break;
+          default:
+            value = va_arg(aArgs, int);
+            break;
+        }
+        append(BinaryLogArg::Int, static_cast<uint64_t>(value));
+        break;
+      }
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X': {
+        uint64_t value;
+        switch (size) {
+          case Size::Long:
+            value = va_arg(aArgs, unsigned long);
+            break;
+          case Size::LongLong:
+            value = va_arg(aArgs, unsigned long long);
+            break;
+          case Size::SizeT:
+            value = va_arg(aArgs, size_t);
+            break;
+          case Size::IntMax:
+            value = va_arg(aArgs, uintmax_t);
+            break;
+          case Size::PtrDiff:
+            value = static_cast<uint64_t>(va_arg(aArgs, ptrdiff_t));
+            break;
+          case Size::Char:
+            value = static_cast<unsigned char>(va_arg(aArgs, unsigned int));
+            break;
+          case Size::Short:
+            value = static_cast<unsigned short>(va_arg(aArgs, unsigned int));
+            break;
+          default:
+            value = va_arg(aArgs, unsigned int);
+            break;
+        }
+        append(BinaryLogArg::Int, value);
+        break;
+      }
+      case 'c':
+        append(BinaryLogArg::Int, static_cast<int64_t>(va_arg(aArgs, int)));
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        double value = size == Size::LongDouble
+                           ? static_cast<double>(va_arg(aArgs, long double))
+                           : va_arg(aArgs, double);
+        append(BinaryLogArg::Double, BitwiseCast<uint64_t>(value));
+        break;
+      }
+      case 'p':
+        append(BinaryLogArg::Pointer,
+               reinterpret_cast<uintptr_t>(va_arg(aArgs, void*)));
+        break;
+      case 's': {
+        const char* str;
+        if (size == Size::Long) {
+          // Wide strings are rare enough in logs to not be worth converting.
+          va_arg(aArgs, wchar_t*);
+          str = "(wide string)";
+        } else {
+          str = va_arg(aArgs, const char*);
+          if (!str) {
+            str = "(null)";
+          }
+        }
+        written += EncodeBinaryLogString(str, strnlen(str, precision),
+                                         aBuffer + written, aLength - written);
+        break;
+      }
+      case 'n':
+        va_arg(aArgs, void*);
+        break;
+      case '%':
+        break;
+      default:
+        // Unknown conversion; we can't tell what the remaining arguments are.
+        return written;
+    }
+  }
+  return written;
+}
+
+/**
+ * The ring buffer a single thread writes its binary log records to.  Only the
+ * owning thread appends (Reserve/Append/Commit) and only the drainer thread
+ * reads (Drain), so the two positions are the only shared state.
+ */
+class BinaryLogBuffer {
+ public:
+  static const size_t kCapacity = 256 * 1024;
+  static const size_t kRecordHeaderSize = 5;
+
+  BinaryLogBuffer(uint64_t aThreadId, const char* aThreadName)
+      : mThreadId(aThreadId),
+        mData(MakeUnique<uint8_t[]>(kCapacity)),
+        mWritePos(0),
+        mReadPos(0),
+        mRetired(false),
+        mPendingPos(0),
+        mDropped(0) {
+    PodArrayZero(mDefined);
+    size_t nameLength = strlen(aThreadName);
+    if (Reserve(nameLength + kRecordHeaderSize)) {
+      AppendRecordHeader(BinaryLogRecord::ThreadName, nameLength);
+      Append(aThreadName, nameLength);
+      Commit();
+    }
+  }
+
+  // Makes sure aLength bytes can be appended.  If they can't, the message is
+  // counted as dropped and false is returned.
+  bool Reserve(size_t aLength) {
+    MOZ_ASSERT(mPendingPos == mWritePos);
+    if (kCapacity - (mPendingPos - mReadPos) < aLength) {
+      ++mDropped;
+      return false;
+    }
+    return true;
+  }
+
+  void Append(const void* aData, size_t aLength) {
+    const uint8_t* data = static_cast<const uint8_t*>(aData);
+    size_t start = mPendingPos & (kCapacity - 1);
+    size_t first = std::min(aLength, kCapacity - start);
+    memcpy(mData.get() + start, data, first);
+    memcpy(mData.get(), data + first, aLength - first);
+    mPendingPos += aLength;
+  }
+
+  void AppendRecordHeader(BinaryLogRecord aKind, size_t aLength) {
+    uint8_t header[kRecordHeaderSize];
+    header[0] = static_cast<uint8_t>(aKind);
+    LittleEndian::writeUint32(header + 1, aLength);
+    Append(header, sizeof(header));
+  }
+
+  void AppendUint64(uint64_t aValue) {
+    uint8_t bytes[8];
+    LittleEndian::writeUint64(bytes, aValue);
+    Append(bytes, sizeof(bytes));
+  }
+
+  // Publishes everything appended since the last commit to the drainer.
+  void Commit() { mWritePos = mPendingPos; }
+
+  // Whether the string at aString has already been defined in this buffer.
+  // Collisions just cause a redundant definition.
+  bool IsDefined(const char* aString) const {
+    return mDefined[DefinedIndex(aString)] == aString;
+  }
+  void SetDefined(const char* aString) {
+    mDefined[DefinedIndex(aString)] = aString;
+  }
+
+  uint64_t TakeDropped() { return std::exchange(mDropped, 0); }
+  uint64_t Dropped() const { return mDropped; }
+
+  void Retire() { mRetired = true; }
+  bool IsRetired() const { return mRetired; }
+
+  // Writes the records published so far to aOut.  Returns whether there were
+  // any.
+  bool Drain(FILE* aOut) {
+    uint64_t read = mReadPos;
+    uint64_t write = mWritePos;
+    if (read == write) {
+      return false;
+    }
+
+    uint8_t header[kRecordHeaderSize + 8];
+    header[0] = static_cast<uint8_t>(BinaryLogRecord::Thread);
+    LittleEndian::writeUint32(header + 1, 8);
+    LittleEndian::writeUint64(header + kRecordHeaderSize, mThreadId);
+    fwrite(header, 1, sizeof(header), aOut);
+
+    size_t start = read & (kCapacity - 1);
+    size_t length = write - read;
+    size_t first = std::min<size_t>(length, kCapacity - start);
+    fwrite(mData.get() + start, 1, first, aOut);
+    fwrite(mData.get(), 1, length - first, aOut);
+    mReadPos = write;
+    return true;
+  }
+
+  // The next buffer in LogModuleManager's list, guarded by its lock.
+  BinaryLogBuffer* mNext = nullptr;
+
+ private:
+  static const size_t kDefinedCount = 64;
+
+  static size_t DefinedIndex(const char* aString) {
+    return (reinterpret_cast<uintptr_t>(aString) >> 2) % kDefinedCount;
+  }
+
+  const uint64_t mThreadId;
+  UniquePtr<uint8_t[]> mData;
+  // Monotonic byte positions; the buffer offset is the position modulo
+  // kCapacity.  mWritePos is only written by the owning thread and mReadPos
+  // only by the drainer.
+  Atomic<uint64_t, ReleaseAcquire> mWritePos;
+  Atomic<uint64_t, ReleaseAcquire> mReadPos;
+  // Set once the owning thread has exited.
+  Atomic<bool, ReleaseAcquire> mRetired;
+
+  // Only used by the owning thread.
+  uint64_t mPendingPos;
+  uint64_t mDropped;
+  const char* mDefined[kDefinedCount];
+};
+
+static_assert(IsPowerOfTwo(BinaryLogBuffer::kCapacity));
+
+}  // namespace detail
+
 namespace {
 // Helper method that initializes an empty va_list to be empty.
 void empty_va(va_list* va, ...) {
@@ -318,10 +764,21 @@ class LogModuleManager {
         mIsRaw(false),
         mIsSync(false),
         mRotate(0),
-        mInitialized(false) {
+        mInitialized(false),
+        mIsBinary(false),
+        mBinaryBufferIndex(0),
+        mBinaryBuffersLock("binarylogbuffers"),
+        mBinaryDrainerCondVar(mBinaryBuffersLock, "binarylogdrainer"),
+        mBinaryBuffers(nullptr),
+        mNextBinaryThreadId(0),
+        mStopBinaryDrainer(false),
+        mBinaryDrainer(nullptr),
+        mBinaryDrainerStopped(false),
+        mBinaryStartTime(0) {
   }
 
   ~LogModuleManager() {
+    StopBinaryLogDrainer();
     detail::LogFile* logFile = mOutFile.exchange(nullptr);
     delete logFile;
   }
@@ -358,6 +815,7 @@ class LogModuleManager {
     bool addTimestamp = false;
     bool isSync = false;
     bool isRaw = false;
+    bool isBinary = false;
     bool captureStacks = false;
     int32_t rotate = 0;
     int32_t maxSize = 0;
@@ -384,9 +842,10 @@ class LogModuleManager {
     // initialization is complete.
     NSPRLogModulesParser(
         modules,
-        [this, &shouldAppend, &addTimestamp, &isSync, &isRaw, &rotate, &maxSize,
-         &prependHeader, &captureStacks](const char* aName, LogLevel aLevel,
-                                         int32_t aValue) mutable {
+        [this, &shouldAppend, &addTimestamp, &isSync, &isRaw, &isBinary,
+         &rotate, &maxSize, &prependHeader,
+         &captureStacks](const char* aName, LogLevel aLevel,
+                         int32_t aValue) mutable {
           if (strcmp(aName, "append") == 0) {
             shouldAppend = true;
           } else if (strcmp(aName, "timestamp") == 0) {
@@ -395,6 +854,8 @@ class LogModuleManager {
             isSync = true;
           } else if (strcmp(aName, "raw") == 0) {
             isRaw = true;
+          } else if (strcmp(aName, "binary") == 0) {
+            isBinary = true;
           } else if (strcmp(aName, "rotate") == 0) {
             rotate = (aValue << 20) / kRotateFilesNumber;
           } else if (strcmp(aName, "maxsize") == 0) {
@@ -439,6 +900,13 @@ class LogModuleManager {
       prependHeader = false;
     }
 
+    if (isBinary && (rotate > 0 || shouldAppend || prependHeader)) {
+      NS_WARNING(
+          "MOZ_LOG: binary logs cannot be rotated, appended to or have a "
+          "header! (ignoring binary)");
+      isBinary = false;
+    }
+
     const char* logFile = PR_GetEnv("MOZ_LOG_FILE");
     if (!logFile || !logFile[0]) {
       logFile = PR_GetEnv("NSPR_LOG_FILE");
@@ -464,6 +932,15 @@ class LogModuleManager {
       mSetFromEnv = true;
     }
 
+    if (isBinary) {
+      if (!mOutFile) {
+        NS_WARNING(
+            "MOZ_LOG: binary logging needs MOZ_LOG_FILE! (ignoring binary)");
+      } else {
+        mIsBinary = StartBinaryLogging();
+      }
+    }
+
     if (prependHeader && XRE_IsParentProcess()) {
       va_list va;
       empty_va(&va);
@@ -608,6 +1085,15 @@ class LogModuleManager {
       *out = '\0';
       buffToWrite = allocatedBuff.get();
     }
+    if (mIsBinary) {
+      // We can't record {fmt} arguments without formatting them, so binary
+      // logs just get the resulting string.
+      uint8_t args[kBinaryLogArgsSize];
+      size_t argsLength = detail::EncodeBinaryLogString(
+          buffToWrite, strlen(buffToWrite), args, sizeof(args));
+      PrintBinary(aName, aLevel, aStart, "%s", args, argsLength);
+      return;
+    }
     ++charsWritten;  // + final \0
     ActuallyLog(aName, aLevel, aStart, aPrepend, buffToWrite, charsWritten);
   }
@@ -615,6 +1101,17 @@ class LogModuleManager {
   void Print(const char* aName, LogLevel aLevel, const TimeStamp* aStart,
              const char* aPrepend, const char* aFmt, va_list aArgs)
       MOZ_FORMAT_PRINTF(6, 0) {
+    if (mIsBinary) {
+      uint8_t args[kBinaryLogArgsSize];
+      va_list argsCopy;
+      va_copy(argsCopy, aArgs);
+      size_t argsLength =
+          detail::EncodeBinaryLogArgs(aFmt, argsCopy, args, sizeof(args));
+      va_end(argsCopy);
+      PrintBinary(aName, aLevel, aStart, aFmt, args, argsLength);
+      return;
+    }
+
     AutoSuspendLateWriteChecks suspendLateWriteChecks;
     const size_t kBuffSize = 1024;
     char buff[kBuffSize];
@@ -706,16 +1203,8 @@ class LogModuleManager {
     //
     // Additionally we prefix the output with the abbreviated log level
     // and the module name.
-    PRThread* currentThread = PR_GetCurrentThread();
-    const char* currentThreadName = (mMainThread == currentThread)
-                                        ? "Main Thread"
-                                        : PR_GetThreadName(currentThread);
-
     char noNameThread[40];
-    if (!currentThreadName) {
-      SprintfLiteral(noNameThread, "Unnamed thread %p", currentThread);
-      currentThreadName = noNameThread;
-    }
+    const char* currentThreadName = CurrentThreadName(noNameThread);
 
     if (!mAddTimestamp && !aStart) {
       if (!mIsRaw) {
@@ -796,6 +1285,12 @@ class LogModuleManager {
       }
     }
 
+    LeavePrint();
+  }
+
+  // Called when done with the file loaded from mOutFile after incrementing
+  // mPrintEntryCount.
+  void LeavePrint() {
     if (--mPrintEntryCount == 0 && mToReleaseFile) {
       // We were the last Print() entered, if there is a file to release
       // do it now.  exchange() is atomic and makes sure we release the file
@@ -805,6 +1300,227 @@ class LogModuleManager {
     }
   }
 
+  const char* CurrentThreadName(char (&aNoNameBuffer)[40]) {
+    PRThread* currentThread = PR_GetCurrentThread();
+    const char* currentThreadName = (mMainThread == currentThread)
+                                        ? "Main Thread"
+                                        : PR_GetThreadName(currentThread);
+    if (!currentThreadName) {
+      SprintfLiteral(aNoNameBuffer, "Unnamed thread %p", currentThread);
+      currentThreadName = aNoNameBuffer;
+    }
+    return currentThreadName;
+  }
+
+  bool StartBinaryLogging() {
+    if (PR_NewThreadPrivateIndex(&mBinaryBufferIndex, RetireBinaryLogBuffer) !=
+        PR_SUCCESS) {
+      return false;
+    }
+    mBinaryStart = TimeStamp::Now();
+    mBinaryStartTime = PR_Now();
+    mBinaryDrainer = PR_CreateThread(PR_SYSTEM_THREAD, DrainBinaryLogs, this,
+                                     PR_PRIORITY_LOW, PR_GLOBAL_THREAD,
+                                     PR_JOINABLE_THREAD, 0);
+    return !!mBinaryDrainer;
+  }
+
+  // Stops the drainer thread and writes out everything logged so far.  Binary
+  // logging keeps working afterwards, but drains synchronously like sync mode
+  // does, so nothing logged late in shutdown is lost.
+  void StopBinaryLogDrainer() {
+    if (!mBinaryDrainer) {
+      return;
+    }
+    {
+      OffTheBooksMutexAutoLock guard(mBinaryBuffersLock);
+      mStopBinaryDrainer = true;
+      mBinaryDrainerCondVar.Notify();
+    }
+    PR_JoinThread(mBinaryDrainer);
+    mBinaryDrainer = nullptr;
+    mBinaryDrainerStopped = true;
+    DrainBinaryLogBuffers();
+  }
+
+  static void RetireBinaryLogBuffer(void* aBuffer) {
+    static_cast<detail::BinaryLogBuffer*>(aBuffer)->Retire();
+  }
+
+  detail::BinaryLogBuffer* GetBinaryLogBuffer() {
+    auto* buffer = static_cast<detail::BinaryLogBuffer*>(
+        PR_GetThreadPrivate(mBinaryBufferIndex));
+    if (buffer) {
+      return buffer;
+    }
+
+    char noNameThread[40];
+    const char* name = CurrentThreadName(noNameThread);
+    {
+      OffTheBooksMutexAutoLock guard(mBinaryBuffersLock);
+      buffer = new detail::BinaryLogBuffer(mNextBinaryThreadId++, name);
+      buffer->mNext = mBinaryBuffers;
+      mBinaryBuffers = buffer;
+    }
+    PR_SetThreadPrivate(mBinaryBufferIndex, buffer);
+    return buffer;
+  }
+
+  // Appends a String record defining aString to aBuffer if it hasn't been
+  // yet, given that aLength bytes were reserved for it.
+  static void DefineBinaryLogString(detail::BinaryLogBuffer* aBuffer,
+                                    const char* aString, size_t aLength) {
+    if (!aLength) {
+      return;
+    }
+    size_t stringLength =
+        aLength - detail::BinaryLogBuffer::kRecordHeaderSize - 8;
+    aBuffer->AppendRecordHeader(detail::BinaryLogRecord::String,
+                                8 + stringLength);
+    aBuffer->AppendUint64(reinterpret_cast<uintptr_t>(aString));
+    aBuffer->Append(aString, stringLength);
+    aBuffer->SetDefined(aString);
+  }
+
+  // The number of bytes DefineBinaryLogString needs.
+  static size_t BinaryLogStringSize(detail::BinaryLogBuffer* aBuffer,
+                                    const char* aString) {
+    if (aBuffer->IsDefined(aString)) {
+      return 0;
+    }
+    return detail::BinaryLogBuffer::kRecordHeaderSize + 8 + strlen(aString);
+  }
+
+  void PrintBinary(const char* aName, LogLevel aLevel, const TimeStamp* aStart,
+                   const char* aFmt, const uint8_t* aArgs,
+                   size_t aArgsLength) {
+    using detail::BinaryLogBuffer;
+    using detail::BinaryLogRecord;
+
+    BinaryLogBuffer* buffer = GetBinaryLogBuffer();
+    int64_t time = static_cast<int64_t>(
+        (TimeStamp::Now() - mBinaryStart).ToMicroseconds());
+    int64_t start =
+        aStart ? static_cast<int64_t>((*aStart - mBinaryStart).ToMicroseconds())
+               : std::numeric_limits<int64_t>::min();
+
+    const size_t droppedSize =
+        buffer->Dropped() ? BinaryLogBuffer::kRecordHeaderSize + 8 : 0;
+    const size_t moduleSize = BinaryLogStringSize(buffer, aName);
+    const size_t formatSize = BinaryLogStringSize(buffer, aFmt);
+    const size_t messageSize = 4 * 8 + 1 + aArgsLength;
+    if (!buffer->Reserve(droppedSize + moduleSize + formatSize +
+                         BinaryLogBuffer::kRecordHeaderSize + messageSize)) {
+      return;
+    }
+
+    if (droppedSize) {
+      buffer->AppendRecordHeader(BinaryLogRecord::Dropped, 8);
+      buffer->AppendUint64(buffer->TakeDropped());
+    }
+    DefineBinaryLogString(buffer, aName, moduleSize);
+    DefineBinaryLogString(buffer, aFmt, formatSize);
+    buffer->AppendRecordHeader(BinaryLogRecord::Message, messageSize);
+    buffer->AppendUint64(static_cast<uint64_t>(time));
+    buffer->AppendUint64(static_cast<uint64_t>(start));
+    buffer->AppendUint64(reinterpret_cast<uintptr_t>(aName));
+    buffer->AppendUint64(reinterpret_cast<uintptr_t>(aFmt));
+    uint8_t level = static_cast<uint8_t>(aLevel);
+    buffer->Append(&level, 1);
+    buffer->Append(aArgs, aArgsLength);
+    buffer->Commit();
+
+    if (mIsSync || mBinaryDrainerStopped) {
+      DrainBinaryLogBuffers();
+    }
+  }
+
+  static void DrainBinaryLogs(void* aManager) {
+    PR_SetCurrentThreadName("MOZ_LOG Drainer");
+    auto* manager = static_cast<LogModuleManager*>(aManager);
+    bool busy = false;
+    while (true) {
+      {
+        OffTheBooksMutexAutoLock guard(manager->mBinaryBuffersLock);
+        if (!manager->mStopBinaryDrainer) {
+          manager->mBinaryDrainerCondVar.Wait(TimeDuration::FromMilliseconds(
+              busy ? kBinaryLogBusyDrainMs : kBinaryLogIdleDrainMs));
+        }
+        if (manager->mStopBinaryDrainer) {
+          // StopBinaryLogDrainer() does the final drain.
+          return;
+        }
+      }
+      busy = manager->DrainBinaryLogBuffers();
+    }
+  }
+
+  void WriteBinaryLogHeader(FILE* aOut) {
+    const char* mode = nsDebugImpl::GetMultiprocessMode();
+    size_t modeLength = strlen(mode);
+    uint8_t record[detail::BinaryLogBuffer::kRecordHeaderSize + 12];
+    record[0] = static_cast<uint8_t>(detail::BinaryLogRecord::Process);
+    LittleEndian::writeUint32(record + 1, 12 + modeLength);
+    LittleEndian::writeUint64(record + 5, mBinaryStartTime);
+    LittleEndian::writeUint32(record + 13, base::GetCurrentProcId());
+    fwrite(detail::kBinaryLogMagic, 1, sizeof(detail::kBinaryLogMagic), aOut);
+    fwrite(record, 1, sizeof(record), aOut);
+    fwrite(mode, 1, modeLength, aOut);
+  }
+
+  // Writes out everything the logging threads have recorded so far and frees
+  // the buffers of threads which have exited.  Returns whether there was
+  // anything to write.
+  bool DrainBinaryLogBuffers() {
+    AutoSuspendLateWriteChecks suspendLateWriteChecks;
+    bool drained = false;
+
+    ++mPrintEntryCount;
+    detail::LogFile* outFile = mOutFile;
+    if (outFile) {
+      FILE* out = outFile->File();
+      if (!outFile->mHasBinaryHeader) {
+        WriteBinaryLogHeader(out);
+        outFile->mHasBinaryHeader = true;
+      }
+
+      OffTheBooksMutexAutoLock guard(mBinaryBuffersLock);
+      detail::BinaryLogBuffer** link = &mBinaryBuffers;
+      while (detail::BinaryLogBuffer* buffer = *link) {
+        // Check this before draining, so that we have everything the thread
+        // wrote before it exited.
+        bool retired = buffer->IsRetired();
+        drained |= buffer->Drain(out);
+        if (retired) {
+          *link = buffer->mNext;
+          delete buffer;
+        } else {
+          link = &buffer->mNext;
+        }
+      }
+      fflush(out);
+    }
+    LeavePrint();
+
+    return drained;
+  }
+
+  // Sets up binary logging to aFilename on a manager which wasn't Init()ed,
+  // see detail::StartBinaryLogForTesting.
+  bool InitBinaryForTesting(const char* aFilename, bool aIsSync) {
+    mOutFilePath.reset(strdup(aFilename));
+    mOutFile = OpenFile(false, 0);
+    mIsSync = aIsSync;
+    mIsBinary = mOutFile && StartBinaryLogging();
+    return mIsBinary;
+  }
+
+  // Retires the current thread's binary log buffer, so that the next drain
+  // frees it.
+  void RetireCurrentThreadBinaryLogBuffer() {
+    PR_SetThreadPrivate(mBinaryBufferIndex, nullptr);
+  }
+
   void DisableModules() {
     OffTheBooksMutexAutoLock guard(mModulesLock);
     for (auto& m : mModules) {
@@ -846,10 +1562,53 @@ class LogModuleManager {
   Atomic<bool, Relaxed> mIsSync;
   int32_t mRotate;
   bool mInitialized;
+
+  // Binary logging state, see detail::BinaryLogBuffer.
+  bool mIsBinary;
+  PRUintn mBinaryBufferIndex;
+  OffTheBooksMutex mBinaryBuffersLock;
+  OffTheBooksCondVar mBinaryDrainerCondVar;
+  detail::BinaryLogBuffer* mBinaryBuffers MOZ_GUARDED_BY(mBinaryBuffersLock);
+  uint64_t mNextBinaryThreadId MOZ_GUARDED_BY(mBinaryBuffersLock);
+  bool mStopBinaryDrainer MOZ_GUARDED_BY(mBinaryBuffersLock);
+  // Only used on the thread which started or stops binary logging.
+  PRThread* mBinaryDrainer;
+  Atomic<bool, Relaxed> mBinaryDrainerStopped;
+  TimeStamp mBinaryStart;
+  PRTime mBinaryStartTime;
 };
 
 StaticAutoPtr<LogModuleManager> sLogModuleManager;
 
+namespace detail {
+
+// Test hooks for binary logging, see TestLogging.cpp.  These use a
+// LogModuleManager of their own so that they don't affect the process's
+// logging.
+LogModuleManager* StartBinaryLogForTesting(const char* aFilename,
+                                           bool aIsSync) {
+  auto mgr = MakeUnique<LogModuleManager>();
+  if (!mgr->InitBinaryForTesting(aFilename, aIsSync)) {
+    return nullptr;
+  }
+  return mgr.release();
+}
+
+void PrintBinaryLogForTesting(LogModuleManager* aManager, const char* aName,
+                              const char* aFmt, ...) {
+  va_list args;
+  va_start(args, aFmt);
+  aManager->Print(aName, LogLevel::Info, aFmt, args);
+  va_end(args);
+}
+
+void StopBinaryLogForTesting(LogModuleManager* aManager) {
+  aManager->RetireCurrentThreadBinaryLogBuffer();
+  delete aManager;
+}
+
+}  // namespace detail
+
 LogModule* LogModule::Get(const char* aName) {
   // This is just a pass through to the LogModuleManager so
   // that the LogModuleManager implementation can be kept internal.
@@ -881,6 +1640,12 @@ void LogModule::SetCaptureStacks(bool aCaptureStacks) {
 
 void LogModule::DisableModules() { sLogModuleManager->DisableModules(); }
 
+void LogModule::Shutdown() {
+  if (sLogModuleManager) {
+    sLogModuleManager->StopBinaryLogDrainer();
+  }
+}
+
 // This function is defined in gecko_logger/src/lib.rs
 // We mirror the level in rust code so we don't get forwarded all of the
 // rust logging and have to create an LogModule for each rust component.
@@ -90,6 +90,13 @@ class LogModule {
    */
   static void DisableModules();
 
+  /**
+   * Writes out any log messages which are still buffered and stops the
+   * background thread used by binary logging.  Logging keeps working
+   * afterwards, but writes each message out immediately.
+   */
+  static void Shutdown();
+
   /**
    * Indicates whether or not the given log level is enabled.
    */
@@ -151,12 +151,14 @@
 
 #include "base/process_util.h"
 
+#include "mozilla/AppShutdown.h"
 #include "mozilla/ArrayUtils.h"
 #include "mozilla/AutoRestore.h"
 #include "mozilla/CycleCollectedJSContext.h"
 #include "mozilla/CycleCollectedJSRuntime.h"
 #include "mozilla/CycleCollectorStats.h"
 #include "mozilla/DebugOnly.h"
+#include "mozilla/FunctionRef.h"
 #include "mozilla/HashFunctions.h"
 #include "mozilla/HashTable.h"
 #include "mozilla/HoldDropJSObjects.h"
@@ -172,11 +174,14 @@
 #include "mozilla/Likely.h"
 #include "mozilla/LinkedList.h"
 #include "mozilla/MemoryReporting.h"
+#include "mozilla/Monitor.h"
 #include "mozilla/MruCache.h"
 #include "mozilla/PoisonIOInterposer.h"
+#include "mozilla/Preferences.h"
 #include "mozilla/ProfilerLabels.h"
 #include "mozilla/ProfilerMarkers.h"
 #include "mozilla/SegmentedVector.h"
+#include "mozilla/TaskController.h"
 #include "mozilla/glean/XpcomMetrics.h"
 #include "mozilla/ThreadLocal.h"
 #include "mozilla/UniquePtr.h"
@@ -786,6 +791,26 @@ class NodePool {
     return n;
   }
 
+  uint32_t NumBlocks() const {
+    uint32_t n = 0;
+    for (NodeBlock* b = mBlocks; b; b = b->mNext) {
+      n++;
+    }
+    return n;
+  }
+
+  using NodeRange = std::pair<PtrInfo*, PtrInfo*>;
+
+  // Append the [begin, end) range of nodes held by each block to aRanges, so
+  // that the nodes can be divided up between threads. The pool must not be
+  // added to while the ranges are in use.
+  void GetBlockRanges(nsTArray<NodeRange>& aRanges) const {
+    for (NodeBlock* b = mBlocks; b; b = b->mNext) {
+      PtrInfo* end = b->mNext ? b->mEntries + NodeBlockSize : mLast;
+      aRanges.AppendElement(NodeRange(b->mEntries, end));
+    }
+  }
+
  private:
   NodeBlock* mBlocks;
   PtrInfo* mLast;
@@ -1237,7 +1262,7 @@ class nsCycleCollector : public nsIMemoryReporter {
   void MarkRoots(SliceBudget& aBudget);
   void ScanRoots(bool aFullySynchGraphBuild);
   void ScanIncrementalRoots();
-  void ScanWhiteNodes(bool aFullySynchGraphBuild);
+  void ScanWhiteNodes(bool aFullySynchGraphBuild, uint32_t aHelperThreads);
   void ScanBlackNodes();
   void ScanWeakMaps();
 
@@ -2872,6 +2897,139 @@ MOZ_NEVER_INLINE void nsCycleCollector::MarkRoots(SliceBudget& aBudget) {
   timeLog.Checkpoint("MarkRoots()");
 }
 
+////////////////////////////////////////////////////////////////////////
+// Helper threads for scanning
+////////////////////////////////////////////////////////////////////////
+
+// Once the graph has been built its shape doesn't change, so passes over it
+// that only read the graph or write to the node being visited can be split
+// between the collecting thread and TaskController pool threads. Currently
+// that is only done for ScanWhiteNodes, and only for main thread collections
+// of large graphs. ScanWhiteNodes is a cheap pass, so it is not yet clear that
+// the work saved outweighs the cost of waking the helpers; this is off unless
+// kParallelScanPref is set.
+static const char kParallelScanPref[] = "cycle_collector.parallel_scan";
+
+// The minimum number of NodePool blocks (of ~4K nodes each) in a graph before
+// any helper threads are used.
+static const uint32_t kMinBlocksForParallelScan = 4;
+
+// The maximum number of helper threads used, in addition to the collecting
+// thread.
+static const uint32_t kMaxScanHelperThreads = 7;
+
+// The number of helper threads used by the last ScanRoots, for tests.
+static Atomic<uint32_t, Relaxed> sLastScanHelperThreads(0);
+
+// Work items are claimed one at a time from mNext by the collecting thread and
+// by any helper that starts running before they are all gone. A helper task
+// may not start until the collecting thread has moved on, so the state is
+// refcounted, and mFunc is only called by helpers the collecting thread knows
+// about and waits for.
+class ParallelScanState final {
+ public:
+  NS_INLINE_DECL_THREADSAFE_REFCOUNTING(ParallelScanState)
+
+  ParallelScanState(uint32_t aCount, FunctionRef<void(uint32_t)> aFunc)
+      : mMonitor("ParallelScanState::mMonitor"), mFunc(aFunc), mCount(aCount) {}
+
+  void RunOnHelperThread() {
+    {
+      MonitorAutoLock lock(mMonitor);
+      if (mClosed) {
+        return;
+      }
+      mActiveHelpers++;
+    }
+
+    RunWorkItems();
+
+    MonitorAutoLock lock(mMonitor);
+    if (--mActiveHelpers == 0 && mClosed) {
+      lock.NotifyAll();
+    }
+  }
+
+  void RunOnCollectorThreadAndWait() {
+    RunWorkItems();
+
+    MonitorAutoLock lock(mMonitor);
+    mClosed = true;
+    while (mActiveHelpers) {
+      lock.Wait();
+    }
+  }
+
+ private:
+  ~ParallelScanState() = default;
+
+  void RunWorkItems() {
+    for (uint32_t i = mNext++; i < mCount; i = mNext++) {
+      mFunc(i);
+    }
+  }
+
+  Monitor mMonitor;
+  uint32_t mActiveHelpers MOZ_GUARDED_BY(mMonitor) = 0;
+  bool mClosed MOZ_GUARDED_BY(mMonitor) = false;
+  Atomic<uint32_t> mNext{0};
+  const FunctionRef<void(uint32_t)> mFunc;
+  const uint32_t mCount;
+};
+
+class ParallelScanTask final : public Task {
+ public:
+  explicit ParallelScanTask(ParallelScanState* aState)
+      : Task(Kind::OffMainThreadOnly, EventQueuePriority::RenderBlocking),
+        mState(aState) {}
+
+  TaskResult Run() override {
+    mState->RunOnHelperThread();
+    return TaskResult::Complete;
+  }
+
+#ifdef MOZ_COLLECTING_RUNNABLE_TELEMETRY
+  bool GetName(nsACString& aName) override {
+    aName.AssignLiteral("CycleCollectorScanTask");
+    return true;
+  }
+#endif
+
+ private:
+  RefPtr<ParallelScanState> mState;
+};
+
+// Call aFunc for every index in [0, aCount), on the current thread and on up
+// to aHelperThreads helper threads. Returns once all the calls are done.
+static void ParallelScan(uint32_t aCount, uint32_t aHelperThreads,
+                         FunctionRef<void(uint32_t)> aFunc) {
+  if (!aCount) {
+    return;
+  }
+
+  auto state = MakeRefPtr<ParallelScanState>(aCount, aFunc);
+  uint32_t helpers = std::min(aHelperThreads, aCount - 1);
+  for (uint32_t i = 0; i < helpers; i++) {
+    TaskController::Get()->AddTask(MakeAndAddRef<ParallelScanTask>(state));
+  }
+  state->RunOnCollectorThreadAndWait();
+}
+
+// Decide how many helper threads to use for a graph of aNumBlocks blocks.
+static uint32_t ScanHelperThreadCount(uint32_t aNumBlocks) {
+  if (!NS_IsMainThread() || aNumBlocks < kMinBlocksForParallelScan ||
+      !Preferences::GetBool(kParallelScanPref, false) ||
+      AppShutdown::IsInOrBeyond(ShutdownPhase::XPCOMShutdownThreads)) {
+    return 0;
+  }
+
+  int32_t poolThreads = TaskController::GetPoolThreadCount();
+  if (poolThreads <= 0) {
+    return 0;
+  }
+  return std::min(uint32_t(poolThreads), kMaxScanHelperThreads);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Bacon & Rajan's |ScanRoots| routine.
 ////////////////////////////////////////////////////////////////////////
@@ -3075,42 +3233,70 @@ void nsCycleCollector::ScanIncrementalRoots() {
   NS_ASSERTION(!failed, "Ran out of memory in ScanIncrementalRoots");
 }
 
+// Mark aPi white if its refcount is accounted for by the graph, and make sure
+// its refcount is ok. Returns whether aPi was marked white. This only touches
+// aPi, so different nodes can be scanned on different threads.
+static MOZ_ALWAYS_INLINE bool ScanWhiteNode(PtrInfo* aPi,
+                                            bool aFullySynchGraphBuild) {
+  if (aPi->mColor == black) {
+    // Incremental roots can be in a nonsensical state, so don't
+    // check them. This will miss checking nodes that are merely
+    // reachable from incremental roots.
+    MOZ_ASSERT(!aFullySynchGraphBuild,
+               "In a synch CC, no nodes should be marked black early on.");
+    return false;
+  }
+  MOZ_ASSERT(aPi->mColor == grey);
+
+  if (!aPi->WasTraversed()) {
+    // This node was deleted before it was traversed, so there's no reason
+    // to look at it.
+    MOZ_ASSERT(!aPi->mParticipant, "Live nodes should all have been traversed");
+    return false;
+  }
+
+  if (aPi->mInternalRefs == aPi->mRefCount || aPi->IsGrayJS()) {
+    aPi->mColor = white;
+    return true;
+  }
+
+  aPi->AnnotatedReleaseAssert(aPi->mInternalRefs <= aPi->mRefCount,
+                              "More references to an object than its refcount");
+
+  // This node will get marked black in the next pass.
+  return false;
+}
+
 // Mark nodes white and make sure their refcounts are ok.
 // No nodes are marked black during this pass to ensure that refcount
 // checking is run on all nodes not marked black by ScanIncrementalRoots.
-void nsCycleCollector::ScanWhiteNodes(bool aFullySynchGraphBuild) {
+void nsCycleCollector::ScanWhiteNodes(bool aFullySynchGraphBuild,
+                                      uint32_t aHelperThreads) {
+  if (aHelperThreads) {
+    nsTArray<NodePool::NodeRange> blocks;
+    mGraph.mNodes.GetBlockRanges(blocks);
+
+    Atomic<uint32_t> whiteNodeCount(0);
+    ParallelScan(blocks.Length(), aHelperThreads, [&](uint32_t aBlock) {
+      uint32_t count = 0;
+      for (PtrInfo* pi = blocks[aBlock].first; pi != blocks[aBlock].second;
+           ++pi) {
+        if (ScanWhiteNode(pi, aFullySynchGraphBuild)) {
+          ++count;
+        }
+      }
+      whiteNodeCount += count;
+    });
+    mWhiteNodeCount += whiteNodeCount;
+    return;
+  }
+
   NodePool::Enumerator nodeEnum(mGraph.mNodes);
   while (!nodeEnum.IsDone()) {
     PtrInfo* pi = nodeEnum.GetNext();
-    if (pi->mColor == black) {
-      // Incremental roots can be in a nonsensical state, so don't
-      // check them. This will miss checking nodes that are merely
-      // reachable from incremental roots.
-      MOZ_ASSERT(!aFullySynchGraphBuild,
-                 "In a synch CC, no nodes should be marked black early on.");
-      continue;
-    }
-    MOZ_ASSERT(pi->mColor == grey);
-
-    if (!pi->WasTraversed()) {
-      // This node was deleted before it was traversed, so there's no reason
-      // to look at it.
-      MOZ_ASSERT(!pi->mParticipant,
-                 "Live nodes should all have been traversed");
-      continue;
-    }
-
-    if (pi->mInternalRefs == pi->mRefCount || pi->IsGrayJS()) {
-      pi->mColor = white;
+    if (ScanWhiteNode(pi, aFullySynchGraphBuild)) {
       ++mWhiteNodeCount;
-      continue;
     }
-
-    pi->AnnotatedReleaseAssert(
-        pi->mInternalRefs <= pi->mRefCount,
-        "More references to an object than its refcount");
-
-    // This node will get marked black in the next pass.
   }
 }
 
@@ -3140,12 +3326,16 @@ void nsCycleCollector::ScanRoots(bool aFullySynchGraphBuild) {
 
   JS::AutoEnterCycleCollection autocc(Runtime()->Runtime());
 
+  uint32_t helperThreads = ScanHelperThreadCount(mGraph.mNodes.NumBlocks());
+  sCollectorData.get()->mStats->mScanHelperThreads = helperThreads;
+  sLastScanHelperThreads = helperThreads;
+
   if (!aFullySynchGraphBuild) {
     ScanIncrementalRoots();
   }
 
   TimeLog timeLog;
-  ScanWhiteNodes(aFullySynchGraphBuild);
+  ScanWhiteNodes(aFullySynchGraphBuild, helperThreads);
   timeLog.Checkpoint("ScanRoots::ScanWhiteNodes");
 
   ScanBlackNodes();
@@ -3623,6 +3813,7 @@ bool nsCycleCollector::Collect(CCReason aReason, ccIsManual aIsManual,
 
   bool startedIdle = IsIdle();
   bool collectedAny = false;
+  CycleCollectorStats* stats = sCollectorData.get()->mStats.get();
 
   // If the CC started idle, it will call BeginCollection, which
   // will do FreeSnowWhite, so it doesn't need to be done here.
@@ -3649,9 +3840,11 @@ bool nsCycleCollector::Collect(CCReason aReason, ccIsManual aIsManual,
         PrintPhase("BeginCollection");
         BeginCollection(aReason, aIsManual, aManualListener);
         break;
-      case GraphBuildingPhase:
+      case GraphBuildingPhase: {
         PrintPhase("MarkRoots");
+        TimeStamp start = TimeStamp::Now();
         MarkRoots(aBudget);
+        stats->mGraphBuildTime += TimeStamp::Now() - start;
 
         // Only continue this slice if we're running synchronously or the
         // next phase will probably be short, to reduce the max pause for this
@@ -3662,6 +3855,7 @@ bool nsCycleCollector::Collect(CCReason aReason, ccIsManual aIsManual,
         continueSlice = aBudget.isUnlimited() ||
                         (mResults.mNumSlices < 3 && !aPreferShorterSlices);
         break;
+      }
       case ScanAndCollectWhitePhase:
         // We do ScanRoots and CollectWhite in a single slice to ensure
         // that we won't unlink a live object if a weak reference is
@@ -3670,12 +3864,16 @@ bool nsCycleCollector::Collect(CCReason aReason, ccIsManual aIsManual,
         {
           AUTO_PROFILER_LABEL_CATEGORY_PAIR(GCCC_ScanRoots);
           PrintPhase("ScanRoots");
+          TimeStamp start = TimeStamp::Now();
           ScanRoots(startedIdle);
+          stats->mScanRootsTime += TimeStamp::Now() - start;
         }
         {
           AUTO_PROFILER_LABEL_CATEGORY_PAIR(GCCC_CollectWhite);
           PrintPhase("CollectWhite");
+          TimeStamp start = TimeStamp::Now();
           collectedAny = CollectWhite();
+          stats->mCollectWhiteTime += TimeStamp::Now() - start;
         }
         break;
       case CleanupPhase:
@@ -4081,6 +4279,10 @@ uint32_t nsCycleCollector_suspectedCount() {
   return data->mCollector->SuspectedCount();
 }
 
+uint32_t nsCycleCollector_lastScanHelperThreadsForTesting() {
+  return sLastScanHelperThreads;
+}
+
 bool nsCycleCollector_init() {
 #ifdef DEBUG
   static bool sInitialized;
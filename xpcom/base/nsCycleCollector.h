@@ -66,6 +66,9 @@ void nsCycleCollector_collectSlice(JS::SliceBudget& budget,
 
 uint32_t nsCycleCollector_suspectedCount();
 
+// The number of helper threads that scanned the graph in the last collection.
+uint32_t nsCycleCollector_lastScanHelperThreadsForTesting();
+
 // If aDoCollect is true, then run the GC and CC a few times before
 // shutting down the CC completely.
 MOZ_CAN_RUN_SCRIPT
@@ -1823,7 +1823,9 @@ nsMemoryReporterManager::nsMemoryReporterManager()
       mSavedWeakReporters(nullptr),
       mNextGeneration(1),
       mPendingProcessesState(nullptr),
-      mPendingReportersState(nullptr)
+      mPendingReportersState(nullptr),
+      mHeapClassifiedFraction(-1),
+      mSampledReportsSinceFullReport(0)
 #ifdef HAVE_JEMALLOC_STATS
       ,
       mThreadPool(do_GetService(NS_STREAMTRANSPORTSERVICE_CONTRACTID))
@@ -2020,6 +2022,13 @@ void nsMemoryReporterManager::DispatchReporter(
     bool aAnonymize) {
   MOZ_ASSERT(mPendingReportersState);
 
+  if (mPendingReportersState->mIncremental) {
+    mPendingReportersState->mQueuedReporters.AppendElement(
+        PendingReportersState::QueuedReporter{aReporter, aIsAsync});
+    mPendingReportersState->mReportsPending++;
+    return;
+  }
+
   // Grab refs to everything used in the lambda function.
   RefPtr<nsMemoryReporterManager> self = this;
   nsCOMPtr<nsIMemoryReporter> reporter = aReporter;
@@ -2039,6 +2048,116 @@ void nsMemoryReporterManager::DispatchReporter(
   mPendingReportersState->mReportsPending++;
 }
 
+void nsMemoryReporterManager::DispatchNextQueuedReporter() {
+  PendingReportersState* s = mPendingReportersState;
+  MOZ_ASSERT(s && s->mIncremental);
+  if (s->mNextQueuedReporter == s->mQueuedReporters.Length()) {
+    return;
+  }
+
+  PendingReportersState::QueuedReporter& next =
+      s->mQueuedReporters[s->mNextQueuedReporter++];
+  RefPtr<nsMemoryReporterManager> self = this;
+  nsCOMPtr<nsIMemoryReporter> reporter = std::move(next.mReporter);
+  bool isAsync = next.mIsAsync;
+
+  nsCOMPtr<nsIRunnable> event = NS_NewRunnableFunction(
+      "nsMemoryReporterManager::DispatchNextQueuedReporter",
+      [self, reporter, isAsync]() {
+        PendingReportersState* s = self->mPendingReportersState;
+        reporter->CollectReports(s->mHandleReport, s->mHandleReportData,
+                                 s->mAnonymize);
+        // Queue the next reporter before EndReport() can finish the report.
+        self->DispatchNextQueuedReporter();
+        if (!isAsync) {
+          self->EndReport();
+        }
+      });
+
+  NS_DispatchToCurrentThreadQueue(event.forget(), kIncrementalReporterTimeoutMS,
+                                  EventQueuePriority::Idle);
+}
+
+// Forwards reports while adding up how much of the heap they account for, so
+// that sampled reports can extrapolate from it.
+class nsMemoryReporterManager::HeapClassificationCounter final
+    : public nsIHandleReportCallback {
+ public:
+  NS_DECL_ISUPPORTS
+
+  explicit HeapClassificationCounter(nsIHandleReportCallback* aHandleReport)
+      : mHandleReport(aHandleReport) {}
+
+  NS_IMETHOD Callback(const nsACString& aProcess, const nsACString& aPath,
+                      int32_t aKind, int32_t aUnits, int64_t aAmount,
+                      const nsACString& aDescription,
+                      nsISupports* aData) override {
+    if (aKind == nsIMemoryReporter::KIND_HEAP &&
+        StringBeginsWith(aPath, "explicit/"_ns)) {
+      mClassified += aAmount;
+    } else if (aPath.EqualsLiteral("heap-allocated")) {
+      mHeapAllocated = aAmount;
+    }
+    return mHandleReport->Callback(aProcess, aPath, aKind, aUnits, aAmount,
+                                   aDescription, aData);
+  }
+
+  // The fraction of heap-allocated that was classified, or a negative value
+  // if heap-allocated wasn't reported.
+  double ClassifiedFraction() const {
+    if (mHeapAllocated <= 0) {
+      return -1;
+    }
+    return std::min(1.0, double(mClassified) / double(mHeapAllocated));
+  }
+
+ private:
+  ~HeapClassificationCounter() = default;
+
+  nsCOMPtr<nsIHandleReportCallback> mHandleReport;
+  int64_t mClassified = 0;
+  int64_t mHeapAllocated = 0;
+};
+
+NS_IMPL_ISUPPORTS(nsMemoryReporterManager::HeapClassificationCounter,
+                  nsIHandleReportCallback)
+
+#ifdef HAVE_JEMALLOC_STATS
+// Stands in for all the reporters which aren't eternal in sampled reports.
+class SampledHeapReporter final : public nsIMemoryReporter {
+  ~SampledHeapReporter() = default;
+
+ public:
+  NS_DECL_ISUPPORTS
+
+  explicit SampledHeapReporter(double aClassifiedFraction)
+      : mClassifiedFraction(aClassifiedFraction) {}
+
+  NS_IMETHOD CollectReports(nsIHandleReportCallback* aHandleReport,
+                            nsISupports* aData, bool aAnonymize) override {
+    jemalloc_stats_t stats;
+    jemalloc_stats(&stats);
+    int64_t classified = static_cast<int64_t>(
+        double(nsMemoryReporterManager::HeapAllocated(stats)) *
+        mClassifiedFraction);
+
+    MOZ_COLLECT_REPORT(
+        "explicit/heap-classified-estimate", KIND_HEAP, UNITS_BYTES,
+        classified,
+        "An estimate of the heap memory measured by the memory reporters that "
+        "were skipped because memory.report_sampled is set. It is the fraction "
+        "of 'heap-allocated' they measured in the last full report, applied "
+        "to the current 'heap-allocated'.");
+
+    return NS_OK;
+  }
+
+ private:
+  const double mClassifiedFraction;
+};
+NS_IMPL_ISUPPORTS(SampledHeapReporter, nsIMemoryReporter)
+#endif
+
 NS_IMETHODIMP
 nsMemoryReporterManager::GetReportsForThisProcessExtended(
     nsIHandleReportCallback* aHandleReport, nsISupports* aHandleReportData,
@@ -2069,6 +2188,48 @@ nsMemoryReporterManager::GetReportsForThisProcessExtended(
   mPendingReportersState = new PendingReportersState(
       aFinishReporting, aFinishReportingData, aDMDFile);
 
+  // Sampled reports only run the eternal reporters, which measure the process
+  // as a whole, and estimate what the others would have measured from the
+  // last full report. That estimate drifts as the process changes, so every
+  // so often a full report is run again to refresh it.
+  bool sampled = false;
+  nsCOMPtr<nsIHandleReportCallback> handleReport = aHandleReport;
+#ifdef HAVE_JEMALLOC_STATS
+  if (Preferences::GetBool("memory.report_sampled", false) && !aDMDFile) {
+    if (mHeapClassifiedFraction >= 0 &&
+        mSampledReportsSinceFullReport < kSampledReportsPerFullReport &&
+        (TimeStamp::Now() - mLastFullReportTime).ToSeconds() <
+            kSampledReportMaxAgeS) {
+      sampled = true;
+      mSampledReportsSinceFullReport++;
+    } else {
+      mPendingReportersState->mHeapCounter =
+          new HeapClassificationCounter(aHandleReport);
+      handleReport = mPendingReportersState->mHeapCounter;
+    }
+  }
+#endif
+
+  // Incremental reports run one reporter per idle task instead of running
+  // them all back to back.
+  mPendingReportersState->mIncremental =
+      Preferences::GetBool("memory.report_incremental", false);
+  mPendingReportersState->mHandleReport = handleReport;
+  mPendingReportersState->mHandleReportData = aHandleReportData;
+  mPendingReportersState->mAnonymize = aAnonymize;
+
+  // In incremental mode, the eternal reporters are collected here and run
+  // synchronously below instead of being spread out with the others.
+  nsTArray<nsCOMPtr<nsIMemoryReporter>> eternalReporters;
+  auto dispatchEternalReporter = [&](nsIMemoryReporter* aReporter) {
+    if (mPendingReportersState->mIncremental) {
+      eternalReporters.AppendElement(aReporter);
+    } else {
+      DispatchReporter(aReporter, false, handleReport, aHandleReportData,
+                       aAnonymize);
+    }
+  };
+
   {
     mozilla::MutexAutoLock autoLock(mMutex);
 
@@ -2076,27 +2237,49 @@ nsMemoryReporterManager::GetReportsForThisProcessExtended(
     // them measuring changes caused by other reporters' dynamic structures.
     // Note that all eternal reporters need to be sync, too.
     for (const auto& entry : *mStrongEternalReporters) {
-      DispatchReporter(entry, false, aHandleReport, aHandleReportData,
-                       aAnonymize);
+      dispatchEternalReporter(entry);
     }
     // Process our self-reporting (not in any array/table). Note that when
     // we test, we expect to execute only reporters in the swapped-in tables.
     if (!mIsRegistrationBlocked) {
-      DispatchReporter(this, false, aHandleReport, aHandleReportData,
-                       aAnonymize);
+      dispatchEternalReporter(this);
     }
 
+#ifdef HAVE_JEMALLOC_STATS
+    if (sampled) {
+      nsCOMPtr<nsIMemoryReporter> estimate =
+          new SampledHeapReporter(mHeapClassifiedFraction);
+      dispatchEternalReporter(estimate);
+    }
+#endif
+
     // Now process additional reporters. Note that these are executed in an
     // unforeseeable order (due to the hashtables being keyed on pointers).
-    for (const auto& entry : *mStrongReporters) {
-      DispatchReporter(entry.GetKey(), entry.GetData(), aHandleReport,
-                       aHandleReportData, aAnonymize);
+    if (!sampled) {
+      for (const auto& entry : *mStrongReporters) {
+        DispatchReporter(entry.GetKey(), entry.GetData(), handleReport,
+                         aHandleReportData, aAnonymize);
+      }
+      for (const auto& entry : *mWeakReporters) {
+        nsCOMPtr<nsIMemoryReporter> reporter = entry.GetKey();
+        DispatchReporter(reporter, entry.GetData(), handleReport,
+                         aHandleReportData, aAnonymize);
+      }
     }
-    for (const auto& entry : *mWeakReporters) {
-      nsCOMPtr<nsIMemoryReporter> reporter = entry.GetKey();
-      DispatchReporter(reporter, entry.GetData(), aHandleReport,
-                       aHandleReportData, aAnonymize);
+  }
+
+  if (mPendingReportersState->mIncremental) {
+    // The eternal reporters are cheap and measure the process as a whole, so
+    // run them back to back before anything else, as a normal report would,
+    // rather than letting the other reporters' work land between them. Hold
+    // an extra pending report so the report can't finish before they've run,
+    // even if there is nothing queued.
+    mPendingReportersState->mReportsPending++;
+    for (nsIMemoryReporter* reporter : eternalReporters) {
+      reporter->CollectReports(handleReport, aHandleReportData, aAnonymize);
     }
+    DispatchNextQueuedReporter();
+    EndReport();
   }
 
   return NS_OK;
@@ -2106,6 +2289,12 @@ nsMemoryReporterManager::GetReportsForThisProcessExtended(
 NS_IMETHODIMP
 nsMemoryReporterManager::EndReport() {
   if (--mPendingReportersState->mReportsPending == 0) {
+    if (HeapClassificationCounter* counter =
+            mPendingReportersState->mHeapCounter) {
+      mHeapClassifiedFraction = counter->ClassifiedFraction();
+      mSampledReportsSinceFullReport = 0;
+      mLastFullReportTime = TimeStamp::Now();
+    }
 #ifdef MOZ_DMD
     if (mPendingReportersState->mDMDFile) {
       nsMemoryInfoDumper::DumpDMDToFile(mPendingReportersState->mDMDFile);
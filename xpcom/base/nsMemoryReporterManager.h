@@ -8,6 +8,8 @@
 #define nsMemoryReporterManager_h__
 
 #include "mozilla/Mutex.h"
+#include "mozilla/TimeStamp.h"
+#include "nsTArray.h"
 #include "nsTHashMap.h"
 #include "nsHashKeys.h"
 #include "nsIMemoryReporter.h"
@@ -212,6 +214,12 @@ class nsMemoryReporterManager final : public nsIMemoryReporterManager,
   static int64_t HeapOverheadFraction(const jemalloc_stats_t& stats);
 #endif
 
+  // In sampled mode (memory.report_sampled) a full report is run again, to
+  // refresh mHeapClassifiedFraction, after this many sampled reports or once
+  // the last full report is this old, whichever comes first.
+  static const uint32_t kSampledReportsPerFullReport = 10;
+  static const uint32_t kSampledReportMaxAgeS = 60;
+
  private:
   bool IsRegistrationBlocked() MOZ_EXCLUDES(mMutex) {
     mozilla::MutexAutoLock lock(mMutex);
@@ -229,11 +237,15 @@ class nsMemoryReporterManager final : public nsIMemoryReporterManager,
   void DispatchReporter(nsIMemoryReporter* aReporter, bool aIsAsync,
                         nsIHandleReportCallback* aHandleReport,
                         nsISupports* aHandleReportData, bool aAnonymize);
+  void DispatchNextQueuedReporter();
 
   static void TimeoutCallback(nsITimer* aTimer, void* aData);
   // Note: this timeout needs to be long enough to allow for the
   // possibility of DMD reports and/or running on a low-end phone.
   static const uint32_t kTimeoutLengthMS = 180000;
+  // In incremental mode (memory.report_incremental) each reporter runs from
+  // an idle task, which runs anyway once this timeout has passed.
+  static const uint32_t kIncrementalReporterTimeoutMS = 50;
 
   mozilla::Mutex mMutex;
   bool mIsRegistrationBlocked MOZ_GUARDED_BY(mMutex);
@@ -290,10 +302,27 @@ class nsMemoryReporterManager final : public nsIMemoryReporterManager,
   // Used to keep track of the state of the asynchronously run memory
   // reporters. The callback and file handle used when all memory reporters
   // have finished are also stored here.
+  class HeapClassificationCounter;
+
   struct PendingReportersState {
     // Number of memory reporters currently running.
     uint32_t mReportsPending;
 
+    // In incremental mode, the reporters to run, one per idle task.
+    struct QueuedReporter {
+      nsCOMPtr<nsIMemoryReporter> mReporter;
+      bool mIsAsync;
+    };
+    bool mIncremental;
+    nsTArray<QueuedReporter> mQueuedReporters;
+    size_t mNextQueuedReporter;
+    nsCOMPtr<nsIHandleReportCallback> mHandleReport;
+    nsCOMPtr<nsISupports> mHandleReportData;
+    bool mAnonymize;
+
+    // Non-null when this report should update mHeapClassifiedFraction.
+    RefPtr<HeapClassificationCounter> mHeapCounter;
+
     // Callback for when all memory reporters have completed.
     nsCOMPtr<nsIFinishReportingCallback> mFinishReporting;
     nsCOMPtr<nsISupports> mFinishReportingData;
@@ -304,6 +333,9 @@ class nsMemoryReporterManager final : public nsIMemoryReporterManager,
     PendingReportersState(nsIFinishReportingCallback* aFinishReporting,
                           nsISupports* aFinishReportingData, FILE* aDMDFile)
         : mReportsPending(0),
+          mIncremental(false),
+          mNextQueuedReporter(0),
+          mAnonymize(false),
           mFinishReporting(aFinishReporting),
           mFinishReportingData(aFinishReportingData),
           mDMDFile(aDMDFile) {}
@@ -317,6 +349,15 @@ class nsMemoryReporterManager final : public nsIMemoryReporterManager,
   // This is reinitialized each time a call to GetReports is initiated.
   PendingReportersState* mPendingReportersState;  // MainThread only
 
+  // The fraction of heap-allocated the reporters measured in the last full
+  // report, which sampled reports (memory.report_sampled) extrapolate from.
+  // Negative until there has been a full report.
+  double mHeapClassifiedFraction;  // MainThread only
+  // The number of sampled reports since, and the time of, the last full
+  // report that updated mHeapClassifiedFraction.
+  uint32_t mSampledReportsSinceFullReport;  // MainThread only
+  mozilla::TimeStamp mLastFullReportTime;   // MainThread only
+
   // Used in GetHeapAllocatedAsync() to run jemalloc_stats async.
   nsCOMPtr<nsIEventTarget> mThreadPool MOZ_GUARDED_BY(mMutex);
 
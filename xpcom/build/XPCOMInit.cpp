@@ -81,6 +81,7 @@
 
 #include "mozilla/PoisonIOInterposer.h"
 #include "mozilla/LateWriteChecks.h"
+#include "mozilla/Logging.h"
 
 #include "mozilla/scache/StartupCache.h"
 
@@ -845,6 +846,8 @@ nsresult ShutdownXPCOM(nsIServiceManager* aServMgr) {
   delete sMainHangMonitor;
   sMainHangMonitor = nullptr;
 
+  LogModule::Shutdown();
+
   NS_LogTerm();
 
   return NS_OK;
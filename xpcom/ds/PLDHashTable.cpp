@@ -21,6 +21,12 @@
 #include "mozilla/Maybe.h"
 #include "mozilla/ChaosMode.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define PLDHASH_USE_SSE2
+#endif
+
 using namespace mozilla;
 
 #ifdef MOZ_HASH_TABLE_CHECKS_ENABLED
@@ -239,33 +245,21 @@ PLDHashNumber PLDHashTable::Hash1(PLDHashNumber aHash0) const {
   return aHash0 >> mHashShift;
 }
 
-void PLDHashTable::Hash2(PLDHashNumber aHash0, uint32_t& aHash2Out,
-                         uint32_t& aSizeMaskOut) const {
-  uint32_t sizeLog2 = kPLDHashNumberBits - mHashShift;
-  uint32_t sizeMask = (PLDHashNumber(1) << sizeLog2) - 1;
-  aSizeMaskOut = sizeMask;
-
-  // The incoming aHash0 always has the low bit unset (since we leave it
-  // free for the collision flag), and should have reasonably random
-  // data in the other 31 bits.  We used the high bits of aHash0 for
-  // Hash1, so we use the low bits here.  If the table size is large,
-  // the bits we use may overlap, but that's still more random than
-  // filling with 0s.
-  //
-  // Double hashing needs the second hash code to be relatively prime to table
-  // size, so we simply make hash2 odd.
-  //
-  // This also conveniently covers up the fact that we have the low bit
-  // unset since aHash0 has the low bit unset.
-  aHash2Out = (aHash0 & sizeMask) | 1;
-}
-
 // Reserve mKeyHash 0 for free entries and 1 for removed-entry sentinels. Note
-// that a removed-entry sentinel need be stored only if the removed entry had
-// a colliding entry added after it. Therefore we can use 1 as the collision
-// flag in addition to the removed-entry sentinel value. Multiplicative hash
-// uses the high order bits of mKeyHash, so this least-significant reservation
-// should not hurt the hash function's effectiveness much.
+// that a removed-entry sentinel need be stored only if a colliding entry was
+// added after the removed entry while its group was full. Therefore we can use
+// 1 as the collision flag in addition to the removed-entry sentinel value.
+// Multiplicative hash uses the high order bits of mKeyHash, so this
+// least-significant reservation should not hurt the hash function's
+// effectiveness much.
+//
+// A search stops when the entry's primary slot is free, and otherwise at the
+// first group that contains a free slot. That is only correct if no entry was
+// ever placed beyond a slot or group that has been free at some point since.
+// This holds because an Add() that can't use the primary slot marks it as
+// colliding, an Add() that probes past a group marks every slot in it as
+// colliding, and a colliding slot turns into a removed-entry sentinel rather
+// than a free slot when its entry is removed.
 
 // Match an entry's mKeyHash against an unstored one computed from a key.
 /* static */
@@ -273,6 +267,56 @@ bool PLDHashTable::MatchSlotKeyhash(Slot& aSlot, const PLDHashNumber aKeyHash) {
   return (aSlot.KeyHash() & ~kCollisionFlag) == aKeyHash;
 }
 
+static_assert(PLDHashTable::kMinCapacity % PLDHashTable::kGroupSize == 0,
+              "the smallest table must hold a whole number of groups");
+static_assert(PLDHashTable::kGroupSize <= 32,
+              "group bitmasks must fit in a uint32_t");
+
+template <PLDHashTable::SearchReason Reason>
+/* static */ MOZ_ALWAYS_INLINE PLDHashTable::GroupBits
+PLDHashTable::ScanGroup(const PLDHashNumber* aHashes, PLDHashNumber aKeyHash) {
+  GroupBits bits = {0, 0, 0};
+#ifdef PLDHASH_USE_SSE2
+  static_assert(kGroupSize % 4 == 0, "SSE2 compares four hashes at a time");
+  const __m128i key = _mm_set1_epi32(int32_t(aKeyHash));
+  const __m128i noFlag = _mm_set1_epi32(int32_t(~kCollisionFlag));
+  const __m128i removed = _mm_set1_epi32(1);
+  const __m128i zero = _mm_setzero_si128();
+  for (uint32_t i = 0; i < kGroupSize; i += 4) {
+    __m128i hashes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(aHashes + i));
+    auto toBits = [](__m128i aCmp) {
+      return uint32_t(_mm_movemask_ps(_mm_castsi128_ps(aCmp)));
+    };
+    bits.mMatch |= toBits(_mm_cmpeq_epi32(_mm_and_si128(hashes, noFlag), key))
+                   << i;
+    bits.mFree |= toBits(_mm_cmpeq_epi32(hashes, zero)) << i;
+    if (Reason == ForAdd) {
+      bits.mRemoved |= toBits(_mm_cmpeq_epi32(hashes, removed)) << i;
+    }
+  }
+#else
+  for (uint32_t i = 0; i < kGroupSize; i++) {
+    PLDHashNumber hash = aHashes[i];
+    bits.mMatch |= uint32_t((hash & ~kCollisionFlag) == aKeyHash) << i;
+    bits.mFree |= uint32_t(hash == 0) << i;
+    if (Reason == ForAdd) {
+      bits.mRemoved |= uint32_t(hash == 1) << i;
+    }
+  }
+#endif
+  // aKeyHash is never 0 or 1, so free and removed slots can't match it.
+  MOZ_ASSERT(!(bits.mMatch & (bits.mFree | bits.mRemoved)));
+  return bits;
+}
+
+/* static */ MOZ_ALWAYS_INLINE void PLDHashTable::MarkGroupColliding(
+    PLDHashNumber* aHashes) {
+  for (uint32_t i = 0; i < kGroupSize; i++) {
+    aHashes[i] |= kCollisionFlag;
+  }
+}
+
 // Compute the address of the indexed entry in table.
 auto PLDHashTable::SlotForIndex(uint32_t aIndex) const -> Slot {
   return mEntryStore.SlotForIndex(aIndex, mEntrySize, CapacityFromHashShift());
@@ -342,41 +386,60 @@ MOZ_ALWAYS_INLINE auto PLDHashTable::SearchTable(const void* aKey,
     }
   }
 
-  // Collision: double hash.
-  PLDHashNumber hash2;
-  uint32_t sizeMask;
-  Hash2(aKeyHash, hash2, sizeMask);
-
   // Save the first removed entry slot so Add() can recycle it. (Only used
   // if Reason==ForAdd.)
   Maybe<Slot> firstRemoved;
 
-  for (;;) {
-    if (Reason == ForAdd && !firstRemoved) {
-      if (MOZ_UNLIKELY(slot.IsRemoved())) {
-        firstRemoved.emplace(slot);
-      } else {
-        slot.MarkColliding();
+  if (Reason == ForAdd) {
+    if (MOZ_UNLIKELY(slot.IsRemoved())) {
+      firstRemoved.emplace(slot);
+    } else {
+      slot.MarkColliding();
+    }
+  }
+
+  // Collision: scan the primary group, then the groups after it.
+  PLDHashNumber* hashes = Hashes();
+  uint32_t sizeMask = CapacityFromHashShift() - 1;
+  uint32_t group = hash1 & ~(kGroupSize - 1);
+  uint32_t homeBit = 1u << (hash1 - group);
+
+  for (uint32_t step = kGroupSize;; step += kGroupSize) {
+    GroupBits bits = ScanGroup<Reason>(hashes + group, aKeyHash);
+
+    // Hit: return entry. The primary slot has already been checked.
+    for (uint32_t match = bits.mMatch & ~homeBit; match; match &= match - 1) {
+      Slot candidate = SlotForIndex(group + CountTrailingZeroes32(match));
+      if (matchEntry(candidate.ToEntry(), aKey)) {
+        return aSuccess(candidate);
       }
     }
 
-    hash1 -= hash2;
-    hash1 &= sizeMask;
+    if (Reason == ForAdd && !firstRemoved && MOZ_UNLIKELY(bits.mRemoved)) {
+      firstRemoved.emplace(
+          SlotForIndex(group + CountTrailingZeroes32(bits.mRemoved)));
+    }
 
-    slot = SlotForIndex(hash1);
-    if (slot.IsFree()) {
+    // Miss: return space for a new entry.
+    if (bits.mFree) {
       if (Reason != ForAdd) {
         return aFailure();
       }
-      return aSuccess(firstRemoved.refOr(slot));
+      if (firstRemoved) {
+        return aSuccess(*firstRemoved);
+      }
+      slot = SlotForIndex(group + CountTrailingZeroes32(bits.mFree));
+      return aSuccess(slot);
     }
 
-    if (MatchSlotKeyhash(slot, aKeyHash)) {
-      PLDHashEntryHdr* e = slot.ToEntry();
-      if (matchEntry(e, aKey)) {
-        return aSuccess(slot);
-      }
+    // Collision: the new entry, if any, will be placed beyond this group.
+    if (Reason == ForAdd && !firstRemoved) {
+      MarkGroupColliding(hashes + group);
     }
+
+    // Triangular probing visits every group of a power-of-two sized table.
+    group = (group + step) & sizeMask;
+    homeBit = 0;
   }
 
   // NOTREACHED
@@ -403,23 +466,26 @@ MOZ_ALWAYS_INLINE auto PLDHashTable::FindFreeSlot(PLDHashNumber aKeyHash) const
   if (slot.IsFree()) {
     return slot;
   }
+  MOZ_ASSERT(!slot.IsRemoved());
+  slot.MarkColliding();
 
-  // Collision: double hash.
-  PLDHashNumber hash2;
-  uint32_t sizeMask;
-  Hash2(aKeyHash, hash2, sizeMask);
+  // Collision: scan the primary group, then the groups after it.
+  PLDHashNumber* hashes = Hashes();
+  uint32_t sizeMask = CapacityFromHashShift() - 1;
+  uint32_t group = hash1 & ~(kGroupSize - 1);
 
-  for (;;) {
-    MOZ_ASSERT(!slot.IsRemoved());
-    slot.MarkColliding();
+  for (uint32_t step = kGroupSize;; step += kGroupSize) {
+    GroupBits bits = ScanGroup<ForSearchOrRemove>(hashes + group, aKeyHash);
+    MOZ_ASSERT(!ScanGroup<ForAdd>(hashes + group, aKeyHash).mRemoved);
 
-    hash1 -= hash2;
-    hash1 &= sizeMask;
-
-    slot = SlotForIndex(hash1);
-    if (slot.IsFree()) {
-      return slot;
+    // Miss: return space for a new entry.
+    if (bits.mFree) {
+      return SlotForIndex(group + CountTrailingZeroes32(bits.mFree));
     }
+
+    // Collision: keep probing.
+    MarkGroupColliding(hashes + group);
+    group = (group + step) & sizeMask;
   }
 
   // NOTREACHED
@@ -202,13 +202,20 @@ class Checker {
 // common.
 //
 // There used to be a long, math-heavy comment here about the merits of
-// double hashing vs. chaining; it was removed in bug 1058335. In short, double
-// hashing is more space-efficient unless the element size gets large (in which
-// case you should keep using double hashing but switch to using pointer
-// elements). Also, with double hashing, you can't safely hold an entry pointer
+// double hashing vs. chaining; it was removed in bug 1058335. In short, open
+// addressing is more space-efficient unless the element size gets large (in
+// which case you should keep using open addressing but switch to using pointer
+// elements). Also, with open addressing, you can't safely hold an entry pointer
 // and use it after an add or remove operation, unless you sample Generation()
 // before adding or removing, and compare the sample after, dereferencing the
 // entry pointer only if Generation() has not changed.
+//
+// Probing works on groups of kGroupSize adjacent cached hashes rather than on
+// single slots: all the hashes in a group are compared against the key hash at
+// once (using SSE2 where available), and the groups are visited in triangular
+// order until one containing a free slot is found. Since the hashes are stored
+// apart from the entries, a probe touches at most one cache line of hashes per
+// group and only dereferences entries whose cached hash matches.
 class PLDHashTable {
  private:
   // A slot represents a cached hash value and its associated entry stored in
@@ -393,6 +400,10 @@ class PLDHashTable {
 
   static const uint32_t kMinCapacity = 8;
 
+  // Number of adjacent slots whose hashes are examined together when probing.
+  // kMinCapacity must be a multiple of this.
+  static const uint32_t kGroupSize = 8;
+
   // Making this half of kMaxCapacity ensures it'll fit. Nobody should need an
   // initial length anywhere nearly this large, anyway.
   static const uint32_t kMaxInitialLength = kMaxCapacity / 2;
@@ -705,10 +716,28 @@ class PLDHashTable {
   static const PLDHashNumber kCollisionFlag = 1;
 
   PLDHashNumber Hash1(PLDHashNumber aHash0) const;
-  void Hash2(PLDHashNumber aHash, uint32_t& aHash2Out,
-             uint32_t& aSizeMaskOut) const;
+
+  // Bitmasks describing the kGroupSize slots of a group; bit i refers to the
+  // i-th slot of the group.
+  struct GroupBits {
+    uint32_t mMatch;    // Live slots whose hash equals the key hash.
+    uint32_t mFree;     // Free slots.
+    uint32_t mRemoved;  // Removed-entry sentinels.
+  };
 
   static bool MatchSlotKeyhash(Slot& aSlot, const PLDHashNumber aHash);
+  enum SearchReason { ForSearchOrRemove, ForAdd };
+
+  // mRemoved is only computed when |Reason| is |ForAdd|.
+  template <SearchReason Reason>
+  static GroupBits ScanGroup(const PLDHashNumber* aHashes,
+                             PLDHashNumber aKeyHash);
+  static void MarkGroupColliding(PLDHashNumber* aHashes);
+
+  PLDHashNumber* Hashes() const {
+    return reinterpret_cast<PLDHashNumber*>(mEntryStore.Get());
+  }
+
   Slot SlotForIndex(uint32_t aIndex) const;
 
   // We store mHashShift rather than sizeLog2 to optimize the collision-free
@@ -719,8 +748,6 @@ class PLDHashTable {
 
   PLDHashNumber ComputeKeyHash(const void* aKey) const;
 
-  enum SearchReason { ForSearchOrRemove, ForAdd };
-
   // Avoid using bare `Success` and `Failure`, as those names are commonly
   // defined as macros.
   template <SearchReason Reason, typename PLDSuccess, typename PLDFailure>
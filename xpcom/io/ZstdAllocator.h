@@ -0,0 +1,32 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef mozilla_ZstdAllocator_h__
+#define mozilla_ZstdAllocator_h__
+
+#include "mozilla/mozalloc.h"
+
+// The *_advanced() constructors which take a custom allocator are only
+// declared with ZSTD_STATIC_LINKING_ONLY; that's fine since zstd is built
+// into libxul.
+#define ZSTD_STATIC_LINKING_ONLY 1
+#include "zstd/zstd.h"
+
+namespace mozilla::detail {
+
+// Like nsHTTPCompressConv, allocate zstd's contexts and dictionaries from
+// moz_xmalloc so that they are infallible and show up in our own heap
+// accounting instead of going straight to the system allocator.
+inline void* ZstdMalloc(void*, size_t aSize) { return moz_xmalloc(aSize); }
+
+inline void ZstdFree(void*, void* aAddress) { free(aAddress); }
+
+inline constexpr ZSTD_customMem kZstdAllocators = {ZstdMalloc, ZstdFree,
+                                                   nullptr};
+
+}  // namespace mozilla::detail
+
+#endif  // mozilla_ZstdAllocator_h__
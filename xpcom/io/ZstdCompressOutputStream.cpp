@@ -0,0 +1,265 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "mozilla/ZstdCompressOutputStream.h"
+
+#include <algorithm>
+#include "nsStreamUtils.h"
+#include "ZstdAllocator.h"
+
+namespace mozilla {
+
+NS_IMPL_ISUPPORTS(ZstdCompressOutputStream, nsIOutputStream);
+
+static_assert(ZstdCompressOutputStream::kDefaultLevel == ZSTD_CLEVEL_DEFAULT);
+
+// static
+int32_t ZstdCompressOutputStream::ClampLevel(int32_t aLevel) {
+  return std::clamp(aLevel, int32_t(ZSTD_minCLevel()),
+                    int32_t(ZSTD_maxCLevel()));
+}
+
+// static
+size_t ZstdCompressOutputStream::BlockSize() { return ZSTD_CStreamInSize(); }
+
+ZstdCompressOutputStream::ZstdCompressOutputStream(
+    nsIOutputStream* aBaseStream, int32_t aLevel,
+    ZstdCompressDictionary* aDictionary)
+    : mBaseStream(aBaseStream),
+      mDictionary(aDictionary),
+      mLevel(aDictionary ? aDictionary->Level() : ClampLevel(aLevel)),
+      mContext(nullptr) {
+  // This implementation only supports sync base streams.  Verify this in debug
+  // builds.
+#ifdef DEBUG
+  bool baseNonBlocking;
+  nsresult rv = mBaseStream->IsNonBlocking(&baseNonBlocking);
+  MOZ_ASSERT(NS_SUCCEEDED(rv));
+  MOZ_ASSERT(!baseNonBlocking);
+#endif
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::Close() {
+  if (!mBaseStream) {
+    return NS_OK;
+  }
+
+  // Always finish the frame, even if nothing was written, so that the base
+  // stream holds valid zstd data.
+  nsresult rv = Compress(nullptr, 0, ZSTD_e_end);
+  if (NS_WARN_IF(NS_FAILED(rv))) {
+    return rv;
+  }
+
+  mBaseStream->Close();
+  mBaseStream = nullptr;
+
+  ZSTD_freeCCtx(mContext);
+  mContext = nullptr;
+  mCompressedBuffer = nullptr;
+  mSegmentBuffer = nullptr;
+
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::Flush() {
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+
+  // Only ask zstd to flush if we've given it data, since each flush ends a
+  // block and so costs some compression.
+  if (mContext) {
+    nsresult rv = Compress(nullptr, 0, ZSTD_e_flush);
+    if (NS_WARN_IF(NS_FAILED(rv))) {
+      return rv;
+    }
+  }
+
+  mBaseStream->Flush();
+
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::StreamStatus() {
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+  return mBaseStream->StreamStatus();
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::Write(const char* aBuf, uint32_t aCount,
+                                uint32_t* aResultOut) {
+  *aResultOut = 0;
+
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+
+  // Unlike snappy, zstd keeps its own window of uncompressed data, so the
+  // caller's buffer can be compressed without copying it first.
+  nsresult rv = Compress(aBuf, aCount, ZSTD_e_continue);
+  if (NS_WARN_IF(NS_FAILED(rv))) {
+    return rv;
+  }
+
+  *aResultOut = aCount;
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::WriteFrom(nsIInputStream*, uint32_t, uint32_t*) {
+  return NS_ERROR_NOT_IMPLEMENTED;
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::WriteSegments(nsReadSegmentFun aReader,
+                                        void* aClosure, uint32_t aCount,
+                                        uint32_t* aBytesWrittenOut) {
+  *aBytesWrittenOut = 0;
+
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+
+  const uint32_t segmentLength = BlockSize();
+  if (!mSegmentBuffer) {
+    mSegmentBuffer.reset(new (fallible) char[segmentLength]);
+    if (NS_WARN_IF(!mSegmentBuffer)) {
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+  }
+
+  while (aCount > 0) {
+    uint32_t numToRead = std::min(segmentLength, aCount);
+    uint32_t numRead = 0;
+
+    nsresult rv = aReader(this, aClosure, mSegmentBuffer.get(),
+                          *aBytesWrittenOut, numToRead, &numRead);
+
+    // As defined in nsIOutputStream.idl, do not pass reader func errors.
+    if (NS_FAILED(rv)) {
+      return NS_OK;
+    }
+
+    // End-of-file
+    if (numRead == 0) {
+      return NS_OK;
+    }
+
+    rv = Compress(mSegmentBuffer.get(), numRead, ZSTD_e_continue);
+    if (NS_WARN_IF(NS_FAILED(rv))) {
+      return rv;
+    }
+
+    *aBytesWrittenOut += numRead;
+    aCount -= numRead;
+  }
+
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdCompressOutputStream::IsNonBlocking(bool* aNonBlockingOut) {
+  *aNonBlockingOut = false;
+  return NS_OK;
+}
+
+ZstdCompressOutputStream::~ZstdCompressOutputStream() {
+  Close();
+  // Close() leaves the context behind if it failed.
+  ZSTD_freeCCtx(mContext);
+}
+
+nsresult ZstdCompressOutputStream::EnsureContext() {
+  // Lazily create the context and compressed buffer on our first write.
+  // This allows us to report OOM during stream operation.  They will then
+  // get re-used until the stream is closed.
+  if (mContext) {
+    return NS_OK;
+  }
+
+  mCompressedBuffer.reset(new (fallible) char[ZSTD_CStreamOutSize()]);
+  if (NS_WARN_IF(!mCompressedBuffer)) {
+    return NS_ERROR_OUT_OF_MEMORY;
+  }
+
+  ZSTD_CCtx* context =
+      ZSTD_createCCtx_advanced(detail::kZstdAllocators);  // infallible
+
+  size_t result = ZSTD_CCtx_setParameter(context, ZSTD_c_checksumFlag, 1);
+  if (!ZSTD_isError(result)) {
+    result = mDictionary
+                 ? ZSTD_CCtx_refCDict(context, mDictionary->Get())
+                 : ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel,
+                                          mLevel);
+  }
+  if (NS_WARN_IF(ZSTD_isError(result))) {
+    ZSTD_freeCCtx(context);
+    return NS_ERROR_FAILURE;
+  }
+
+  mContext = context;
+  return NS_OK;
+}
+
+nsresult ZstdCompressOutputStream::Compress(const char* aBuf, uint32_t aCount,
+                                            int aMode) {
+  MOZ_ASSERT(mBaseStream);
+
+  nsresult rv = EnsureContext();
+  if (NS_WARN_IF(NS_FAILED(rv))) {
+    return rv;
+  }
+
+  const auto mode = static_cast<ZSTD_EndDirective>(aMode);
+  ZSTD_inBuffer input = {aBuf, aCount, 0};
+  for (;;) {
+    ZSTD_outBuffer output = {mCompressedBuffer.get(), ZSTD_CStreamOutSize(),
+                             0};
+    size_t remaining = ZSTD_compressStream2(mContext, &output, &input, mode);
+    if (NS_WARN_IF(ZSTD_isError(remaining))) {
+      return NS_ERROR_FAILURE;
+    }
+
+    if (output.pos > 0) {
+      rv = WriteAll(mCompressedBuffer.get(), output.pos);
+      if (NS_WARN_IF(NS_FAILED(rv))) {
+        return rv;
+      }
+    }
+
+    // When continuing, zstd is done once it has consumed all the input.
+    // When flushing or ending, it tells us how much it still has buffered.
+    bool done = mode == ZSTD_e_continue ? input.pos == input.size
+                                        : remaining == 0;
+    if (done) {
+      return NS_OK;
+    }
+  }
+}
+
+nsresult ZstdCompressOutputStream::WriteAll(const char* aBuf,
+                                            uint32_t aCount) {
+  uint32_t offset = 0;
+  while (aCount > 0) {
+    uint32_t numWritten = 0;
+    nsresult rv = mBaseStream->Write(aBuf + offset, aCount, &numWritten);
+    if (NS_WARN_IF(NS_FAILED(rv))) {
+      return rv;
+    }
+    offset += numWritten;
+    aCount -= numWritten;
+  }
+
+  return NS_OK;
+}
+
+}  // namespace mozilla
@@ -0,0 +1,79 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef mozilla_ZstdCompressOutputStream_h__
+#define mozilla_ZstdCompressOutputStream_h__
+
+#include "mozilla/Attributes.h"
+#include "mozilla/RefPtr.h"
+#include "mozilla/UniquePtr.h"
+#include "mozilla/ZstdDictionary.h"
+#include "nsCOMPtr.h"
+#include "nsIOutputStream.h"
+#include "nsISupportsImpl.h"
+
+struct ZSTD_CCtx_s;
+
+namespace mozilla {
+
+class ZstdCompressOutputStream final : public nsIOutputStream {
+ public:
+  // zstd's own default level.  It compresses noticeably better than snappy
+  // at a similar speed; higher levels trade speed for ratio.
+  static const int32_t kDefaultLevel = 3;
+
+  // Clamps aLevel to the range supported by zstd.
+  static int32_t ClampLevel(int32_t aLevel);
+
+  // Construct a new blocking output stream to compress data to the given
+  // base stream.  The base stream must also be blocking.  The output is a
+  // standard zstd frame with a content checksum, which is finished when the
+  // stream is closed.
+  //
+  // If aDictionary is given, it is used to compress the data and its level
+  // overrides aLevel.  The same dictionary must then be passed to the
+  // ZstdUncompressInputStream reading the data back.
+  explicit ZstdCompressOutputStream(
+      nsIOutputStream* aBaseStream, int32_t aLevel = kDefaultLevel,
+      ZstdCompressDictionary* aDictionary = nullptr);
+
+  // The size of the internal buffers.  To optimize stream performance try to
+  // write to the stream in segments at least this size.
+  static size_t BlockSize();
+
+ private:
+  virtual ~ZstdCompressOutputStream();
+
+  nsresult EnsureContext();
+
+  // Feeds aBuf to the compressor and writes any compressed data which is
+  // ready to the base stream.  With a non-continue aMode, this loops until
+  // zstd has flushed everything it has buffered.
+  nsresult Compress(const char* aBuf, uint32_t aCount, int aMode);
+
+  nsresult WriteAll(const char* aBuf, uint32_t aCount);
+
+  nsCOMPtr<nsIOutputStream> mBaseStream;
+  RefPtr<ZstdCompressDictionary> mDictionary;
+  const int32_t mLevel;
+
+  ZSTD_CCtx_s* mContext;
+
+  // Buffer holding the resulting compressed data until it is written to the
+  // base stream.
+  mozilla::UniquePtr<char[]> mCompressedBuffer;
+
+  // Buffer holding data copied in by WriteSegments() readers.
+  mozilla::UniquePtr<char[]> mSegmentBuffer;
+
+ public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSIOUTPUTSTREAM
+};
+
+}  // namespace mozilla
+
+#endif  // mozilla_ZstdCompressOutputStream_h__
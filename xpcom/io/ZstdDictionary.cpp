@@ -0,0 +1,47 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "mozilla/ZstdDictionary.h"
+
+#include "mozilla/ZstdCompressOutputStream.h"
+#include "ZstdAllocator.h"
+
+namespace mozilla {
+
+// static
+already_AddRefed<ZstdCompressDictionary> ZstdCompressDictionary::Create(
+    Span<const uint8_t> aDictionary, int32_t aLevel) {
+  int32_t level = ZstdCompressOutputStream::ClampLevel(aLevel);
+  ZSTD_CDict* dict = ZSTD_createCDict_advanced(
+      aDictionary.Elements(), aDictionary.Length(), ZSTD_dlm_byCopy,
+      ZSTD_dct_auto,
+      ZSTD_getCParams(level, ZSTD_CONTENTSIZE_UNKNOWN, aDictionary.Length()),
+      detail::kZstdAllocators);
+  if (NS_WARN_IF(!dict)) {
+    return nullptr;
+  }
+  return do_AddRef(new ZstdCompressDictionary(dict, level));
+}
+
+ZstdCompressDictionary::~ZstdCompressDictionary() { ZSTD_freeCDict(mDict); }
+
+// static
+already_AddRefed<ZstdUncompressDictionary> ZstdUncompressDictionary::Create(
+    Span<const uint8_t> aDictionary) {
+  ZSTD_DDict* dict = ZSTD_createDDict_advanced(
+      aDictionary.Elements(), aDictionary.Length(), ZSTD_dlm_byCopy,
+      ZSTD_dct_auto, detail::kZstdAllocators);
+  if (NS_WARN_IF(!dict)) {
+    return nullptr;
+  }
+  return do_AddRef(new ZstdUncompressDictionary(dict));
+}
+
+ZstdUncompressDictionary::~ZstdUncompressDictionary() {
+  ZSTD_freeDDict(mDict);
+}
+
+}  // namespace mozilla
@@ -0,0 +1,66 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef mozilla_ZstdDictionary_h__
+#define mozilla_ZstdDictionary_h__
+
+#include "mozilla/AlreadyAddRefed.h"
+#include "mozilla/Span.h"
+#include "nsISupportsImpl.h"
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace mozilla {
+
+// A zstd dictionary prepared for compressing at a given level.  Preparing a
+// dictionary is much more expensive than compressing a small payload with it,
+// so consumers which compress many similar payloads should create one of
+// these up front and share it between ZstdCompressOutputStreams.
+class ZstdCompressDictionary final {
+ public:
+  NS_INLINE_DECL_THREADSAFE_REFCOUNTING(ZstdCompressDictionary)
+
+  // Returns null if aDictionary couldn't be loaded.  The data is copied, so
+  // it doesn't need to outlive the dictionary.
+  static already_AddRefed<ZstdCompressDictionary> Create(
+      Span<const uint8_t> aDictionary, int32_t aLevel);
+
+  int32_t Level() const { return mLevel; }
+  const ZSTD_CDict_s* Get() const { return mDict; }
+
+ private:
+  ZstdCompressDictionary(ZSTD_CDict_s* aDict, int32_t aLevel)
+      : mDict(aDict), mLevel(aLevel) {}
+  ~ZstdCompressDictionary();
+
+  ZSTD_CDict_s* const mDict;
+  const int32_t mLevel;
+};
+
+// The same dictionary, prepared for uncompressing data which was compressed
+// with it.
+class ZstdUncompressDictionary final {
+ public:
+  NS_INLINE_DECL_THREADSAFE_REFCOUNTING(ZstdUncompressDictionary)
+
+  // Returns null if aDictionary couldn't be loaded.  The data is copied, so
+  // it doesn't need to outlive the dictionary.
+  static already_AddRefed<ZstdUncompressDictionary> Create(
+      Span<const uint8_t> aDictionary);
+
+  const ZSTD_DDict_s* Get() const { return mDict; }
+
+ private:
+  explicit ZstdUncompressDictionary(ZSTD_DDict_s* aDict) : mDict(aDict) {}
+  ~ZstdUncompressDictionary();
+
+  ZSTD_DDict_s* const mDict;
+};
+
+}  // namespace mozilla
+
+#endif  // mozilla_ZstdDictionary_h__
@@ -0,0 +1,255 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "mozilla/ZstdUncompressInputStream.h"
+
+#include <algorithm>
+#include "nsIAsyncInputStream.h"
+#include "nsStreamUtils.h"
+#include "ZstdAllocator.h"
+
+namespace mozilla {
+
+NS_IMPL_ISUPPORTS(ZstdUncompressInputStream, nsIInputStream);
+
+ZstdUncompressInputStream::ZstdUncompressInputStream(
+    nsIInputStream* aBaseStream, ZstdUncompressDictionary* aDictionary)
+    : mBaseStream(aBaseStream),
+      mDictionary(aDictionary),
+      mContext(nullptr),
+      mCompressedBytes(0),
+      mNextCompressedByte(0),
+      mUncompressedBytes(0),
+      mNextByte(0),
+      mInFrame(false),
+      mOutputPending(false) {
+  // This implementation only supports sync base streams.  Verify this in debug
+  // builds.  See SnappyUncompressInputStream for the streams this accepts.
+#ifdef DEBUG
+  bool baseNonBlocking;
+  nsresult rv = mBaseStream->IsNonBlocking(&baseNonBlocking);
+  MOZ_ASSERT(NS_SUCCEEDED(rv));
+  if (baseNonBlocking) {
+    nsCOMPtr<nsIAsyncInputStream> async = do_QueryInterface(mBaseStream);
+    MOZ_ASSERT(!async);
+  }
+#endif
+}
+
+NS_IMETHODIMP
+ZstdUncompressInputStream::Close() {
+  if (!mBaseStream) {
+    return NS_OK;
+  }
+
+  mBaseStream->Close();
+  mBaseStream = nullptr;
+
+  ZSTD_freeDCtx(mContext);
+  mContext = nullptr;
+  mUncompressedBuffer = nullptr;
+  mCompressedBuffer = nullptr;
+
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdUncompressInputStream::Available(uint64_t* aLengthOut) {
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+
+  // If we have uncompressed bytes, then we are done.
+  *aLengthOut = UncompressedLength();
+  if (*aLengthOut > 0) {
+    return NS_OK;
+  }
+
+  // Otherwise, attempt to uncompress bytes until we get something or the
+  // underlying stream is drained.
+  bool eof;
+  nsresult rv = UncompressMore(&eof);
+  if (NS_WARN_IF(NS_FAILED(rv))) {
+    return rv;
+  }
+  *aLengthOut = UncompressedLength();
+
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdUncompressInputStream::StreamStatus() {
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+
+  // If we have uncompressed bytes, then we're still open.
+  if (UncompressedLength() > 0) {
+    return NS_OK;
+  }
+
+  // Otherwise we'll need to read from the underlying stream, so check it
+  return mBaseStream->StreamStatus();
+}
+
+NS_IMETHODIMP
+ZstdUncompressInputStream::Read(char* aBuf, uint32_t aCount,
+                                uint32_t* aBytesReadOut) {
+  return ReadSegments(NS_CopySegmentToBuffer, aBuf, aCount, aBytesReadOut);
+}
+
+NS_IMETHODIMP
+ZstdUncompressInputStream::ReadSegments(nsWriteSegmentFun aWriter,
+                                        void* aClosure, uint32_t aCount,
+                                        uint32_t* aBytesReadOut) {
+  *aBytesReadOut = 0;
+
+  if (!mBaseStream) {
+    return NS_BASE_STREAM_CLOSED;
+  }
+
+  nsresult rv;
+
+  while (aCount > 0) {
+    // We have some decompressed data in our buffer.  Provide it to the
+    // callers writer function.
+    if (mUncompressedBytes > 0) {
+      MOZ_ASSERT(mUncompressedBuffer);
+      uint32_t remaining = UncompressedLength();
+      uint32_t numToWrite = std::min(aCount, remaining);
+      uint32_t numWritten;
+      rv = aWriter(this, aClosure, &mUncompressedBuffer[mNextByte],
+                   *aBytesReadOut, numToWrite, &numWritten);
+
+      // As defined in nsIInputputStream.idl, do not pass writer func errors.
+      if (NS_FAILED(rv)) {
+        return NS_OK;
+      }
+
+      // End-of-file
+      if (numWritten == 0) {
+        return NS_OK;
+      }
+
+      *aBytesReadOut += numWritten;
+      mNextByte += numWritten;
+      MOZ_ASSERT(mNextByte <= mUncompressedBytes);
+
+      if (mNextByte == mUncompressedBytes) {
+        mNextByte = 0;
+        mUncompressedBytes = 0;
+      }
+
+      aCount -= numWritten;
+
+      continue;
+    }
+
+    // Otherwise uncompress some more data and loop.  Any resulting data
+    // will set mUncompressedBytes which we check at the top of the loop.
+    bool eof;
+    rv = UncompressMore(&eof);
+    if (NS_FAILED(rv)) {
+      return rv;
+    }
+
+    if (eof) {
+      return NS_OK;
+    }
+  }
+
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+ZstdUncompressInputStream::IsNonBlocking(bool* aNonBlockingOut) {
+  *aNonBlockingOut = false;
+  return NS_OK;
+}
+
+ZstdUncompressInputStream::~ZstdUncompressInputStream() { Close(); }
+
+nsresult ZstdUncompressInputStream::UncompressMore(bool* aEOFOut) {
+  // There must not be any uncompressed data already in mUncompressedBuffer.
+  MOZ_ASSERT(mUncompressedBytes == 0);
+  MOZ_ASSERT(mNextByte == 0);
+
+  *aEOFOut = false;
+
+  // Lazily create our context and buffers so we can report OOM during stream
+  // operation.  These allocations only happen once.  They are reused until
+  // the stream is closed.
+  if (!mContext) {
+    mUncompressedBuffer.reset(new (fallible) char[ZSTD_DStreamOutSize()]);
+    mCompressedBuffer.reset(new (fallible) char[ZSTD_DStreamInSize()]);
+    if (NS_WARN_IF(!mUncompressedBuffer || !mCompressedBuffer)) {
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+
+    ZSTD_DCtx* context =
+        ZSTD_createDCtx_advanced(detail::kZstdAllocators);  // infallible
+    if (mDictionary &&
+        NS_WARN_IF(ZSTD_isError(
+            ZSTD_DCtx_refDDict(context, mDictionary->Get())))) {
+      ZSTD_freeDCtx(context);
+      return NS_ERROR_FAILURE;
+    }
+    mContext = context;
+  }
+
+  // zstd may consume input without producing any output, for example while
+  // it reads a frame header, so keep going until we have something to return.
+  while (mUncompressedBytes == 0) {
+    // Only read from the base stream once zstd has used up what we gave it
+    // last time and has nothing left to flush.
+    if (mNextCompressedByte == mCompressedBytes && !mOutputPending) {
+      uint32_t bytesRead = 0;
+      nsresult rv = mBaseStream->Read(mCompressedBuffer.get(),
+                                      ZSTD_DStreamInSize(), &bytesRead);
+      if (NS_WARN_IF(NS_FAILED(rv))) {
+        return rv;
+      }
+
+      if (bytesRead == 0) {
+        // The data must not end in the middle of a frame.
+        if (NS_WARN_IF(mInFrame)) {
+          return NS_ERROR_CORRUPTED_CONTENT;
+        }
+        *aEOFOut = true;
+        return NS_OK;
+      }
+
+      mCompressedBytes = bytesRead;
+      mNextCompressedByte = 0;
+    }
+
+    ZSTD_inBuffer input = {mCompressedBuffer.get(), mCompressedBytes,
+                           mNextCompressedByte};
+    ZSTD_outBuffer output = {mUncompressedBuffer.get(), ZSTD_DStreamOutSize(),
+                             0};
+    size_t result = ZSTD_decompressStream(mContext, &output, &input);
+    if (NS_WARN_IF(ZSTD_isError(result))) {
+      return NS_ERROR_CORRUPTED_CONTENT;
+    }
+
+    // A result of zero means a frame just ended and has been fully flushed.
+    // Anything else means zstd expects more of the current frame, and may
+    // have more output for us if it filled our buffer.
+    mInFrame = result != 0;
+    mOutputPending = mInFrame && output.pos == output.size;
+    mNextCompressedByte = input.pos;
+    mUncompressedBytes = output.pos;
+  }
+
+  return NS_OK;
+}
+
+size_t ZstdUncompressInputStream::UncompressedLength() const {
+  MOZ_ASSERT(mNextByte <= mUncompressedBytes);
+  return mUncompressedBytes - mNextByte;
+}
+
+}  // namespace mozilla
@@ -0,0 +1,84 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef mozilla_ZstdUncompressInputStream_h__
+#define mozilla_ZstdUncompressInputStream_h__
+
+#include "mozilla/Attributes.h"
+#include "mozilla/RefPtr.h"
+#include "mozilla/UniquePtr.h"
+#include "mozilla/ZstdDictionary.h"
+#include "nsCOMPtr.h"
+#include "nsIInputStream.h"
+#include "nsISupportsImpl.h"
+
+struct ZSTD_DCtx_s;
+
+namespace mozilla {
+
+class ZstdUncompressInputStream final : public nsIInputStream {
+ public:
+  // Construct a new blocking stream to uncompress the given base stream.  The
+  // base stream must also be blocking.  The base stream does not have to be
+  // buffered.  It may hold several concatenated zstd frames.
+  //
+  // aDictionary must be the dictionary the data was compressed with, if any.
+  explicit ZstdUncompressInputStream(
+      nsIInputStream* aBaseStream,
+      ZstdUncompressDictionary* aDictionary = nullptr);
+
+ private:
+  virtual ~ZstdUncompressInputStream();
+
+  // Uncompress more data into mUncompressedBuffer, reading from the base
+  // stream if needed.  This should not be called when mUncompressedBuffer
+  // already contains data.  On return, either mUncompressedBytes is non-zero
+  // or aEOFOut is true.
+  nsresult UncompressMore(bool* aEOFOut);
+
+  // Convenience routine to determine how many bytes of uncompressed data
+  // we currently have in our buffer.
+  size_t UncompressedLength() const;
+
+  nsCOMPtr<nsIInputStream> mBaseStream;
+  RefPtr<ZstdUncompressDictionary> mDictionary;
+
+  ZSTD_DCtx_s* mContext;
+
+  // Buffer holding compressed data read from the base stream.
+  mozilla::UniquePtr<char[]> mCompressedBuffer;
+
+  // Number of bytes of compressed data in mCompressedBuffer, and the next one
+  // zstd should read.
+  size_t mCompressedBytes;
+  size_t mNextCompressedByte;
+
+  // Buffer storing the resulting uncompressed data.
+  mozilla::UniquePtr<char[]> mUncompressedBuffer;
+
+  // Number of bytes of uncompressed data in mUncompressedBuffer.
+  size_t mUncompressedBytes;
+
+  // Next byte of mUncompressedBuffer to return in ReadSegments().  Must be
+  // less than mUncompressedBytes.
+  size_t mNextByte;
+
+  // Whether zstd is part way through a frame.  The base stream must not end
+  // while it is.
+  bool mInFrame;
+
+  // Whether zstd may still have uncompressed data buffered because it filled
+  // mUncompressedBuffer the last time it was called.
+  bool mOutputPending;
+
+ public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSIINPUTSTREAM
+};
+
+}  // namespace mozilla
+
+#endif  // mozilla_ZstdUncompressInputStream_h__
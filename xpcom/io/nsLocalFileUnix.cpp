@@ -109,6 +109,12 @@ extern "C" int statvfs(const char*, struct statvfs*);
 #  define F_BSIZE f_bsize
 #endif
 
+#ifdef HAVE_STATS64
+#  define FSTATAT fstatat64
+#else
+#  define FSTATAT fstatat
+#endif
+
 using namespace mozilla;
 
 #define ENSURE_STAT_CACHE()                            \
@@ -143,6 +149,19 @@ static PRTime TimespecToMillis(const struct timespec& aTimeSpec) {
          PRTime(aTimeSpec.tv_nsec) / PR_NSEC_PER_MSEC;
 }
 
+static uint32_t DirectoryEntryTypeFromMode(mode_t aMode) {
+  if (S_ISREG(aMode)) {
+    return nsIDirectoryEnumerator::TYPE_FILE;
+  }
+  if (S_ISDIR(aMode)) {
+    return nsIDirectoryEnumerator::TYPE_DIRECTORY;
+  }
+  if (S_ISLNK(aMode)) {
+    return nsIDirectoryEnumerator::TYPE_SYMLINK;
+  }
+  return nsIDirectoryEnumerator::TYPE_OTHER;
+}
+
 /* directory enumerator */
 class nsDirEnumeratorUnix final : public nsSimpleEnumerator,
                                   public nsIDirectoryEnumerator {
@@ -169,6 +188,8 @@ class nsDirEnumeratorUnix final : public nsSimpleEnumerator,
 
  protected:
   NS_IMETHOD GetNextEntry();
+  void StatEntry(uint32_t* aType, int64_t* aFileSize,
+                 PRTime* aLastModifiedTime);
 
   DIR* mDir;
   struct dirent* mEntry;
@@ -268,6 +289,71 @@ nsDirEnumeratorUnix::GetNextFile(nsIFile** aResult) {
   return GetNextEntry();
 }
 
+NS_IMETHODIMP
+nsDirEnumeratorUnix::GetNextFileWithInfo(bool aWantStat, uint32_t* aType,
+                                         int64_t* aFileSize,
+                                         PRTime* aLastModifiedTime,
+                                         nsIFile** aResult) {
+  *aType = TYPE_UNKNOWN;
+  *aFileSize = 0;
+  *aLastModifiedTime = 0;
+  if (!mDir || !mEntry) {
+    *aResult = nullptr;
+    return NS_OK;
+  }
+
+#ifdef DT_UNKNOWN
+  // Most file systems store the type in the directory itself, which saves
+  // stat()ing entries when that's all the caller wants.
+  switch (mEntry->d_type) {
+    case DT_REG:
+      *aType = TYPE_FILE;
+      break;
+    case DT_DIR:
+      *aType = TYPE_DIRECTORY;
+      break;
+    case DT_LNK:
+      *aType = TYPE_SYMLINK;
+      break;
+    case DT_UNKNOWN:
+      break;
+    default:
+      *aType = TYPE_OTHER;
+      break;
+  }
+#endif
+
+  if (aWantStat || *aType == TYPE_UNKNOWN) {
+    StatEntry(aType, aWantStat ? aFileSize : nullptr,
+              aWantStat ? aLastModifiedTime : nullptr);
+  }
+
+  return GetNextFile(aResult);
+}
+
+void nsDirEnumeratorUnix::StatEntry(uint32_t* aType, int64_t* aFileSize,
+                                    PRTime* aLastModifiedTime) {
+  // Look the entry up relative to the open directory rather than by its full
+  // path, so the kernel doesn't walk every parent directory again.
+  struct STAT entryStat;
+  if (FSTATAT(dirfd(mDir), mEntry->d_name, &entryStat, AT_SYMLINK_NOFOLLOW) ==
+      -1) {
+    return;
+  }
+
+  *aType = DirectoryEntryTypeFromMode(entryStat.st_mode);
+  if (aFileSize && !S_ISDIR(entryStat.st_mode)) {
+    *aFileSize = int64_t(entryStat.st_size);
+  }
+  if (aLastModifiedTime) {
+#if (defined(__APPLE__) && defined(__MACH__))
+    *aLastModifiedTime = TimespecToMillis(entryStat.st_mtimespec);
+#else
+    *aLastModifiedTime = TimespecToMillis(entryStat.st_mtim);
+#endif
+  }
+}
+
 NS_IMETHODIMP
 nsDirEnumeratorUnix::Close() {
   if (mDir) {
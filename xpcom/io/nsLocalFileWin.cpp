@@ -229,6 +229,22 @@ class nsDriveEnumerator : public nsSimpleEnumerator,
     return NS_OK;
   }
 
+  NS_IMETHOD GetNextFileWithInfo(bool aWantStat, uint32_t* aType,
+                                 int64_t* aFileSize, PRTime* aLastModifiedTime,
+                                 nsIFile** aResult) override {
+    *aType = TYPE_UNKNOWN;
+    *aFileSize = 0;
+    *aLastModifiedTime = 0;
+    *aResult = nullptr;
+    nsresult rv = GetNextFile(aResult);
+    if (NS_SUCCEEDED(rv) && *aResult) {
+      // Every entry is a drive root; don't touch the (possibly removable or
+      // network) drive just to stat it.
+      *aType = TYPE_DIRECTORY;
+    }
+    return rv;
+  }
+
   NS_IMETHOD Close() override { return NS_OK; }
 
  private:
@@ -852,6 +868,48 @@ class nsDirEnumerator final : public nsSimpleEnumerator,
     return NS_OK;
   }
 
+  NS_IMETHOD GetNextFileWithInfo(bool aWantStat, uint32_t* aType,
+                                 int64_t* aFileSize, PRTime* aLastModifiedTime,
+                                 nsIFile** aResult) override {
+    *aType = TYPE_UNKNOWN;
+    *aFileSize = 0;
+    *aLastModifiedTime = 0;
+    *aResult = nullptr;
+    bool hasMore = false;
+    nsresult rv = HasMoreElements(&hasMore);
+    if (NS_FAILED(rv) || !hasMore) {
+      return rv;
+    }
+
+    // FindNextFileW() already returned everything we need along with the
+    // name of mNext, so this never has to touch the file itself.
+    // Only real symlinks are reported as such. Other reparse points, like
+    // junctions and cloud or dedup placeholders, are typed by their
+    // attributes as IsFile() and IsDirectory() do.
+    const WIN32_FIND_DATAW& data = mDir->data;
+    if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+        data.dwReserved0 == IO_REPARSE_TAG_SYMLINK) {
+      *aType = TYPE_SYMLINK;
+    } else if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      *aType = TYPE_DIRECTORY;
+    } else {
+      *aType = TYPE_FILE;
+    }
+
+    if (aWantStat) {
+      if (*aType != TYPE_DIRECTORY) {
+        *aFileSize =
+            (int64_t(data.nFileSizeHigh) << 32) | int64_t(data.nFileSizeLow);
+      }
+      PRTime modifiedTime;
+      FileTimeToPRTime(&data.ftLastWriteTime, &modifiedTime);
+      *aLastModifiedTime = modifiedTime / PR_USEC_PER_MSEC;
+    }
+
+    mNext.forget(aResult);
+    return NS_OK;
+  }
+
   NS_IMETHOD Close() override {
     if (mDir) {
       nsresult rv = CloseDir(mDir);
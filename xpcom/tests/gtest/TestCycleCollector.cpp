@@ -0,0 +1,114 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "gtest/gtest.h"
+
+#include "mozilla/Preferences.h"
+#include "mozilla/RefPtr.h"
+#include "mozilla/TaskController.h"
+#include "nsCycleCollectionParticipant.h"
+#include "nsCycleCollector.h"
+#include "nsTArray.h"
+
+using namespace mozilla;
+
+namespace {
+
+// A node in a ring of cycle collected objects, which counts how many nodes
+// have been destroyed.
+class CCRingNode final : public nsISupports {
+ public:
+  NS_DECL_CYCLE_COLLECTING_ISUPPORTS
+  NS_DECL_CYCLE_COLLECTION_CLASS(CCRingNode)
+
+  explicit CCRingNode(uint32_t* aDestroyed) : mDestroyed(aDestroyed) {}
+
+  RefPtr<CCRingNode> mNext;
+
+ private:
+  ~CCRingNode() { ++*mDestroyed; }
+
+  uint32_t* mDestroyed;
+};
+
+NS_IMPL_CYCLE_COLLECTION(CCRingNode, mNext)
+
+NS_IMPL_CYCLE_COLLECTING_ADDREF(CCRingNode)
+NS_IMPL_CYCLE_COLLECTING_RELEASE(CCRingNode)
+
+NS_INTERFACE_MAP_BEGIN_CYCLE_COLLECTION(CCRingNode)
+  NS_INTERFACE_MAP_ENTRY(nsISupports)
+NS_INTERFACE_MAP_END
+
+constexpr uint32_t kRingLength = 8;
+
+// Enough rings to fill six of the collector's node blocks, which is more than
+// it needs before it scans the graph on helper threads.
+constexpr uint32_t kRingCount = 6 * 4096 / kRingLength;
+
+// Create kRingCount rings. Every other ring is kept alive by aLive, and the
+// rest are garbage. Every ring ends up in the purple buffer, so that the
+// collector has to look at all of them.
+void MakeRings(uint32_t* aDestroyed, nsTArray<RefPtr<CCRingNode>>& aLive) {
+  for (uint32_t i = 0; i < kRingCount; i++) {
+    RefPtr<CCRingNode> first = new CCRingNode(aDestroyed);
+    CCRingNode* last = first;
+    for (uint32_t j = 1; j < kRingLength; j++) {
+      last->mNext = new CCRingNode(aDestroyed);
+      last = last->mNext;
+    }
+    last->mNext = first;
+
+    if (i % 2) {
+      aLive.AppendElement(first);
+    }
+  }
+}
+
+// Collect a set of rings, returning how many nodes were freed and how many
+// helper threads scanned the graph.
+void CollectRings(bool aParallel, uint32_t* aFreed, uint32_t* aHelperThreads) {
+  // Get rid of anything left over from earlier tests.
+  nsCycleCollector_collect(CCReason::API, nullptr);
+
+  uint32_t destroyed = 0;
+  nsTArray<RefPtr<CCRingNode>> live;
+  MakeRings(&destroyed, live);
+
+  Preferences::SetBool("cycle_collector.parallel_scan", aParallel);
+  nsCycleCollector_collect(CCReason::API, nullptr);
+  Preferences::ClearUser("cycle_collector.parallel_scan");
+
+  *aFreed = destroyed;
+  *aHelperThreads = nsCycleCollector_lastScanHelperThreadsForTesting();
+
+  // The live rings are garbage now, and get collected with the next test's
+  // leftovers.
+  live.Clear();
+  nsCycleCollector_collect(CCReason::API, nullptr);
+  EXPECT_EQ(destroyed, kRingCount * kRingLength);
+}
+
+}  // namespace
+
+TEST(CycleCollector, ParallelScanWhiteNodes)
+{
+  uint32_t serialFreed;
+  uint32_t serialHelperThreads;
+  CollectRings(false, &serialFreed, &serialHelperThreads);
+  EXPECT_EQ(serialHelperThreads, 0u);
+
+  uint32_t parallelFreed;
+  uint32_t parallelHelperThreads;
+  CollectRings(true, &parallelFreed, &parallelHelperThreads);
+  if (TaskController::GetPoolThreadCount() > 0) {
+    EXPECT_GT(parallelHelperThreads, 0u);
+  }
+
+  // Only the garbage rings are white, whichever way the graph was scanned.
+  EXPECT_EQ(serialFreed, kRingCount / 2 * kRingLength);
+  EXPECT_EQ(parallelFreed, serialFreed);
+}
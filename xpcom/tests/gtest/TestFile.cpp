@@ -3,9 +3,11 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include "prenv.h"
 #include "prio.h"
 #include "prsystem.h"
 
+#include "nsIDirectoryEnumerator.h"
 #include "nsIFile.h"
 #ifdef XP_WIN
 #  include "nsILocalFileWin.h"
@@ -17,6 +19,7 @@
 #include "nsPrintfCString.h"
 
 #include "gtest/gtest.h"
+#include "gtest/MozGTestBench.h"
 #include "mozilla/gtest/MozAssertions.h"
 
 #ifdef XP_WIN
@@ -573,3 +576,160 @@ TEST(TestFile, PrefixedOnWin_ComponentEndsWithPeriod)
                         /* aTestCreateUnique */ true,
                         /* aTestNormalize */ false);
 }
+
+static already_AddRefed<nsIFile> CreateTestDir(const nsACString& aDirName) {
+  nsCOMPtr<nsIFile> base;
+  nsresult rv = NS_GetSpecialDirectory(NS_OS_TEMP_DIR, getter_AddRefs(base));
+  if (!VerifyResult(rv, "Getting temp directory")) return nullptr;
+
+  rv = base->AppendNative(aDirName);
+  if (!VerifyResult(rv, "Appending to temp directory name")) return nullptr;
+
+  // Remove the directory in case tests failed and left it behind.
+  base->Remove(true);
+
+  rv = base->Create(nsIFile::DIRECTORY_TYPE, 0700);
+  if (!VerifyResult(rv, "Creating temp directory")) return nullptr;
+
+  return base.forget();
+}
+
+TEST(TestFile, GetNextFileWithInfo)
+{
+  nsCOMPtr<nsIFile> base = CreateTestDir("mozfileinfotests"_ns);
+  ASSERT_TRUE(base);
+
+  ASSERT_TRUE(TestCreate(base, "subdir", nsIFile::DIRECTORY_TYPE, 0700));
+  ASSERT_TRUE(TestCreate(base, "file.txt", nsIFile::NORMAL_FILE_TYPE, 0600));
+
+  nsCOMPtr<nsIFile> file = NewFile(base);
+  ASSERT_NS_SUCCEEDED(file->AppendNative("file.txt"_ns));
+  ASSERT_NS_SUCCEEDED(file->SetFileSize(1234));
+
+  nsCOMPtr<nsIDirectoryEnumerator> entries;
+  ASSERT_NS_SUCCEEDED(base->GetDirectoryEntries(getter_AddRefs(entries)));
+
+  uint32_t count = 0;
+  for (;;) {
+    uint32_t type;
+    int64_t fileSize;
+    PRTime lastModifiedTime;
+    nsCOMPtr<nsIFile> entry;
+    ASSERT_NS_SUCCEEDED(entries->GetNextFileWithInfo(
+        /* aWantStat */ true, &type, &fileSize, &lastModifiedTime,
+        getter_AddRefs(entry)));
+    if (!entry) {
+      break;
+    }
+    count++;
+
+    nsAutoCString name;
+    ASSERT_NS_SUCCEEDED(entry->GetNativeLeafName(name));
+
+    bool isDirectory;
+    ASSERT_NS_SUCCEEDED(entry->IsDirectory(&isDirectory));
+    EXPECT_EQ(type, isDirectory ? nsIDirectoryEnumerator::TYPE_DIRECTORY
+                                : nsIDirectoryEnumerator::TYPE_FILE)
+        << name.get();
+
+    int64_t expectedSize;
+    ASSERT_NS_SUCCEEDED(entry->GetFileSize(&expectedSize));
+    EXPECT_EQ(fileSize, expectedSize) << name.get();
+    EXPECT_EQ(fileSize, name.EqualsLiteral("file.txt") ? 1234 : 0);
+
+    PRTime expectedTime;
+    ASSERT_NS_SUCCEEDED(entry->GetLastModifiedTime(&expectedTime));
+    EXPECT_EQ(lastModifiedTime, expectedTime) << name.get();
+  }
+  EXPECT_EQ(count, 2u);
+  entries->Close();
+
+  VerifyResult(base->Remove(true), "Cleaning up temp directory");
+}
+
+// The benchmarks below run with every gtest run, so they only use a small
+// directory unless MOZ_GTEST_LARGE_DIRECTORY is set in the environment.
+class TestFileLargeDirectory : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    sEntryCount = PR_GetEnv("MOZ_GTEST_LARGE_DIRECTORY") ? 100000 : 1000;
+    sDir = CreateTestDir("mozfilelargedirtests"_ns).take();
+    ASSERT_TRUE(sDir);
+    for (uint32_t i = 0; i < sEntryCount; i++) {
+      nsCOMPtr<nsIFile> file = NewFile(sDir);
+      ASSERT_NS_SUCCEEDED(file->AppendNative(nsPrintfCString("file%u", i)));
+      ASSERT_NS_SUCCEEDED(file->Create(nsIFile::NORMAL_FILE_TYPE, 0600));
+    }
+  }
+
+  static void TearDownTestSuite() {
+    if (sDir) {
+      sDir->Remove(true);
+      NS_RELEASE(sDir);
+    }
+  }
+
+  static uint32_t sEntryCount;
+  static nsIFile* sDir;
+};
+
+uint32_t TestFileLargeDirectory::sEntryCount = 0;
+nsIFile* TestFileLargeDirectory::sDir = nullptr;
+
+MOZ_GTEST_BENCH_F(TestFileLargeDirectory, NextFileAndGetters, [] {
+  nsCOMPtr<nsIDirectoryEnumerator> entries;
+  ASSERT_NS_SUCCEEDED(sDir->GetDirectoryEntries(getter_AddRefs(entries)));
+  uint32_t count = 0;
+  nsCOMPtr<nsIFile> entry;
+  while (NS_SUCCEEDED(entries->GetNextFile(getter_AddRefs(entry))) && entry) {
+    bool isDirectory;
+    int64_t fileSize;
+    PRTime lastModifiedTime;
+    ASSERT_NS_SUCCEEDED(entry->IsDirectory(&isDirectory));
+    ASSERT_NS_SUCCEEDED(entry->GetFileSize(&fileSize));
+    ASSERT_NS_SUCCEEDED(entry->GetLastModifiedTime(&lastModifiedTime));
+    count++;
+  }
+  ASSERT_EQ(count, sEntryCount);
+});
+
+MOZ_GTEST_BENCH_F(TestFileLargeDirectory, NextFileWithInfo, [] {
+  nsCOMPtr<nsIDirectoryEnumerator> entries;
+  ASSERT_NS_SUCCEEDED(sDir->GetDirectoryEntries(getter_AddRefs(entries)));
+  uint32_t count = 0;
+  for (;;) {
+    uint32_t type;
+    int64_t fileSize;
+    PRTime lastModifiedTime;
+    nsCOMPtr<nsIFile> entry;
+    ASSERT_NS_SUCCEEDED(entries->GetNextFileWithInfo(
+        /* aWantStat */ true, &type, &fileSize, &lastModifiedTime,
+        getter_AddRefs(entry)));
+    if (!entry) {
+      break;
+    }
+    count++;
+  }
+  ASSERT_EQ(count, sEntryCount);
+});
+
+MOZ_GTEST_BENCH_F(TestFileLargeDirectory, NextFileWithType, [] {
+  nsCOMPtr<nsIDirectoryEnumerator> entries;
+  ASSERT_NS_SUCCEEDED(sDir->GetDirectoryEntries(getter_AddRefs(entries)));
+  uint32_t count = 0;
+  for (;;) {
+    uint32_t type;
+    int64_t fileSize;
+    PRTime lastModifiedTime;
+    nsCOMPtr<nsIFile> entry;
+    ASSERT_NS_SUCCEEDED(entries->GetNextFileWithInfo(
+        /* aWantStat */ false, &type, &fileSize, &lastModifiedTime,
+        getter_AddRefs(entry)));
+    if (!entry) {
+      break;
+    }
+    ASSERT_EQ(type, nsIDirectoryEnumerator::TYPE_FILE);
+    count++;
+  }
+  ASSERT_EQ(count, sEntryCount);
+});
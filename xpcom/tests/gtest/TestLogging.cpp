@@ -4,13 +4,30 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include "mozilla/Casting.h"
+#include "mozilla/EndianUtils.h"
 #include "mozilla/Logging.h"
 #include "mozilla/Sprintf.h"
 #include "gtest/gtest.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mozilla {
+class LogModuleManager;
+}
+
 namespace mozilla::detail {
 bool LimitFileToLessThanSize(const char* aFilename, uint32_t aSize,
                              uint16_t aLongLineSize);
+size_t EncodeBinaryLogArgs(const char* aFmt, va_list aArgs, uint8_t* aBuffer,
+                           size_t aLength);
+LogModuleManager* StartBinaryLogForTesting(const char* aFilename,
+                                           bool aIsSync);
+void PrintBinaryLogForTesting(LogModuleManager* aManager, const char* aName,
+                              const char* aFmt, ...) MOZ_FORMAT_PRINTF(3, 4);
+void StopBinaryLogForTesting(LogModuleManager* aManager);
 }
 
 // These format strings result in 1024 byte lines on disk regardless
@@ -180,3 +197,192 @@ TEST(Logging, MayCutLongLinesInexact)
 
   EXPECT_FALSE(remove(nameBuf));
 }
+
+static size_t EncodeBinaryLogArgs(uint8_t* aBuffer, size_t aLength,
+                                  const char* aFmt, ...) {
+  va_list args;
+  va_start(args, aFmt);
+  size_t length =
+      mozilla::detail::EncodeBinaryLogArgs(aFmt, args, aBuffer, aLength);
+  va_end(args);
+  return length;
+}
+
+TEST(Logging, EncodeBinaryLogArgs)
+{
+  using mozilla::LittleEndian;
+
+  uint8_t buffer[256];
+  size_t length =
+      EncodeBinaryLogArgs(buffer, sizeof(buffer), "%d %hhu%% %*.*f %s %p %zx",
+                          -3, 300, 5, 2, 1.5, "str", (void*)0x10, size_t(7));
+  ASSERT_EQ(length, 7u * 9 + 3 + 3);
+
+  const uint8_t* p = buffer;
+  auto expectInt = [&](int64_t aValue) {
+    EXPECT_EQ(p[0], 'i');
+    EXPECT_EQ(static_cast<int64_t>(LittleEndian::readUint64(p + 1)), aValue);
+    p += 9;
+  };
+  expectInt(-3);
+  // %hhu truncates to unsigned char.
+  expectInt(44);
+  // Star width and precision.
+  expectInt(5);
+  expectInt(2);
+  EXPECT_EQ(p[0], 'd');
+  EXPECT_EQ(mozilla::BitwiseCast<double>(LittleEndian::readUint64(p + 1)), 1.5);
+  p += 9;
+  EXPECT_EQ(p[0], 's');
+  EXPECT_EQ(LittleEndian::readUint16(p + 1), 3);
+  EXPECT_EQ(memcmp(p + 3, "str", 3), 0);
+  p += 6;
+  EXPECT_EQ(p[0], 'p');
+  EXPECT_EQ(LittleEndian::readUint64(p + 1), 0x10u);
+  p += 9;
+  expectInt(7);
+
+  // Arguments which don't fit are left out.
+  length = EncodeBinaryLogArgs(buffer, 12, "%d %d", 1, 2);
+  EXPECT_EQ(length, 9u);
+
+  // Strings are truncated to fit.
+  length = EncodeBinaryLogArgs(buffer, 8, "%s", "truncated");
+  EXPECT_EQ(length, 8u);
+  EXPECT_EQ(LittleEndian::readUint16(buffer + 1), 5);
+}
+
+TEST(Logging, EncodeBinaryLogArgsPrecision)
+{
+  using mozilla::LittleEndian;
+
+  // The precision bounds how much of the string is read, so it needn't be
+  // null-terminated.
+  const char unterminated[4] = {'a', 'b', 'c', 'd'};
+  uint8_t buffer[64];
+  size_t length = EncodeBinaryLogArgs(buffer, sizeof(buffer), "%.4s %.2s",
+                                      unterminated, "xyz");
+  ASSERT_EQ(length, 4u + 3 + 2 + 3);
+  EXPECT_EQ(LittleEndian::readUint16(buffer + 1), 4);
+  EXPECT_EQ(memcmp(buffer + 3, "abcd", 4), 0);
+  EXPECT_EQ(LittleEndian::readUint16(buffer + 8), 2);
+  EXPECT_EQ(memcmp(buffer + 10, "xy", 2), 0);
+
+  // Star precision, where a negative value means there is none.
+  length = EncodeBinaryLogArgs(buffer, sizeof(buffer), "%.*s %.*s", 1,
+                               unterminated, -1, "xyz");
+  ASSERT_EQ(length, 9u + 1 + 3 + 9 + 3 + 3);
+  EXPECT_EQ(LittleEndian::readUint16(buffer + 10), 1);
+  EXPECT_EQ(buffer[12], 'a');
+  EXPECT_EQ(LittleEndian::readUint16(buffer + 23), 3);
+  EXPECT_EQ(memcmp(buffer + 25, "xyz", 3), 0);
+}
+
+struct BinaryLogMessage {
+  std::string mModule;
+  std::string mFormat;
+  std::vector<uint8_t> mArgs;
+};
+
+// Reads back the messages in a binary log file, resolving their module and
+// format string ids.  All messages must come from one thread.
+static std::vector<BinaryLogMessage> ReadBinaryLogMessages(const char* name) {
+  using mozilla::LittleEndian;
+
+  std::vector<BinaryLogMessage> messages;
+  FILE* f = fopen(name, "rb");
+  if (!f) {
+    ADD_FAILURE() << "couldn't open " << name;
+    return messages;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  while (size_t read = fread(chunk, 1, sizeof(chunk), f)) {
+    data.insert(data.end(), chunk, chunk + read);
+  }
+  EXPECT_FALSE(fclose(f));
+
+  if (data.size() < 8 || memcmp(data.data(), "MOZLOGB1", 8) != 0) {
+    ADD_FAILURE() << "missing binary log header";
+    return messages;
+  }
+
+  std::map<uint64_t, std::string> strings;
+  size_t pos = 8;
+  while (pos < data.size()) {
+    if (data.size() - pos < 5) {
+      ADD_FAILURE() << "truncated record header";
+      break;
+    }
+    uint8_t kind = data[pos];
+    uint32_t length = LittleEndian::readUint32(&data[pos + 1]);
+    pos += 5;
+    if (data.size() - pos < length) {
+      ADD_FAILURE() << "truncated record";
+      break;
+    }
+    const uint8_t* payload = &data[pos];
+    if (kind == 4) {
+      // String: id, then the string.
+      strings[LittleEndian::readUint64(payload)] =
+          std::string(reinterpret_cast<const char*>(payload + 8), length - 8);
+    } else if (kind == 5) {
+      // Message: time, start, module id, format id, level, then arguments.
+      messages.push_back({strings[LittleEndian::readUint64(payload + 16)],
+                          strings[LittleEndian::readUint64(payload + 24)],
+                          std::vector<uint8_t>(payload + 33,
+                                               payload + length)});
+    }
+    pos += length;
+  }
+  return messages;
+}
+
+TEST(Logging, BinaryLogRoundTrip)
+{
+  using mozilla::LittleEndian;
+
+  char nameBuf[2048];
+  SprintfLiteral(
+      nameBuf, "%s_%s.moz_log",
+      testing::UnitTest::GetInstance()->current_test_info()->test_case_name(),
+      testing::UnitTest::GetInstance()->current_test_info()->name());
+
+  auto expectMessage = [&](const BinaryLogMessage& aMessage) {
+    EXPECT_EQ(aMessage.mModule, "binarytest");
+    EXPECT_EQ(aMessage.mFormat, "%d %.3s");
+    ASSERT_EQ(aMessage.mArgs.size(), 9u + 3 + 3);
+    EXPECT_EQ(aMessage.mArgs[0], 'i');
+    EXPECT_EQ(LittleEndian::readUint64(&aMessage.mArgs[1]), 42u);
+    EXPECT_EQ(aMessage.mArgs[9], 's');
+    EXPECT_EQ(memcmp(&aMessage.mArgs[12], "abc", 3), 0);
+  };
+
+  // In sync mode every message is in the file as soon as it is logged,
+  // without waiting for the drainer thread.
+  mozilla::LogModuleManager* manager =
+      mozilla::detail::StartBinaryLogForTesting(nameBuf, true);
+  ASSERT_TRUE(manager);
+  mozilla::detail::PrintBinaryLogForTesting(manager, "binarytest", "%d %.3s",
+                                            42, "abcdef");
+  std::vector<BinaryLogMessage> messages = ReadBinaryLogMessages(nameBuf);
+  ASSERT_EQ(messages.size(), 1u);
+  expectMessage(messages[0]);
+  mozilla::detail::StopBinaryLogForTesting(manager);
+
+  // Otherwise, stopping drains whatever hasn't been written out yet.
+  manager = mozilla::detail::StartBinaryLogForTesting(nameBuf, false);
+  ASSERT_TRUE(manager);
+  for (int i = 0; i < 100; ++i) {
+    mozilla::detail::PrintBinaryLogForTesting(manager, "binarytest", "%d %.3s",
+                                              42, "abcdef");
+  }
+  mozilla::detail::StopBinaryLogForTesting(manager);
+  messages = ReadBinaryLogMessages(nameBuf);
+  ASSERT_EQ(messages.size(), 100u);
+  for (const auto& message : messages) {
+    expectMessage(message);
+  }
+
+  EXPECT_FALSE(remove(nameBuf));
+}
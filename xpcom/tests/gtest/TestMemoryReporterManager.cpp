@@ -0,0 +1,159 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "gtest/gtest.h"
+
+#include "mozilla/Preferences.h"
+#include "mozilla/SpinEventLoopUntil.h"
+#include "nsIMemoryReporter.h"
+#include "nsMemoryReporterManager.h"
+#include "nsServiceManagerUtils.h"
+#include "nsTArray.h"
+
+using namespace mozilla;
+
+namespace {
+
+constexpr auto kTestReporterPath = "explicit/gtest-memory-reporter"_ns;
+
+class TestMemoryReporter final : public nsIMemoryReporter {
+  ~TestMemoryReporter() = default;
+
+ public:
+  NS_DECL_ISUPPORTS
+
+  NS_IMETHOD CollectReports(nsIHandleReportCallback* aHandleReport,
+                            nsISupports* aData, bool aAnonymize) override {
+    MOZ_COLLECT_REPORT("explicit/gtest-memory-reporter", KIND_HEAP,
+                       UNITS_BYTES, 0,
+                       "Registered by TestMemoryReporterManager.");
+    return NS_OK;
+  }
+};
+
+NS_IMPL_ISUPPORTS(TestMemoryReporter, nsIMemoryReporter)
+
+// Records the paths reported by one report, in order.
+class ReportRecorder final : public nsIHandleReportCallback,
+                             public nsIFinishReportingCallback {
+  ~ReportRecorder() = default;
+
+ public:
+  NS_DECL_ISUPPORTS
+
+  NS_IMETHOD Callback(const nsACString& aProcess, const nsACString& aPath,
+                      int32_t aKind, int32_t aUnits, int64_t aAmount,
+                      const nsACString& aDescription,
+                      nsISupports* aData) override {
+    mPaths.AppendElement(aPath);
+    return NS_OK;
+  }
+
+  NS_IMETHOD Callback(nsISupports* aData) override {
+    mFinished = true;
+    return NS_OK;
+  }
+
+  nsTArray<nsCString> mPaths;
+  // The number of paths reported before GetReportsForThisProcessExtended()
+  // returned.
+  size_t mSyncPathCount = 0;
+  bool mFinished = false;
+};
+
+NS_IMPL_ISUPPORTS(ReportRecorder, nsIHandleReportCallback,
+                  nsIFinishReportingCallback)
+
+// Runs a report for this process to completion.
+already_AddRefed<ReportRecorder> RunReport() {
+  nsCOMPtr<nsIMemoryReporterManager> mgr =
+      do_GetService("@mozilla.org/memory-reporter-manager;1");
+  RefPtr<ReportRecorder> recorder = new ReportRecorder();
+  EXPECT_EQ(NS_OK,
+            mgr->GetReportsForThisProcessExtended(
+                recorder, nullptr, false, nullptr, recorder, nullptr));
+  recorder->mSyncPathCount = recorder->mPaths.Length();
+  MOZ_ALWAYS_TRUE(SpinEventLoopUntil(
+      "xpcom:TestMemoryReporterManager RunReport"_ns,
+      [&]() { return recorder->mFinished; }));
+  return recorder.forget();
+}
+
+class MemoryReporterManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mMgr = do_GetService("@mozilla.org/memory-reporter-manager;1");
+    ASSERT_TRUE(mMgr);
+    mReporter = new TestMemoryReporter();
+    ASSERT_EQ(NS_OK, mMgr->RegisterStrongReporter(mReporter));
+  }
+
+  void TearDown() override {
+    mMgr->UnregisterStrongReporter(mReporter);
+    Preferences::ClearUser("memory.report_incremental");
+    Preferences::ClearUser("memory.report_sampled");
+  }
+
+  nsCOMPtr<nsIMemoryReporterManager> mMgr;
+  nsCOMPtr<nsIMemoryReporter> mReporter;
+};
+
+}  // namespace
+
+TEST_F(MemoryReporterManagerTest, Incremental)
+{
+  Preferences::SetBool("memory.report_incremental", true);
+
+  RefPtr<ReportRecorder> recorder = RunReport();
+  EXPECT_TRUE(recorder->mFinished);
+
+  // The eternal reporters, and the manager's own report, run synchronously
+  // before anything else; the other reporters are spread out afterwards.
+  size_t managerIndex =
+      recorder->mPaths.IndexOf("explicit/memory-reporter-manager"_ns);
+  size_t testIndex = recorder->mPaths.IndexOf(kTestReporterPath);
+  ASSERT_NE(managerIndex, recorder->mPaths.NoIndex);
+  ASSERT_NE(testIndex, recorder->mPaths.NoIndex);
+  EXPECT_LT(managerIndex, recorder->mSyncPathCount);
+  EXPECT_GE(testIndex, recorder->mSyncPathCount);
+}
+
+#ifdef HAVE_JEMALLOC_STATS
+TEST_F(MemoryReporterManagerTest, Sampled)
+{
+  Preferences::SetBool("memory.report_sampled", true);
+
+  const uint32_t kSampled =
+      nsMemoryReporterManager::kSampledReportsPerFullReport;
+  auto isFull = [](ReportRecorder* aRecorder) {
+    return aRecorder->mPaths.Contains(kTestReporterPath);
+  };
+
+  // Get to a full report.  An earlier test may have left the manager part
+  // of the way through a run of sampled reports.
+  bool full = false;
+  for (uint32_t i = 0; i <= kSampled && !full; i++) {
+    RefPtr<ReportRecorder> recorder = RunReport();
+    full = isFull(recorder);
+  }
+  ASSERT_TRUE(full);
+
+  // Sampled reports skip the other reporters and estimate what they would
+  // have measured instead.
+  for (uint32_t i = 0; i < kSampled; i++) {
+    RefPtr<ReportRecorder> recorder = RunReport();
+    EXPECT_FALSE(isFull(recorder));
+    EXPECT_TRUE(
+        recorder->mPaths.Contains("explicit/heap-classified-estimate"_ns));
+  }
+
+  // Then a full report refreshes the estimate.
+  RefPtr<ReportRecorder> recorder = RunReport();
+  EXPECT_TRUE(isFull(recorder));
+  EXPECT_FALSE(
+      recorder->mPaths.Contains("explicit/heap-classified-estimate"_ns));
+}
+#endif
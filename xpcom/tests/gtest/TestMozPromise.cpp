@@ -6,6 +6,7 @@
 #include "VideoUtils.h"
 #include "base/message_loop.h"
 #include "gtest/gtest.h"
+#include "gtest/MozGTestBench.h"  // For MOZ_GTEST_BENCH
 #include "mozilla/ChaosMode.h"
 #include "mozilla/MozPromise.h"
 #include "mozilla/SharedThreadPool.h"
@@ -865,4 +866,45 @@ TEST(MozPromise, ObjectDestructionOrder)
   queue->BeginShutdown();
 }
 
+static const int kBenchLength = 10000;
+
+// Measures the cost of Then() and of the dispatch to the response target.
+MOZ_GTEST_BENCH(MozPromise, PerfThen, [] {
+  RefPtr<TestPromise> p = TestPromise::CreateAndResolve(42, __func__);
+  int count = 0;
+  for (int i = 0; i < kBenchLength; ++i) {
+    p->Then(
+        GetCurrentSerialEventTarget(), __func__,
+        [&count](int aResolveValue) -> void { ++count; }, DO_FAIL);
+  }
+  MOZ_ALWAYS_TRUE(SpinEventLoopUntil("xpcom:TEST(MozPromise, PerfThen)"_ns,
+                                     [&count]() {
+                                       return count == kBenchLength;
+                                     }));
+});
+
+// Same with a completion promise chained to the promise each callback
+// returns.
+MOZ_GTEST_BENCH(MozPromise, PerfThenChain, [] {
+  RefPtr<TestPromise> p = TestPromise::CreateAndResolve(0, __func__);
+  for (int i = 0; i < kBenchLength; ++i) {
+    p = p->Then(
+        GetCurrentSerialEventTarget(), __func__,
+        [](int aResolveValue) {
+          return TestPromise::CreateAndResolve(aResolveValue + 1, __func__);
+        },
+        DO_FAIL);
+  }
+  bool done = false;
+  p->Then(
+      GetCurrentSerialEventTarget(), __func__,
+      [&done](int aResolveValue) -> void {
+        EXPECT_EQ(aResolveValue, kBenchLength);
+        done = true;
+      },
+      DO_FAIL);
+  MOZ_ALWAYS_TRUE(SpinEventLoopUntil(
+      "xpcom:TEST(MozPromise, PerfThenChain)"_ns, [&done]() { return done; }));
+});
+
 #undef DO_FAIL
@@ -6,6 +6,7 @@
 
 #include "PLDHashTable.h"
 #include "gtest/gtest.h"
+#include "gtest/MozGTestBench.h"  // For MOZ_GTEST_BENCH
 #include "mozilla/gtest/MozHelpers.h"
 
 // This test mostly focuses on edge cases. But more coverage of normal
@@ -372,6 +373,90 @@ TEST(PLDHashTableTest, WithEntryHandle)
   ASSERT_EQ(entry1, entry2);
 }
 
+// Only a handful of distinct hashes, so that every group overflows into the
+// following ones and removals leave removed-entry sentinels behind.
+static PLDHashNumber CollidingHash(const void* key) {
+  return (PLDHashNumber)((size_t)key % 5);
+}
+
+static const PLDHashTableOps collidingOps = {
+    CollidingHash, PLDHashTable::MatchEntryStub, PLDHashTable::MoveEntryStub,
+    PLDHashTable::ClearEntryStub, TrivialInitEntry};
+
+TEST(PLDHashTableTest, CollidingChurn)
+{
+  PLDHashTable t(&collidingOps, sizeof(PLDHashEntryStub));
+
+  const size_t kNumKeys = 200;
+  bool present[kNumKeys + 1] = {};
+  uint32_t count = 0;
+
+  // Deterministically add and remove keys, checking every key after each
+  // step so that probing past removed entries is exercised.
+  for (size_t i = 0; i < 2000; i++) {
+    size_t key = 1 + (i * 37) % kNumKeys;
+    if (present[key]) {
+      t.Remove((const void*)key);
+      count--;
+    } else {
+      t.Add((const void*)key);
+      count++;
+    }
+    present[key] = !present[key];
+    ASSERT_EQ(t.EntryCount(), count);
+
+    for (size_t k = 1; k <= kNumKeys; k++) {
+      ASSERT_EQ(!!t.Search((const void*)k), present[k]);
+    }
+  }
+
+  uint32_t n = 0;
+  for (auto iter = t.Iter(); !iter.Done(); iter.Next()) {
+    auto entry = static_cast<PLDHashEntryStub*>(iter.Get());
+    ASSERT_TRUE(present[(size_t)entry->key]);
+    n++;
+  }
+  ASSERT_EQ(n, count);
+}
+
+static const size_t kBenchLength = 50000;
+
+static void FillBenchTable(PLDHashTable& aTable) {
+  for (size_t i = 1; i <= kBenchLength; i++) {
+    aTable.Add((const void*)(i * 8));
+  }
+}
+
+MOZ_GTEST_BENCH(PLDHashTableTest, PerfLookupHit, [] {
+  PLDHashTable t(&trivialOps, sizeof(PLDHashEntryStub));
+  FillBenchTable(t);
+  for (int j = 0; j < 20; j++) {
+    for (size_t i = 1; i <= kBenchLength; i++) {
+      ASSERT_TRUE(t.Search((const void*)(i * 8)));
+    }
+  }
+});
+
+MOZ_GTEST_BENCH(PLDHashTableTest, PerfLookupMiss, [] {
+  PLDHashTable t(&trivialOps, sizeof(PLDHashEntryStub));
+  FillBenchTable(t);
+  for (int j = 0; j < 20; j++) {
+    for (size_t i = 1; i <= kBenchLength; i++) {
+      ASSERT_FALSE(t.Search((const void*)(i * 8 + 4)));
+    }
+  }
+});
+
+MOZ_GTEST_BENCH(PLDHashTableTest, PerfChurn, [] {
+  PLDHashTable t(&trivialOps, sizeof(PLDHashEntryStub));
+  FillBenchTable(t);
+  for (size_t i = 1; i <= kBenchLength * 10; i++) {
+    t.Remove((const void*)(i * 8));
+    t.Add((const void*)((i + kBenchLength) * 8));
+  }
+  ASSERT_EQ(t.EntryCount(), kBenchLength);
+});
+
 // This test involves resizing a table repeatedly up to 512 MiB in size. On
 // 32-bit platforms (Win32, Android) it sometimes OOMs, causing the test to
 // fail. (See bug 931062 and bug 1267227.) Therefore, we only run it on 64-bit
@@ -5,13 +5,16 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "gtest/gtest.h"
+#include "gtest/MozGTestBench.h"  // MOZ_GTEST_BENCH
 
 #include <stdint.h>  // uint32_t
 
 #include "nsString.h"                // nsACString
+#include "nsTArray.h"                // nsTArray
 #include "nsThreadUtils.h"           // NS_ProcessNextEvent
 #include "mozilla/Atomics.h"         // Atomic
 #include "mozilla/EventQueue.h"      // EventQueuePriority
+#include "mozilla/Monitor.h"         // Monitor, MonitorAutoLock
 #include "mozilla/Mutex.h"           // Mutex, MutexAutoLock
 #include "mozilla/RefPtr.h"          // RefPtr, do_AddRef
 #include "mozilla/TaskController.h"  // TaskController, Task
@@ -211,4 +214,109 @@ TEST(TaskController, RescheduleOrderOffMainThread)
   ASSERT_TRUE(logger3.GetLog() == "333");
 }
 
+TEST(TaskController, FastPathDependency)
+{
+  Logger logger;
+
+  // The first task has no dependencies and takes the fast path, the second
+  // one has to wait for it in the task graph.
+  RefPtr<ReschedulingTask> offThreadTask1 =
+      new ReschedulingTask(Task::Kind::OffMainThreadOnly, &logger, "1");
+  RefPtr<ReschedulingTask> offThreadTask2 =
+      new ReschedulingTask(Task::Kind::OffMainThreadOnly, &logger, "2");
+
+  offThreadTask2->AddDependency(offThreadTask1.get());
+
+  TaskController::Get()->AddTask(do_AddRef(offThreadTask1));
+  TaskController::Get()->AddTask(do_AddRef(offThreadTask2));
+
+  uint32_t count = 0;
+  while (!offThreadTask2->IsDone() && count < 100) {
+    PR_Sleep(PR_MillisecondsToInterval(100));
+    count++;
+  }
+  ASSERT_TRUE(offThreadTask1->IsDone());
+  ASSERT_TRUE(offThreadTask2->IsDone());
+
+  ASSERT_TRUE(logger.GetLog() == "111222");
+}
+
+class CountdownTask : public Task {
+ public:
+  CountdownTask(Atomic<uint32_t>& aRemaining, Monitor& aMonitor)
+      : Task(Kind::OffMainThreadOnly, EventQueuePriority::Normal),
+        mRemaining(aRemaining),
+        mMonitor(aMonitor) {}
+
+  TaskResult Run() override {
+    if (--mRemaining == 0) {
+      MonitorAutoLock lock(mMonitor);
+      lock.Notify();
+    }
+    return TaskResult::Complete;
+  }
+
+#ifdef MOZ_COLLECTING_RUNNABLE_TELEMETRY
+  bool GetName(nsACString& aName) override {
+    aName.AssignLiteral("CountdownTask");
+    return true;
+  }
+#endif
+
+ private:
+  Atomic<uint32_t>& mRemaining;
+  Monitor& mMonitor;
+};
+
+struct DispatchState {
+  static constexpr uint32_t kTasksPerThread = 20000;
+
+  Atomic<uint32_t> mRemaining;
+  Monitor mMonitor{"DispatchState"};
+};
+
+static void DispatchTasks(void* aState) {
+  auto* state = static_cast<DispatchState*>(aState);
+  for (uint32_t i = 0; i < DispatchState::kTasksPerThread; i++) {
+    TaskController::Get()->AddTask(
+        MakeAndAddRef<CountdownTask>(state->mRemaining, state->mMonitor));
+  }
+}
+
+// Dispatch trivial off-main-thread tasks from aThreadCount threads at once and
+// wait for all of them to run. Comparing the timings for different thread
+// counts shows how dispatch throughput scales with contention.
+static void DispatchFromThreads(uint32_t aThreadCount) {
+  DispatchState state;
+  state.mRemaining = aThreadCount * DispatchState::kTasksPerThread;
+
+  nsTArray<PRThread*> threads;
+  for (uint32_t i = 0; i < aThreadCount; i++) {
+    PRThread* thread =
+        PR_CreateThread(PR_USER_THREAD, DispatchTasks, &state,
+                        PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD,
+                        PR_JOINABLE_THREAD, 0);
+    ASSERT_TRUE(thread);
+    threads.AppendElement(thread);
+  }
+
+  for (PRThread* thread : threads) {
+    PR_JoinThread(thread);
+  }
+
+  MonitorAutoLock lock(state.mMonitor);
+  while (state.mRemaining) {
+    lock.Wait();
+  }
+}
+
+MOZ_GTEST_BENCH(TaskController, PerfDispatch1Thread,
+                [] { DispatchFromThreads(1); });
+MOZ_GTEST_BENCH(TaskController, PerfDispatch2Threads,
+                [] { DispatchFromThreads(2); });
+MOZ_GTEST_BENCH(TaskController, PerfDispatch4Threads,
+                [] { DispatchFromThreads(4); });
+MOZ_GTEST_BENCH(TaskController, PerfDispatch8Threads,
+                [] { DispatchFromThreads(8); });
+
 }  // namespace TestTaskController
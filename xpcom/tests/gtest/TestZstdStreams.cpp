@@ -0,0 +1,350 @@
+/* -*- Mode: C++; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* vim: set ts=8 sts=2 et sw=2 tw=80: */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <type_traits>
+#include "gtest/gtest.h"
+#include "gtest/MozGTestBench.h"
+#include "Helpers.h"
+#include "mozilla/gtest/MozAssertions.h"
+#include "mozilla/SnappyCompressOutputStream.h"
+#include "mozilla/SnappyUncompressInputStream.h"
+#include "mozilla/ZstdCompressOutputStream.h"
+#include "mozilla/ZstdDictionary.h"
+#include "mozilla/ZstdUncompressInputStream.h"
+#include "nsIPipe.h"
+#include "nsPrintfCString.h"
+#include "nsStreamUtils.h"
+#include "nsString.h"
+#include "nsStringStream.h"
+#include "nsTArray.h"
+
+namespace {
+
+using mozilla::SnappyCompressOutputStream;
+using mozilla::SnappyUncompressInputStream;
+using mozilla::ZstdCompressDictionary;
+using mozilla::ZstdCompressOutputStream;
+using mozilla::ZstdUncompressDictionary;
+using mozilla::ZstdUncompressInputStream;
+
+static already_AddRefed<nsIOutputStream> ZstdCompressPipe(
+    nsIInputStream** aReaderOut,
+    int32_t aLevel = ZstdCompressOutputStream::kDefaultLevel,
+    ZstdCompressDictionary* aDictionary = nullptr) {
+  nsCOMPtr<nsIOutputStream> pipeWriter;
+  NS_NewPipe(aReaderOut, getter_AddRefs(pipeWriter));
+
+  nsCOMPtr<nsIOutputStream> compress =
+      new ZstdCompressOutputStream(pipeWriter, aLevel, aDictionary);
+  return compress.forget();
+}
+
+// Something shaped like the JSON which session store and other storage
+// consumers write: many small records with the same keys and similar values.
+static void CreateRecordData(uint32_t aNumRecords, nsTArray<char>& aDataOut) {
+  nsAutoCString data("[");
+  for (uint32_t i = 0; i < aNumRecords; ++i) {
+    data.Append(nsPrintfCString(
+        "%s{\"url\":\"https://www.example.com/articles/%u?ref=feed\","
+        "\"title\":\"Article %u - Example News\",\"lastAccessed\":%u,"
+        "\"scroll\":{\"scroll\":\"0,%u\"},\"formdata\":null,"
+        "\"triggeringPrincipal\":\"{\\\"3\\\":{}}\",\"docshellUUID\":"
+        "\"{%08x-5d5c-4b19-9d0a-3f1c2b6d%04x}\"}",
+        i ? "," : "", i * 37, i, 1700000000u + i * 1013, (i * 131) % 4000,
+        i * 2654435761u, i % 0xffff));
+  }
+  data.Append(']');
+  aDataOut.ReplaceElementsAt(0, aDataOut.Length(), data.get(), data.Length());
+}
+
+static nsresult ConsumeZstd(nsIInputStream* aSource, nsACString& aOutput,
+                            ZstdUncompressDictionary* aDictionary = nullptr) {
+  nsCOMPtr<nsIInputStream> uncompress =
+      new ZstdUncompressInputStream(aSource, aDictionary);
+  return NS_ConsumeStream(uncompress, UINT32_MAX, aOutput);
+}
+
+static void ExpectEqualData(const nsTArray<char>& aExpected,
+                            const nsACString& aActual) {
+  ASSERT_EQ(aExpected.Length(), aActual.Length());
+  for (uint32_t i = 0; i < aExpected.Length(); ++i) {
+    EXPECT_EQ(aExpected[i], aActual.BeginReading()[i]) << "Byte " << i;
+  }
+}
+
+// Verify the given number of bytes compresses to a smaller number of bytes.
+static void TestZstdCompress(uint32_t aNumBytes) {
+  ASSERT_GT(aNumBytes, 1024u);
+
+  nsCOMPtr<nsIInputStream> pipeReader;
+  nsCOMPtr<nsIOutputStream> compress =
+      ZstdCompressPipe(getter_AddRefs(pipeReader));
+  ASSERT_TRUE(compress);
+
+  nsTArray<char> inputData;
+  testing::CreateData(aNumBytes, inputData);
+
+  testing::WriteAllAndClose(compress, inputData);
+
+  nsAutoCString outputData;
+  nsresult rv = NS_ConsumeStream(pipeReader, UINT32_MAX, outputData);
+  ASSERT_NS_SUCCEEDED(rv);
+
+  ASSERT_LT(outputData.Length(), inputData.Length());
+}
+
+// Verify that the given number of bytes can be compressed and uncompressed
+// successfully at the given level.
+static void TestZstdCompressUncompress(
+    uint32_t aNumBytes,
+    int32_t aLevel = ZstdCompressOutputStream::kDefaultLevel) {
+  nsCOMPtr<nsIInputStream> pipeReader;
+  nsCOMPtr<nsIOutputStream> compress =
+      ZstdCompressPipe(getter_AddRefs(pipeReader), aLevel);
+  ASSERT_TRUE(compress);
+
+  nsTArray<char> inputData;
+  testing::CreateData(aNumBytes, inputData);
+
+  testing::WriteAllAndClose(compress, inputData);
+
+  nsAutoCString outputData;
+  nsresult rv = ConsumeZstd(pipeReader, outputData);
+  ASSERT_NS_SUCCEEDED(rv);
+
+  ExpectEqualData(inputData, outputData);
+}
+
+static void TestZstdUncompressCorrupt(const char* aCorruptData,
+                                      uint32_t aCorruptLength) {
+  nsCOMPtr<nsIInputStream> source;
+  nsresult rv = NS_NewByteInputStream(
+      getter_AddRefs(source), mozilla::Span(aCorruptData, aCorruptLength),
+      NS_ASSIGNMENT_DEPEND);
+  ASSERT_NS_SUCCEEDED(rv);
+
+  nsAutoCString outputData;
+  rv = ConsumeZstd(source, outputData);
+  ASSERT_EQ(NS_ERROR_CORRUPTED_CONTENT, rv);
+}
+
+template <typename CompressStream>
+static void CompressRecords(
+    const nsTArray<char>& aInput, nsACString& aOutput,
+    int32_t aLevel = ZstdCompressOutputStream::kDefaultLevel) {
+  nsCOMPtr<nsIInputStream> pipeReader;
+  nsCOMPtr<nsIOutputStream> pipeWriter;
+  NS_NewPipe(getter_AddRefs(pipeReader), getter_AddRefs(pipeWriter), 0,
+             UINT32_MAX);
+
+  nsCOMPtr<nsIOutputStream> compress;
+  if constexpr (std::is_same_v<CompressStream, ZstdCompressOutputStream>) {
+    compress = new ZstdCompressOutputStream(pipeWriter, aLevel);
+  } else {
+    compress = new CompressStream(pipeWriter);
+  }
+  testing::WriteAllAndClose(compress, aInput);
+
+  ASSERT_NS_SUCCEEDED(NS_ConsumeStream(pipeReader, UINT32_MAX, aOutput));
+}
+
+template <typename UncompressStream>
+static void UncompressRecords(const nsACString& aCompressed,
+                              uint32_t aExpectedLength) {
+  nsCOMPtr<nsIInputStream> source;
+  ASSERT_NS_SUCCEEDED(NS_NewCStringInputStream(getter_AddRefs(source),
+                                               nsCString(aCompressed)));
+
+  nsCOMPtr<nsIInputStream> uncompress = new UncompressStream(source);
+  nsAutoCString output;
+  ASSERT_NS_SUCCEEDED(NS_ConsumeStream(uncompress, UINT32_MAX, output));
+  ASSERT_EQ(output.Length(), aExpectedLength);
+}
+
+static const uint32_t kBenchRecords = 10000;
+
+}  // namespace
+
+TEST(ZstdStream, Compress_32k)
+{ TestZstdCompress(32 * 1024); }
+
+TEST(ZstdStream, Compress_128k)
+{ TestZstdCompress(128 * 1024); }
+
+TEST(ZstdStream, CompressUncompress_0)
+{ TestZstdCompressUncompress(0); }
+
+TEST(ZstdStream, CompressUncompress_1)
+{ TestZstdCompressUncompress(1); }
+
+TEST(ZstdStream, CompressUncompress_1k)
+{ TestZstdCompressUncompress(1024); }
+
+TEST(ZstdStream, CompressUncompress_128k)
+{ TestZstdCompressUncompress(128 * 1024); }
+
+// Test buffers that are not exactly power-of-2 in length to try to
+// exercise more edge cases.  The number 13 is arbitrary.
+
+TEST(ZstdStream, CompressUncompress_256k_less_13)
+{ TestZstdCompressUncompress((256 * 1024) - 13); }
+
+TEST(ZstdStream, CompressUncompress_256k_plus_13)
+{ TestZstdCompressUncompress((256 * 1024) + 13); }
+
+TEST(ZstdStream, CompressUncompress_1m_Level1)
+{ TestZstdCompressUncompress(1024 * 1024, 1); }
+
+TEST(ZstdStream, CompressUncompress_1m_Level19)
+{ TestZstdCompressUncompress(1024 * 1024, 19); }
+
+TEST(ZstdStream, CompressUncompress_OutOfRangeLevel)
+{ TestZstdCompressUncompress(32 * 1024, 1000); }
+
+TEST(ZstdStream, CompressUncompress_FlushBetweenWrites)
+{
+  nsCOMPtr<nsIInputStream> pipeReader;
+  nsCOMPtr<nsIOutputStream> compress =
+      ZstdCompressPipe(getter_AddRefs(pipeReader));
+  ASSERT_TRUE(compress);
+
+  nsTArray<char> inputData;
+  testing::CreateData(64 * 1024, inputData);
+
+  testing::Write(compress, inputData, 0, 1000);
+  ASSERT_NS_SUCCEEDED(compress->Flush());
+  testing::Write(compress, inputData, 1000, inputData.Length() - 1000);
+  ASSERT_NS_SUCCEEDED(compress->Close());
+
+  nsAutoCString outputData;
+  ASSERT_NS_SUCCEEDED(ConsumeZstd(pipeReader, outputData));
+  ExpectEqualData(inputData, outputData);
+}
+
+TEST(ZstdStream, CompressUncompress_Dictionary)
+{
+  nsTArray<char> dictionaryData;
+  CreateRecordData(200, dictionaryData);
+  auto dictionarySpan = mozilla::Span(
+      reinterpret_cast<const uint8_t*>(dictionaryData.Elements()),
+      dictionaryData.Length());
+
+  RefPtr<ZstdCompressDictionary> compressDictionary =
+      ZstdCompressDictionary::Create(dictionarySpan,
+                                     ZstdCompressOutputStream::kDefaultLevel);
+  ASSERT_TRUE(compressDictionary);
+  RefPtr<ZstdUncompressDictionary> uncompressDictionary =
+      ZstdUncompressDictionary::Create(dictionarySpan);
+  ASSERT_TRUE(uncompressDictionary);
+
+  nsTArray<char> inputData;
+  CreateRecordData(5, inputData);
+
+  nsCOMPtr<nsIInputStream> pipeReader;
+  nsCOMPtr<nsIOutputStream> compress =
+      ZstdCompressPipe(getter_AddRefs(pipeReader),
+                   ZstdCompressOutputStream::kDefaultLevel, compressDictionary);
+  ASSERT_TRUE(compress);
+  testing::WriteAllAndClose(compress, inputData);
+  nsAutoCString compressed;
+  ASSERT_NS_SUCCEEDED(NS_ConsumeStream(pipeReader, UINT32_MAX, compressed));
+
+  // A few records on their own compress poorly; with a dictionary of similar
+  // records they should shrink more.
+  nsAutoCString compressedWithoutDictionary;
+  CompressRecords<ZstdCompressOutputStream>(inputData,
+                                            compressedWithoutDictionary);
+  EXPECT_LT(compressed.Length(), compressedWithoutDictionary.Length());
+
+  nsCOMPtr<nsIInputStream> source;
+  ASSERT_NS_SUCCEEDED(
+      NS_NewCStringInputStream(getter_AddRefs(source), compressed));
+  nsAutoCString outputData;
+  ASSERT_NS_SUCCEEDED(ConsumeZstd(source, outputData, uncompressDictionary));
+  ExpectEqualData(inputData, outputData);
+
+  // Without the dictionary the data can't be read back.
+  ASSERT_NS_SUCCEEDED(
+      NS_NewCStringInputStream(getter_AddRefs(source), compressed));
+  outputData.Truncate();
+  EXPECT_EQ(NS_ERROR_CORRUPTED_CONTENT, ConsumeZstd(source, outputData));
+}
+
+TEST(ZstdStream, CompressesRecordsBetterThanSnappy)
+{
+  nsTArray<char> inputData;
+  CreateRecordData(1000, inputData);
+
+  nsAutoCString snappy;
+  CompressRecords<SnappyCompressOutputStream>(inputData, snappy);
+  nsAutoCString zstd;
+  CompressRecords<ZstdCompressOutputStream>(inputData, zstd);
+
+  EXPECT_LT(zstd.Length(), snappy.Length());
+}
+
+TEST(ZstdStream, UncompressCorruptFrame)
+{
+  static const char data[] = "This is not a valid compressed stream";
+  TestZstdUncompressCorrupt(data, strlen(data));
+}
+
+TEST(ZstdStream, UncompressTruncatedFrame)
+{
+  nsTArray<char> inputData;
+  testing::CreateData(32 * 1024, inputData);
+
+  nsAutoCString compressed;
+  CompressRecords<ZstdCompressOutputStream>(inputData, compressed);
+  TestZstdUncompressCorrupt(compressed.get(), compressed.Length() - 1);
+}
+
+MOZ_GTEST_BENCH(ZstdStream, PerfCompressRecords_Snappy, [] {
+  nsTArray<char> inputData;
+  CreateRecordData(kBenchRecords, inputData);
+  nsAutoCString output;
+  CompressRecords<SnappyCompressOutputStream>(inputData, output);
+});
+
+MOZ_GTEST_BENCH(ZstdStream, PerfCompressRecords_Level1, [] {
+  nsTArray<char> inputData;
+  CreateRecordData(kBenchRecords, inputData);
+  nsAutoCString output;
+  CompressRecords<ZstdCompressOutputStream>(inputData, output, 1);
+});
+
+MOZ_GTEST_BENCH(ZstdStream, PerfCompressRecords_Level3, [] {
+  nsTArray<char> inputData;
+  CreateRecordData(kBenchRecords, inputData);
+  nsAutoCString output;
+  CompressRecords<ZstdCompressOutputStream>(inputData, output, 3);
+});
+
+MOZ_GTEST_BENCH(ZstdStream, PerfCompressRecords_Level9, [] {
+  nsTArray<char> inputData;
+  CreateRecordData(kBenchRecords, inputData);
+  nsAutoCString output;
+  CompressRecords<ZstdCompressOutputStream>(inputData, output, 9);
+});
+
+MOZ_GTEST_BENCH(ZstdStream, PerfUncompressRecords_Snappy, [] {
+  nsTArray<char> inputData;
+  CreateRecordData(kBenchRecords, inputData);
+  nsAutoCString compressed;
+  CompressRecords<SnappyCompressOutputStream>(inputData, compressed);
+  UncompressRecords<SnappyUncompressInputStream>(compressed,
+                                                 inputData.Length());
+});
+
+MOZ_GTEST_BENCH(ZstdStream, PerfUncompressRecords_Zstd, [] {
+  nsTArray<char> inputData;
+  CreateRecordData(kBenchRecords, inputData);
+  nsAutoCString compressed;
+  CompressRecords<ZstdCompressOutputStream>(inputData, compressed);
+  UncompressRecords<ZstdUncompressInputStream>(compressed,
+                                               inputData.Length());
+});
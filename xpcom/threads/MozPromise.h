@@ -457,49 +457,75 @@ class MozPromise : public MozPromiseBase {
   /*
    * A ThenValue tracks a single consumer waiting on the promise. When a
    * consumer invokes promise->Then(...), a ThenValue is created. Once the
-   * Promise is resolved or rejected, a {Resolve,Reject}Runnable is dispatched,
-   * which invokes the resolve/reject method and then deletes the ThenValue.
+   * Promise is resolved or rejected, the ThenValue's ResolveOrRejectRunnable
+   * is dispatched, which invokes the resolve/reject method.
    */
   class ThenValueBase : public Request {
     friend class MozPromise;
     static const uint32_t sMagic = 0xfadece11;
 
    public:
+    /*
+     * Each ThenValue is dispatched at most once, so rather than allocating a
+     * runnable for that the ThenValue embeds one.  References to the runnable
+     * keep the ThenValue alive.
+     */
     class ResolveOrRejectRunnable final
         : public PrioritizableCancelableRunnable {
      public:
-      ResolveOrRejectRunnable(ThenValueBase* aThenValue, MozPromise* aPromise)
+      explicit ResolveOrRejectRunnable(ThenValueBase* aThenValue)
           : PrioritizableCancelableRunnable(
-                aPromise->mPriority,
+                nsIRunnablePriority::PRIORITY_NORMAL,
                 "MozPromise::ThenValueBase::ResolveOrRejectRunnable"),
-            mThenValue(aThenValue),
-            mPromise(aPromise) {
-        MOZ_DIAGNOSTIC_ASSERT(!mPromise->IsPending());
+            mThenValue(aThenValue) {}
+
+      ~ResolveOrRejectRunnable() = default;
+
+      void Prepare(MozPromise* aPromise) {
+        MOZ_DIAGNOSTIC_ASSERT(!aPromise->IsPending());
+        MOZ_DIAGNOSTIC_ASSERT(!mPromise, "Dispatched more than once");
+        mPromise = aPromise;
+        mPromisePriority = aPromise->mPriority;
+      }
+
+      NS_IMETHOD_(MozExternalRefCountType) AddRef() override {
+        ++mRefCnt;
+        return mThenValue->AddRef();
       }
 
-      ~ResolveOrRejectRunnable() {
-        if (mThenValue) {
+      NS_IMETHOD_(MozExternalRefCountType) Release() override {
+        if (--mRefCnt == 0 && mPromise) {
+          // We were dropped without running, e.g. because dispatching failed.
+          mPromise = nullptr;
           mThenValue->AssertIsDead();
         }
+        return mThenValue->Release();
       }
 
       NS_IMETHOD Run() override {
         PROMISE_LOG("ResolveOrRejectRunnable::Run() [this=%p]", this);
-        mThenValue->DoResolveOrReject(mPromise->Value());
-        mThenValue = nullptr;
-        mPromise = nullptr;
+        RefPtr<MozPromise> promise = std::move(mPromise);
+        mThenValue->DoResolveOrReject(promise->Value());
         return NS_OK;
       }
 
       nsresult Cancel() override { return Run(); }
 
+      NS_IMETHOD GetPriority(uint32_t* aPriority) override {
+        *aPriority = mPromisePriority;
+        return NS_OK;
+      }
+
      private:
-      RefPtr<ThenValueBase> mThenValue;
+      ThenValueBase* const mThenValue;
       RefPtr<MozPromise> mPromise;
+      uint32_t mPromisePriority = nsIRunnablePriority::PRIORITY_NORMAL;
     };
 
     ThenValueBase(nsISerialEventTarget* aResponseTarget, StaticString aCallSite)
-        : mResponseTarget(aResponseTarget), mCallSite(aCallSite) {
+        : mResponseTarget(aResponseTarget),
+          mCallSite(aCallSite),
+          mRunnable(this) {
       MOZ_ASSERT(aResponseTarget);
     }
 
@@ -540,7 +566,8 @@ class MozPromise : public MozPromiseBase {
       aPromise->mMutex.AssertCurrentThreadOwns();
       MOZ_ASSERT(!aPromise->IsPending());
 
-      nsCOMPtr<nsIRunnable> r = new ResolveOrRejectRunnable(this, aPromise);
+      mRunnable.Prepare(aPromise);
+      nsCOMPtr<nsIRunnable> r = &mRunnable;
       PROMISE_LOG(
           "%s Then() call made from %s [Runnable=%p, Promise=%p, ThenValue=%p] "
           "%s dispatch",
@@ -639,6 +666,7 @@ class MozPromise : public MozPromiseBase {
 #ifdef MOZ_DIAGNOSTIC_ASSERT_ENABLED
     Maybe<nsresult> mDispatchRv;
 #endif
+    ResolveOrRejectRunnable mRunnable;
   };
 
   /*
@@ -1329,7 +1357,9 @@ class MozPromise : public MozPromiseBase {
 #ifdef PROMISE_DEBUG
   uint32_t mMagic2 = sMagic;
 #endif
-  nsTArray<RefPtr<Private>> mChainedPromises;
+  // Chaining a completion promise to the promise returned by its callback is
+  // the common case, so avoid a heap allocation for a single element.
+  AutoTArray<RefPtr<Private>, 1> mChainedPromises;
 #ifdef PROMISE_DEBUG
   uint32_t mMagic3 = sMagic;
 #endif
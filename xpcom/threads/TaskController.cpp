@@ -10,6 +10,8 @@
 #include "nsIRunnable.h"
 #include "nsThreadUtils.h"
 #include <algorithm>
+#include <array>
+#include <deque>
 #include "GeckoProfiler.h"
 #include "mozilla/AppShutdown.h"
 #include "mozilla/BackgroundHangMonitor.h"
@@ -23,7 +25,9 @@
 #include "mozilla/SchedulerGroup.h"
 #include "mozilla/ScopeExit.h"
 #include "mozilla/FlowMarkers.h"
+#include "mozilla/MathAlgorithms.h"
 #include "mozilla/StaticPrefs_memory.h"
+#include "mozilla/ThreadLocal.h"
 #include "nsIThreadInternal.h"
 #include "nsThread.h"
 #include "prenv.h"
@@ -38,6 +42,48 @@ std::atomic<uint64_t> Task::sCurrentTaskSeqNo = 0;
 const int32_t kMinimumPoolThreadCount = 2;
 const int32_t kMaximumPoolThreadCount = 8;
 
+// Queue of fast path tasks owned by a pool thread. Tasks are bucketed by
+// priority, and tasks of the same priority run in the order they were queued.
+class FastTaskQueue {
+ public:
+  bool IsEmpty() const { return !mNonEmptyBuckets; }
+
+  // A bit for every priority bucket holding tasks. This may be read without
+  // the queue's mutex, in which case it is only a hint.
+  uint32_t NonEmptyBuckets() const { return mNonEmptyBuckets; }
+
+  void Push(RefPtr<Task>&& aTask, bool aFront) {
+    size_t bucket = std::min<uint32_t>(aTask->GetPriority(), kBucketCount - 1);
+    if (aFront) {
+      mBuckets[bucket].push_front(std::move(aTask));
+    } else {
+      mBuckets[bucket].push_back(std::move(aTask));
+    }
+    mNonEmptyBuckets |= 1u << bucket;
+  }
+
+  RefPtr<Task> Pop() {
+    if (IsEmpty()) {
+      return nullptr;
+    }
+    size_t bucket = FloorLog2(mNonEmptyBuckets.load());
+    RefPtr<Task> task = std::move(mBuckets[bucket].front());
+    mBuckets[bucket].pop_front();
+    if (mBuckets[bucket].empty()) {
+      mNonEmptyBuckets &= ~(1u << bucket);
+    }
+    return task;
+  }
+
+ private:
+  // Priorities above the last EventQueuePriority share the top bucket.
+  static constexpr size_t kBucketCount = size_t(EventQueuePriority::Invalid);
+  static_assert(kBucketCount <= 32);
+
+  std::array<std::deque<RefPtr<Task>>, kBucketCount> mBuckets;
+  std::atomic<uint32_t> mNonEmptyBuckets = 0;
+};
+
 struct PoolThread {
   const size_t mIndex;
   PRThread* mThread = nullptr;
@@ -45,14 +91,37 @@ struct PoolThread {
   CondVar mThreadCV;
   RefPtr<Task> mCurrentTask;
 
+  // Mirrors whether mCurrentTask is set, so the thread can notice a task
+  // being assigned to it by the task graph while running fast path tasks
+  // without holding the GraphMutex. SelectThread also sets it briefly while
+  // it checks whether the thread is free.
+  std::atomic<bool> mHasGraphTask = false;
+
+  // Whether the thread is in the middle of running a fast path task, in which
+  // case it can't start a task from the graph until that one returns.
+  std::atomic<bool> mRunningFastTask = false;
+
+  // Whether the thread is waiting on mThreadCV. Protected by the GraphMutex.
+  bool mSleeping = false;
+
   // This may be higher than mCurrentTask's priority due to priority
   // propagation. This is -only- valid when mCurrentTask != nullptr.
   uint32_t mEffectiveTaskPriority = 0;
 
+  // Fast path tasks queued on this thread. Other pool threads steal from this
+  // queue when theirs is empty.
+  Mutex mQueueMutex MOZ_UNANNOTATED;
+  FastTaskQueue mQueue;
+
   PoolThread(size_t aIndex, Mutex& aGraphMutex)
-      : mIndex(aIndex), mThreadCV(aGraphMutex, "PoolThread::mThreadCV") {}
+      : mIndex(aIndex),
+        mThreadCV(aGraphMutex, "PoolThread::mThreadCV"),
+        mQueueMutex("PoolThread::mQueueMutex") {}
 };
 
+// The pool thread running on the current thread, if any.
+static MOZ_THREAD_LOCAL(PoolThread*) sCurrentPoolThread;
+
 /* static */
 int32_t TaskController::GetPoolThreadCount() {
   if (PR_GetEnv("MOZ_TASKCONTROLLER_THREADCOUNT")) {
@@ -311,6 +380,7 @@ static const char kMinPurgeReuseGracePref[] =
 
 void TaskController::Initialize() {
   MOZ_ASSERT(!sSingleton);
+  sCurrentPoolThread.infallibleInit();
   sSingleton = new TaskController();
 }
 
@@ -342,6 +412,7 @@ void TaskController::InitializeThreadPool() {
   mThreadPoolInitialized = true;
 
   int32_t poolSize = GetPoolThreadCount();
+  mPoolThreads.reserve(poolSize);
   for (int32_t i = 0; i < poolSize; i++) {
     auto thread = MakeUnique<PoolThread>(i, mGraphMutex);
     thread->mThread =
@@ -407,6 +478,9 @@ void TaskController::ShutdownThreadPoolInternal() {
   }
 
   MOZ_ASSERT(mIdleThreadCount == mPoolThreads.size());
+  // Like the graph's threadable tasks, nothing may be left on the fast path
+  // queues once the pool threads are gone.
+  MOZ_ASSERT(!mPendingFastTaskCount);
 }
 
 void TaskController::RunPoolThread(PoolThread* aThread) {
@@ -417,11 +491,40 @@ void TaskController::RunPoolThread(PoolThread* aThread) {
   threadName.AppendInt(static_cast<int64_t>(aThread->mIndex));
   AUTO_PROFILER_REGISTER_THREAD(threadName.get());
 
+  sCurrentPoolThread.set(aThread);
+
   MutexAutoLock lock(mGraphMutex);
   while (!mShuttingDown) {
     if (!aThread->mCurrentTask) {
-      AUTO_PROFILER_LABEL("TaskController::RunPoolThread", IDLE);
-      aThread->mThreadCV.Wait();
+      // Pick up graph tasks which couldn't be dispatched while every idle
+      // thread was running fast path tasks.
+      if (mGraphTaskWaiting) {
+        mGraphTaskWaiting = false;
+        DispatchThreadableTasks(lock);
+        if (aThread->mCurrentTask) {
+          continue;
+        }
+      }
+
+      if (mPendingFastTaskCount) {
+        MutexAutoUnlock unlock(mGraphMutex);
+        RunFastTasks(aThread);
+        continue;
+      }
+
+      // Advertise that we are going to sleep before checking the fast path
+      // queues one last time, so that PushFastTask either sees us sleeping
+      // and wakes us, or we see its task.
+      aThread->mSleeping = true;
+      mSleepingThreadCount++;
+      if (!mPendingFastTaskCount) {
+        AUTO_PROFILER_LABEL("TaskController::RunPoolThread", IDLE);
+        aThread->mThreadCV.Wait();
+      }
+      if (aThread->mSleeping) {
+        aThread->mSleeping = false;
+        mSleepingThreadCount--;
+      }
       continue;
     }
 
@@ -460,6 +563,7 @@ void TaskController::RunPoolThread(PoolThread* aThread) {
 
     // Clear the current task to mark ourselves idle.
     RefPtr<Task> lastTask = aThread->mCurrentTask.forget();
+    aThread->mHasGraphTask = false;
     mIdleThreadCount++;
     MOZ_ASSERT(mIdleThreadCount <= mPoolThreads.size());
 
@@ -477,6 +581,8 @@ void TaskController::RunPoolThread(PoolThread* aThread) {
 
   MOZ_ASSERT(mThreadableTasks.empty());
 
+  sCurrentPoolThread.set(nullptr);
+
   IOInterposer::UnregisterCurrentThread();
 }
 
@@ -484,14 +590,30 @@ void TaskController::AddTask(already_AddRefed<Task>&& aTask) {
   RefPtr<Task> task(aTask);
 
   if (task->GetKind() == Task::Kind::OffMainThreadOnly) {
-    MutexAutoLock lock(mPoolInitializationMutex);
-    if (!mThreadPoolInitialized) {
-      InitializeThreadPool();
+    {
+      MutexAutoLock lock(mPoolInitializationMutex);
+      if (!mThreadPoolInitialized) {
+        InitializeThreadPool();
+      }
+    }
+
+    // Tasks with a manager go through the graph, which keeps the manager's
+    // task count and priority modifier up to date.
+    if (task->mDependencies.empty() && !task->GetManager()) {
+      AddFastTask(std::move(task));
+      return;
     }
   }
 
   MutexAutoLock lock(mGraphMutex);
 
+  // Completing a fast path task only consults the graph if it knows someone
+  // depends on it. This must be set before we look at whether the
+  // dependencies have completed, see DidCompleteFastTask.
+  for (const RefPtr<Task>& dependency : task->mDependencies) {
+    dependency->mHasDependents = true;
+  }
+
   if (TaskManager* manager = task->GetManager()) {
     if (manager->mTaskCount == 0) {
       mTaskManagers.insert(manager);
@@ -544,6 +666,148 @@ void TaskController::AddTask(already_AddRefed<Task>&& aTask) {
   MaybeInterruptTask(*insertion.first, lock);
 }
 
+void TaskController::AddFastTask(RefPtr<Task>&& aTask) {
+  MOZ_ASSERT(aTask->GetKind() == Task::Kind::OffMainThreadOnly);
+  MOZ_ASSERT(aTask->mDependencies.empty());
+  MOZ_ASSERT(!aTask->GetManager());
+
+  aTask->mOnFastPath = true;
+
+  if (profiler_is_active_and_unpaused()) {
+    aTask->mInsertionTime = TimeStamp::Now();
+  }
+
+#ifdef DEBUG
+  aTask->mIsInGraph = true;
+#endif
+
+  LogTask::LogDispatch(aTask);
+  PROFILER_MARKER("TaskController::AddTask", OTHER, {}, FlowMarker,
+                  Flow::FromPointer(aTask.get()));
+
+  // Tasks dispatched from a pool thread stay on that thread's queue for
+  // locality. Tasks dispatched from elsewhere are spread over all queues.
+  PoolThread* thread = sCurrentPoolThread.get();
+  if (!thread) {
+    thread = mPoolThreads[mNextFastQueue++ % mPoolThreads.size()].get();
+  }
+  PushFastTask(thread, std::move(aTask), /* aFront = */ false);
+}
+
+void TaskController::PushFastTask(PoolThread* aThread, RefPtr<Task>&& aTask,
+                                  bool aFront) {
+  {
+    MutexAutoLock lock(aThread->mQueueMutex);
+    aThread->mQueue.Push(std::move(aTask), aFront);
+    mPendingFastTaskCount++;
+  }
+
+  if (mSleepingThreadCount) {
+    MutexAutoLock lock(mGraphMutex);
+    WakeSleepingThread(lock);
+  }
+}
+
+RefPtr<Task> TaskController::TakeFastTask(PoolThread* aThread) {
+  // Take from the queue with the highest priority tasks, so that local low
+  // priority work doesn't hold up more important tasks queued on another
+  // thread. Among queues with tasks of that priority our own comes first,
+  // then the others in order. The buckets are checked without the queue
+  // mutexes, so another thread may beat us to the task we picked; we then
+  // take whatever that queue has left, or look again if it is empty.
+  size_t count = mPoolThreads.size();
+  while (mPendingFastTaskCount) {
+    PoolThread* victim = nullptr;
+    uint32_t highestBucket = 0;
+    for (size_t i = 0; i < count; i++) {
+      PoolThread* thread = mPoolThreads[(aThread->mIndex + i) % count].get();
+      uint32_t buckets = thread->mQueue.NonEmptyBuckets();
+      if (buckets && (!victim || FloorLog2(buckets) > highestBucket)) {
+        victim = thread;
+        highestBucket = FloorLog2(buckets);
+      }
+    }
+    if (!victim) {
+      return nullptr;
+    }
+
+    MutexAutoLock lock(victim->mQueueMutex);
+    if (RefPtr<Task> task = victim->mQueue.Pop()) {
+      mPendingFastTaskCount--;
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void TaskController::RunFastTasks(PoolThread* aThread) {
+  // Tasks from the graph take precedence, since they may be blocking other
+  // work. Go back to the graph when one has been assigned to us, or when one
+  // is waiting for a thread that isn't running a fast path task.
+  while (!mGraphTaskWaiting) {
+    // Advertise that we are running a fast path task before checking for a
+    // graph task. SelectThread does the opposite, so it either sees us busy or
+    // we see the task it assigned.
+    aThread->mRunningFastTask = true;
+    RefPtr<Task> task;
+    if (!aThread->mHasGraphTask) {
+      task = TakeFastTask(aThread);
+    }
+    if (!task) {
+      aThread->mRunningFastTask = false;
+      return;
+    }
+
+    Task::TaskResult result = RunTask(task);
+    aThread->mRunningFastTask = false;
+
+    if (result != Task::TaskResult::Complete) {
+      // Presumably this task was interrupted, run it again at the front of
+      // its priority.
+      PushFastTask(aThread, std::move(task), /* aFront = */ true);
+      continue;
+    }
+
+    DidCompleteFastTask(task);
+  }
+}
+
+void TaskController::DidCompleteFastTask(Task* aTask) {
+  MOZ_ASSERT(aTask->mOnFastPath);
+
+#ifdef DEBUG
+  aTask->mIsInGraph = false;
+#endif
+
+  // AddTask sets mHasDependents on a dependency before checking whether it
+  // has completed, and we do the opposite here, so a task depending on this
+  // one is either dispatched by AddTask or by us.
+  aTask->mCompleted = true;
+  if (!aTask->mHasDependents) {
+    return;
+  }
+
+  MutexAutoLock lock(mGraphMutex);
+
+  // This may have unblocked main thread tasks as well as threadable ones.
+  mMayHaveMainThreadTask = true;
+  EnsureMainThreadTasksScheduled();
+  MaybeInterruptTask(GetHighestPriorityMTTask(), lock);
+
+  DispatchThreadableTasks(lock);
+}
+
+void TaskController::WakeSleepingThread(const MutexAutoLock& aProofOfLock) {
+  for (auto& thread : mPoolThreads) {
+    if (thread->mSleeping) {
+      thread->mSleeping = false;
+      mSleepingThreadCount--;
+      thread->mThreadCV.Notify();
+      return;
+    }
+  }
+}
+
 void TaskController::DispatchThreadableTasks(
     const MutexAutoLock& aProofOfLock) {
   while (MaybeDispatchOneThreadableTask(aProofOfLock)) {
@@ -557,13 +821,20 @@ bool TaskController::MaybeDispatchOneThreadableTask(
     return false;
   }
 
+  PoolThread* thread = SelectThread(aProofOfLock);
+  if (!thread) {
+    // The idle threads are all running fast path tasks. The first one to
+    // finish comes back to the graph for this task.
+    mGraphTaskWaiting = true;
+    return false;
+  }
+
   auto [task, effetivePriority] = TakeThreadableTaskToRun(aProofOfLock);
   if (!task) {
+    thread->mHasGraphTask = false;
     return false;
   }
 
-  PoolThread* thread = SelectThread(aProofOfLock);
-
   MOZ_ASSERT(!thread->mCurrentTask);
   MOZ_ASSERT(mIdleThreadCount != 0);
   thread->mCurrentTask = task;
@@ -588,7 +859,10 @@ TaskController::TaskToRun TaskController::TakeThreadableTaskToRun(
       task = nextTask;
     }
 
-    if (task->GetKind() != Task::Kind::MainThreadOnly && !task->mInProgress) {
+    // Fast path tasks are not in mThreadableTasks and will be run by the pool
+    // threads on their own; whatever depends on them has to wait.
+    if (task->GetKind() != Task::Kind::MainThreadOnly && !task->mInProgress &&
+        !task->mOnFastPath) {
       TaskToRun taskToRun{task, rootTask->GetPriority()};
       mThreadableTasks.erase(task->mIterator);
       task->mIterator = mThreadableTasks.end();
@@ -602,14 +876,32 @@ TaskController::TaskToRun TaskController::TakeThreadableTaskToRun(
 PoolThread* TaskController::SelectThread(const MutexAutoLock& aProofOfLock) {
   MOZ_ASSERT(mIdleThreadCount != 0);
 
-  // This just picks the first free thread.
+  // This picks the first sleeping thread, or else the first thread without a
+  // task from the graph that is between fast path tasks. Threads in the
+  // middle of a fast path task may be running for a long time, so they are
+  // never picked; if that leaves nothing, this returns null.
+  for (auto& thread : mPoolThreads) {
+    if (!thread->mCurrentTask && thread->mSleeping) {
+      thread->mHasGraphTask = true;
+      return thread.get();
+    }
+  }
+
   for (auto& thread : mPoolThreads) {
-    if (!thread->mCurrentTask) {
+    if (thread->mCurrentTask) {
+      continue;
+    }
+    // Claim the thread before checking whether it is running a fast path
+    // task, see RunFastTasks. If it is, it may have seen the claim and gone
+    // back to the graph, where it finds mGraphTaskWaiting set.
+    thread->mHasGraphTask = true;
+    if (!thread->mRunningFastTask) {
       return thread.get();
     }
+    thread->mHasGraphTask = false;
   }
 
-  MOZ_CRASH("Couldn't find idle thread");
+  return nullptr;
 }
 
 void TaskController::WaitForTaskOrMessage() {
@@ -674,6 +966,11 @@ void TaskController::ProcessPendingMTTask(bool aMayWait) {
 
 void TaskController::ReprioritizeTask(Task* aTask, uint32_t aPriority) {
   MutexAutoLock lock(mGraphMutex);
+  if (aTask->mOnFastPath) {
+    aTask->mPriority = aPriority;
+    return;
+  }
+
   std::set<RefPtr<Task>, Task::PriorityCompare>* queue = &mMainThreadTasks;
   if (aTask->GetKind() == Task::Kind::OffMainThreadOnly) {
     queue = &mThreadableTasks;
@@ -1336,8 +1633,9 @@ void TaskController::MaybeInterruptTask(Task* aTask,
 
   Task* finalDependency = GetFinalDependency(aTask);
 
-  if (finalDependency->mInProgress) {
+  if (finalDependency->mInProgress || finalDependency->mOnFastPath) {
     // No need to wake anything, we can't schedule this task right now anyway.
+    // Fast path tasks let the graph know when they complete.
     return;
   }
 
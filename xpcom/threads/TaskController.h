@@ -52,6 +52,20 @@ const EventQueuePriority kDefaultPriorityValue = EventQueuePriority::Normal;
 // function is used to schedule work. The ReprioritizeTask function may be used
 // to change the priority of a task already in the task graph, without
 // unscheduling it.
+//
+// Off main thread tasks without dependencies or a TaskManager take a fast path
+// which bypasses the task graph, and come with weaker guarantees:
+// - Tasks queued on the same pool thread run in priority order, and in the
+//   order they were added within a priority. Tasks queued on different
+//   threads may run in any order relative to each other, though a pool
+//   thread looking for work takes from the queue with the highest priority
+//   tasks first.
+// - Their priority is fixed when they are queued. Priority propagated from
+//   tasks depending on them does not reach them, and ReprioritizeTask only
+//   affects where they are queued if they are rescheduled.
+// - A low priority fast path task which is already running delays higher
+//   priority work for that thread until it returns; RequestInterrupt is not
+//   called for them.
 
 // The TaskManager is the baseclass used to atomically manage a large set of
 // tasks. API users reimplementing TaskManager may reimplement a number of
@@ -236,17 +250,29 @@ class Task {
 
   RefPtr<TaskManager> mTaskManager;
 
-  // Access to these variables is protected by the GraphMutex.
+  // Access to these variables is protected by the GraphMutex, except for
+  // tasks on the fast path (see TaskController::AddFastTask), whose
+  // completion is published without it.
   Kind mKind;
-  bool mCompleted = false;
+  std::atomic<bool> mCompleted = false;
   bool mInProgress = false;
 #ifdef DEBUG
   bool mIsInGraph = false;
 #endif
 
+  // Set for tasks which were added without dependencies or a manager, and are
+  // queued on the pool threads rather than in the task graph. Immutable once
+  // the task has been added to the TaskController.
+  bool mOnFastPath = false;
+
+  // Set when a task in the graph depends on this one, so that completing a
+  // fast path task only takes the GraphMutex when someone may be waiting on
+  // it.
+  std::atomic<bool> mHasDependents = false;
+
   static std::atomic<uint64_t> sCurrentTaskSeqNo;
   int64_t mSeqNo;
-  uint32_t mPriority;
+  std::atomic<uint32_t> mPriority;
   // Modifier currently being applied to this task by its taskmanager.
   int32_t mPriorityModifier = 0;
   // Time this task was inserted into the task graph, this is used by the
@@ -337,7 +363,9 @@ class TaskController {
   void ProcessPendingMTTask(bool aMayWait = false);
 
   // This allows reprioritization of a task already in the task graph.
-  // This may be called on any thread.
+  // This may be called on any thread. Tasks on the fast path which are already
+  // queued keep their position, the new priority is used if they are
+  // rescheduled.
   void ReprioritizeTask(Task* aTask, uint32_t aPriority);
 
   void DispatchRunnable(already_AddRefed<nsIRunnable>&& aRunnable,
@@ -394,6 +422,16 @@ class TaskController {
   bool MaybeDispatchOneThreadableTask(const MutexAutoLock& aProofOfLock);
   PoolThread* SelectThread(const MutexAutoLock& aProofOfLock);
 
+  // Off-main-thread tasks without dependencies or a manager bypass the task
+  // graph: they are queued on the pool threads' own priority queues, which
+  // idle threads steal from, and run without taking the GraphMutex.
+  void AddFastTask(RefPtr<Task>&& aTask);
+  void PushFastTask(PoolThread* aThread, RefPtr<Task>&& aTask, bool aFront);
+  RefPtr<Task> TakeFastTask(PoolThread* aThread);
+  void RunFastTasks(PoolThread* aThread);
+  void DidCompleteFastTask(Task* aTask);
+  void WakeSleepingThread(const MutexAutoLock& aProofOfLock);
+
   struct TaskToRun {
     RefPtr<Task> mTask;
     uint32_t mEffectiveTaskPriority = 0;
@@ -441,6 +479,21 @@ class TaskController {
   // Number of pool threads that are currently idle.
   size_t mIdleThreadCount = 0;
 
+  // Number of tasks queued on the pool threads' fast path queues, and number
+  // of pool threads waiting on their condition variable. These are modified
+  // under the queue and graph mutexes respectively, but read without them.
+  std::atomic<size_t> mPendingFastTaskCount = 0;
+  std::atomic<size_t> mSleepingThreadCount = 0;
+
+  // Used to spread fast path tasks dispatched from other threads over the
+  // pool threads' queues.
+  std::atomic<size_t> mNextFastQueue = 0;
+
+  // Set under mGraphMutex when a graph task couldn't be dispatched because
+  // every idle pool thread was running a fast path task. Read without it by
+  // those threads, which come back to the graph when they see it.
+  std::atomic<bool> mGraphTaskWaiting = false;
+
   // This ensures we keep running the main thread if we processed a task there.
   bool mMayHaveMainThreadTask = true;
   bool mShuttingDown = false;